@@ -2,12 +2,19 @@
 
 #include <cstdlib>
 
+namespace bump
+{
+
+	void log_flush(); // (see bump_log.hpp - so messages logged before dying aren't lost)
+
+} // bump
+
 #if defined(_MSC_VER)
 
 namespace bump
 {
 
-	inline constexpr void die_if(bool condition) { if (condition) __debugbreak(); }
+	inline constexpr void die_if(bool condition) { if (condition) { log_flush(); __debugbreak(); } }
 	[[noreturn]] inline constexpr void die() { die_if(true); }
 
 } // bump
@@ -19,8 +26,8 @@ namespace bump
 namespace bump
 {
 	
-	inline constexpr void die_if(bool condition) { if (condition) std::abort(); }
-	[[noreturn]] inline constexpr void die() { std::abort(); }
+	inline constexpr void die_if(bool condition) { if (condition) { log_flush(); std::abort(); } }
+	[[noreturn]] inline constexpr void die() { die_if(true); std::abort(); }
 	
 } // bump
 
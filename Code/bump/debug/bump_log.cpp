@@ -1,18 +1,320 @@
 #include "bump_log.hpp"
 
-#include <iostream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 
 namespace bump
 {
-	
-	void log_info(std::string const& message)
+
+	namespace
+	{
+
+		char const* get_prefix(log_level level)
+		{
+			switch (level)
+			{
+			case log_level::DEBUG: return "DEBUG: ";
+			case log_level::INFO: return "INFO: ";
+			case log_level::WARNING: return "WARNING: ";
+			case log_level::ERR: return "ERROR: ";
+			}
+
+			return "";
+		}
+
+		class logger
+		{
+		public:
+
+			logger();
+			~logger();
+
+			logger(logger const&) = delete;
+			logger& operator=(logger const&) = delete;
+			logger(logger&&) = delete;
+			logger& operator=(logger&&) = delete;
+
+			void write(log_level level, std::string_view message);
+			void flush();
+
+			bool set_file(std::filesystem::path const& path);
+
+		private:
+
+			static constexpr auto CAPACITY = std::size_t{ 1024 }; // (must be a power of two)
+			static constexpr auto TEXT_SIZE = std::size_t{ 240 };
+
+			// a slot in the ring buffer. m_sequence is the slot's index when it's free to write,
+			// and index + 1 once it's written (Vyukov's bounded queue)
+			struct record
+			{
+				std::atomic<std::uint64_t> m_sequence;
+				log_level m_level;
+				std::uint8_t m_size;
+				std::array<char, TEXT_SIZE> m_text;
+			};
+
+			bool try_push(log_level level, std::string_view message);
+			bool drain();
+			void run(std::stop_token stop);
+
+			std::unique_ptr<record[]> m_records;
+			alignas(64) std::atomic<std::uint64_t> m_write_pos;
+			alignas(64) std::atomic<std::uint64_t> m_written; // (read by flush(), only written by the log thread)
+			std::atomic<std::uint64_t> m_dropped;
+
+			std::mutex m_file_mutex;
+			std::FILE* m_file;
+			std::string m_batch;
+
+			std::jthread m_thread; // (last, so it starts after everything else is initialized)
+		};
+
+		// (logging during static destruction, after the logger's gone, falls back to writing directly)
+		auto g_logger_alive = std::atomic<bool>(false);
+		auto g_level = std::atomic<log_level>(log_level::DEBUG);
+
+		logger::logger():
+			m_records(std::make_unique<record[]>(CAPACITY)),
+			m_write_pos(0),
+			m_written(0),
+			m_dropped(0),
+			m_file(stderr),
+			m_thread([this] (std::stop_token stop) { run(stop); })
+		{
+			for (auto i = std::size_t{ 0 }; i != CAPACITY; ++i)
+				m_records[i].m_sequence.store(i, std::memory_order_relaxed);
+
+			g_logger_alive = true;
+		}
+
+		logger::~logger()
+		{
+			m_thread.request_stop();
+			m_thread.join();
+
+			g_logger_alive = false;
+
+			if (m_file != stderr)
+				std::fclose(m_file);
+		}
+
+		void logger::write(log_level level, std::string_view message)
+		{
+			if (try_push(level, message))
+				return;
+
+			if (level != log_level::ERR)
+			{
+				m_dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			// (errors wait for space)
+			while (!try_push(level, message))
+				std::this_thread::yield();
+		}
+
+		bool logger::try_push(log_level level, std::string_view message)
+		{
+			auto pos = m_write_pos.load(std::memory_order_relaxed);
+			auto* r = static_cast<record*>(nullptr);
+
+			while (true)
+			{
+				r = &m_records[pos & (CAPACITY - 1)];
+
+				auto const sequence = r->m_sequence.load(std::memory_order_acquire);
+				auto const diff = std::int64_t(sequence) - std::int64_t(pos);
+
+				if (diff == 0)
+				{
+					if (m_write_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (diff < 0)
+				{
+					return false; // (full)
+				}
+				else
+				{
+					pos = m_write_pos.load(std::memory_order_relaxed);
+				}
+			}
+
+			auto const size = std::min(message.size(), TEXT_SIZE);
+
+			r->m_level = level;
+			r->m_size = std::uint8_t(size);
+			std::copy_n(message.data(), size, r->m_text.data());
+
+			if (size < message.size())
+				std::copy_n("...", 3, r->m_text.data() + TEXT_SIZE - 3);
+
+			r->m_sequence.store(pos + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		bool logger::drain()
+		{
+			auto pos = m_written.load(std::memory_order_relaxed);
+
+			m_batch.clear();
+
+			if (auto const dropped = m_dropped.exchange(0, std::memory_order_relaxed); dropped != 0)
+				m_batch += "WARNING: " + std::to_string(dropped) + " log messages dropped (the log buffer was full)\n";
+
+			while (true)
+			{
+				auto& r = m_records[pos & (CAPACITY - 1)];
+
+				if (r.m_sequence.load(std::memory_order_acquire) != pos + 1)
+					break;
+
+				m_batch += get_prefix(r.m_level);
+				m_batch.append(r.m_text.data(), r.m_size);
+				m_batch += '\n';
+
+				r.m_sequence.store(pos + CAPACITY, std::memory_order_release);
+				++pos;
+			}
+
+			if (m_batch.empty())
+				return false;
+
+			{
+				auto lock = std::lock_guard(m_file_mutex);
+				std::fwrite(m_batch.data(), 1, m_batch.size(), m_file);
+				std::fflush(m_file);
+			}
+
+			m_written.store(pos, std::memory_order_release);
+
+			return true;
+		}
+
+		void logger::run(std::stop_token stop)
+		{
+			while (true)
+			{
+				if (drain())
+					continue;
+
+				if (stop.stop_requested())
+					break;
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			}
+		}
+
+		void logger::flush()
+		{
+			auto const target = m_write_pos.load(std::memory_order_relaxed);
+
+			while (m_written.load(std::memory_order_acquire) < target)
+				std::this_thread::yield();
+		}
+
+		bool logger::set_file(std::filesystem::path const& path)
+		{
+			auto* file = static_cast<std::FILE*>(nullptr);
+
+			if (!path.empty())
+			{
+				file = std::fopen(path.string().c_str(), "w");
+
+				if (!file)
+					return false;
+			}
+
+			flush();
+
+			auto lock = std::lock_guard(m_file_mutex);
+
+			if (m_file != stderr)
+				std::fclose(m_file);
+
+			m_file = file ? file : stderr;
+
+			return true;
+		}
+
+		logger& get_logger()
+		{
+			static auto instance = logger();
+			return instance;
+		}
+
+	} // unnamed
+
+	void log_set_level(log_level level)
+	{
+		g_level.store(level, std::memory_order_relaxed);
+	}
+
+	log_level log_get_level()
+	{
+		return g_level.load(std::memory_order_relaxed);
+	}
+
+	bool log_to_file(std::filesystem::path const& path)
+	{
+		if (!get_logger().set_file(path))
+		{
+			log_error("log_to_file() failed: could not open file: " + path.string());
+			return false;
+		}
+
+		return true;
+	}
+
+	void log_to_stderr()
 	{
-		std::cerr << "INFO: " << message << "\n";
+		get_logger().set_file({ });
 	}
 
-	void log_error(std::string const& message)
+	void log_flush()
 	{
-		std::cerr << "ERROR: " << message << "\n";
+		if (g_logger_alive)
+			get_logger().flush();
 	}
 
+	namespace detail
+	{
+
+		void log_write(log_level level, std::string_view message)
+		{
+			auto& logger = get_logger();
+
+			if (!g_logger_alive)
+			{
+				std::fprintf(stderr, "%s%.*s\n", get_prefix(level), int(message.size()), message.data());
+				return;
+			}
+
+			logger.write(level, message);
+		}
+
+		void log_vwrite(log_level level, std::string_view format, std::format_args args)
+		{
+			// (reused, so formatting doesn't allocate once it's big enough)
+			thread_local auto buffer = std::string();
+
+			buffer.clear();
+			std::vformat_to(std::back_inserter(buffer), format, args);
+
+			log_write(level, buffer);
+		}
+
+	} // detail
+
 } // bump
@@ -1,11 +1,78 @@
 #pragma once
 
-#include <string>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <string_view>
+
+// messages below this level are compiled out (0: debug, 1: info, 2: warning, 3: error)
+#if !defined(BUMP_LOG_MIN_LEVEL)
+#define BUMP_LOG_MIN_LEVEL 1
+#endif
 
 namespace bump
 {
-	
-	void log_info(std::string const& message);
-	void log_error(std::string const& message);
+
+	enum class log_level : std::uint8_t { DEBUG, INFO, WARNING, ERR }; // (not ERROR, which windows.h defines)
+
+	constexpr bool log_compiled_in(log_level level) { return int(level) >= BUMP_LOG_MIN_LEVEL; }
+
+	/* logging
+	 *
+	 * Messages are copied into a fixed size lock-free ring buffer, and a
+	 * background thread writes them out (to stderr by default), so logging
+	 * never blocks on I/O. Messages that don't fit in a record are cut
+	 * short. If the buffer is full, messages are dropped (and the number
+	 * dropped is logged later), except for errors, which wait for space.
+	 *
+	 * The formatted overloads (e.g. log_info("cycle {}", n)) only format
+	 * the message if its level is enabled, and messages below
+	 * BUMP_LOG_MIN_LEVEL are removed at compile time.
+	 *
+	 */
+	void log_set_level(log_level level);
+	log_level log_get_level();
+
+	inline bool log_enabled(log_level level) { return log_compiled_in(level) && level >= log_get_level(); }
+
+	bool log_to_file(std::filesystem::path const& path);
+	void log_to_stderr();
+
+	// blocks until everything logged so far has been written
+	void log_flush();
+
+	namespace detail
+	{
+
+		void log_write(log_level level, std::string_view message);
+		void log_vwrite(log_level level, std::string_view format, std::format_args args);
+
+		template<log_level Level, class... Args>
+		void log_format(std::format_string<Args...> format, Args&... args)
+		{
+			if constexpr (log_compiled_in(Level))
+				if (log_enabled(Level))
+					log_vwrite(Level, format.get(), std::make_format_args(args...));
+		}
+
+		template<log_level Level>
+		void log_message(std::string_view message)
+		{
+			if constexpr (log_compiled_in(Level))
+				if (log_enabled(Level))
+					log_write(Level, message);
+		}
+
+	} // detail
+
+	inline void log_debug(std::string_view message) { detail::log_message<log_level::DEBUG>(message); }
+	inline void log_info(std::string_view message) { detail::log_message<log_level::INFO>(message); }
+	inline void log_warning(std::string_view message) { detail::log_message<log_level::WARNING>(message); }
+	inline void log_error(std::string_view message) { detail::log_message<log_level::ERR>(message); }
+
+	template<class... Args> void log_debug(std::format_string<Args...> format, Args&&... args) { detail::log_format<log_level::DEBUG, Args...>(format, args...); }
+	template<class... Args> void log_info(std::format_string<Args...> format, Args&&... args) { detail::log_format<log_level::INFO, Args...>(format, args...); }
+	template<class... Args> void log_warning(std::format_string<Args...> format, Args&&... args) { detail::log_format<log_level::WARNING, Args...>(format, args...); }
+	template<class... Args> void log_error(std::format_string<Args...> format, Args&&... args) { detail::log_format<log_level::ERR, Args...>(format, args...); }
 
 } // bump
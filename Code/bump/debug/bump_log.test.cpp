@@ -0,0 +1,110 @@
+#include <bump_log.hpp>
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bump
+{
+
+	namespace
+	{
+
+		std::string read_file(std::filesystem::path const& path)
+		{
+			auto file = std::ifstream(path);
+			auto ss = std::ostringstream();
+			ss << file.rdbuf();
+			return ss.str();
+		}
+
+		struct counted
+		{
+			int* m_count;
+		};
+
+	} // unnamed
+
+} // bump
+
+template<>
+struct std::formatter<bump::counted> : std::formatter<int>
+{
+	auto format(bump::counted const& c, auto& ctx) const
+	{
+		return std::formatter<int>::format(++*c.m_count, ctx);
+	}
+};
+
+namespace bump
+{
+
+	TEST(Test_bump_log, levels_and_formatting)
+	{
+		auto const path = std::filesystem::temp_directory_path() / "bump_test_log.txt";
+		ASSERT_TRUE(log_to_file(path));
+
+		auto const old_level = log_get_level();
+		log_set_level(log_level::INFO);
+
+		auto format_count = 0;
+
+		log_info("plain");
+		log_info("formatted {} {}", 1, std::string("two"));
+		log_warning("{}", counted{ &format_count });
+		log_debug("{}", counted{ &format_count }); // (disabled: never formatted)
+		log_error(std::string(1000, 'x')); // (too long: cut short)
+
+		log_flush();
+		log_to_stderr();
+		log_set_level(old_level);
+
+		EXPECT_EQ(format_count, 1);
+
+		auto const text = read_file(path);
+		EXPECT_NE(text.find("INFO: plain\n"), std::string::npos);
+		EXPECT_NE(text.find("INFO: formatted 1 two\n"), std::string::npos);
+		EXPECT_NE(text.find("WARNING: 1\n"), std::string::npos);
+		EXPECT_EQ(text.find("DEBUG: "), std::string::npos);
+		EXPECT_NE(text.find("ERROR: xxx"), std::string::npos);
+		EXPECT_NE(text.find("x...\n"), std::string::npos);
+	}
+
+	TEST(Test_bump_log, many_threads)
+	{
+		auto const path = std::filesystem::temp_directory_path() / "bump_test_log_threads.txt";
+		ASSERT_TRUE(log_to_file(path));
+
+		auto constexpr THREADS = 4;
+		auto constexpr MESSAGES = 200;
+
+		{
+			auto threads = std::vector<std::jthread>();
+
+			for (auto t = 0; t != THREADS; ++t)
+				threads.emplace_back([=] ()
+				{
+					for (auto i = 0; i != MESSAGES; ++i)
+					{
+						log_error("thread {} message {}", t, i); // (errors are never dropped)
+						std::this_thread::yield();
+					}
+				});
+		}
+
+		log_flush();
+		log_to_stderr();
+
+		auto const text = read_file(path);
+
+		for (auto t = 0; t != THREADS; ++t)
+			for (auto i = 0; i != MESSAGES; ++i)
+				EXPECT_NE(text.find("ERROR: thread " + std::to_string(t) + " message " + std::to_string(i) + "\n"), std::string::npos);
+	}
+
+} // bump
@@ -0,0 +1,340 @@
+#include "bump_metrics.hpp"
+
+#include "bump_log.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <condition_variable>
+#include <cstdio>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace bump
+{
+
+	namespace metrics
+	{
+
+		namespace
+		{
+
+			auto constexpr HALF_SUB_BUCKET_COUNT = std::uint64_t{ 1 } << (histogram::SUB_BUCKET_BITS - 1);
+
+			void atomic_min(std::atomic<std::uint64_t>& a, std::uint64_t value)
+			{
+				auto current = a.load(std::memory_order_relaxed);
+				while (value < current && !a.compare_exchange_weak(current, value, std::memory_order_relaxed)) { }
+			}
+
+			void atomic_max(std::atomic<std::uint64_t>& a, std::uint64_t value)
+			{
+				auto current = a.load(std::memory_order_relaxed);
+				while (value > current && !a.compare_exchange_weak(current, value, std::memory_order_relaxed)) { }
+			}
+
+			struct histogram_entry
+			{
+				std::string m_unit;
+				std::unique_ptr<histogram> m_histogram;
+			};
+
+			struct registry
+			{
+				std::mutex m_mutex;
+				std::map<std::string, std::unique_ptr<counter>> m_counters;
+				std::map<std::string, std::unique_ptr<gauge>> m_gauges;
+				std::map<std::string, histogram_entry> m_histograms;
+			};
+
+			registry& get_registry()
+			{
+				static auto instance = registry();
+				return instance;
+			}
+
+			class reporter
+			{
+			public:
+
+				~reporter() { stop(); }
+
+				void start(std::chrono::milliseconds interval, std::filesystem::path const& path);
+				void stop();
+
+				void set_hook(std::function<void(snapshot const&)> hook);
+
+			private:
+
+				void run(std::stop_token stop, std::chrono::milliseconds interval, std::filesystem::path path);
+
+				std::mutex m_mutex;
+				std::condition_variable_any m_wake;
+				std::function<void(snapshot const&)> m_hook;
+				std::jthread m_thread;
+			};
+
+			void reporter::start(std::chrono::milliseconds interval, std::filesystem::path const& path)
+			{
+				stop();
+				m_thread = std::jthread([this, interval, path] (std::stop_token stop) { run(stop, interval, path); });
+			}
+
+			void reporter::stop()
+			{
+				if (!m_thread.joinable())
+					return;
+
+				m_thread.request_stop();
+				m_wake.notify_all();
+				m_thread.join();
+			}
+
+			void reporter::set_hook(std::function<void(snapshot const&)> hook)
+			{
+				auto lock = std::lock_guard(m_mutex);
+				m_hook = std::move(hook);
+			}
+
+			void reporter::run(std::stop_token stop, std::chrono::milliseconds interval, std::filesystem::path path)
+			{
+				auto* file = stderr;
+
+				if (!path.empty())
+				{
+					file = std::fopen(path.string().c_str(), "a");
+
+					if (!file)
+					{
+						log_error("metrics::start_reporting() failed: could not open file: {}", path.string());
+						return;
+					}
+				}
+
+				while (true)
+				{
+					{
+						auto lock = std::unique_lock(m_mutex);
+						m_wake.wait_for(lock, stop, interval, [] () { return false; });
+					}
+
+					if (stop.stop_requested())
+						break;
+
+					auto const s = take_snapshot();
+
+					auto os = std::ostringstream();
+					write_snapshot(os, s);
+
+					auto const text = os.str();
+					std::fwrite(text.data(), 1, text.size(), file);
+					std::fflush(file);
+
+					auto lock = std::lock_guard(m_mutex);
+
+					if (m_hook)
+						m_hook(s);
+				}
+
+				if (file != stderr)
+					std::fclose(file);
+			}
+
+			reporter& get_reporter()
+			{
+				static auto instance = reporter();
+				return instance;
+			}
+
+		} // unnamed
+
+		std::size_t histogram::get_bucket(std::uint64_t value)
+		{
+			auto const width = std::bit_width(value);
+
+			if (width <= SUB_BUCKET_BITS)
+				return std::size_t(value);
+
+			auto const shift = width - SUB_BUCKET_BITS;
+
+			return std::size_t(shift) * HALF_SUB_BUCKET_COUNT + std::size_t(value >> shift);
+		}
+
+		std::uint64_t histogram::get_bucket_min(std::size_t bucket)
+		{
+			if (bucket < 2 * HALF_SUB_BUCKET_COUNT)
+				return bucket;
+
+			auto const shift = bucket / HALF_SUB_BUCKET_COUNT - 1;
+			auto const top = bucket - shift * HALF_SUB_BUCKET_COUNT;
+
+			return std::uint64_t(top) << shift;
+		}
+
+		std::uint64_t histogram::get_bucket_max(std::size_t bucket)
+		{
+			return bucket + 1 == BUCKET_COUNT ? std::numeric_limits<std::uint64_t>::max() : get_bucket_min(bucket + 1) - 1;
+		}
+
+		void histogram::record(std::uint64_t value)
+		{
+			m_buckets[get_bucket(value)].fetch_add(1, std::memory_order_relaxed);
+			m_count.fetch_add(1, std::memory_order_relaxed);
+			m_sum.fetch_add(value, std::memory_order_relaxed);
+			atomic_min(m_min, value);
+			atomic_max(m_max, value);
+		}
+
+		histogram::summary histogram::summarize() const
+		{
+			// (the buckets may be updated while this runs, so the total is counted from the buckets themselves)
+			auto counts = std::array<std::uint64_t, BUCKET_COUNT>();
+			auto total = std::uint64_t{ 0 };
+
+			for (auto i = std::size_t{ 0 }; i != BUCKET_COUNT; ++i)
+				total += (counts[i] = m_buckets[i].load(std::memory_order_relaxed));
+
+			auto out = summary();
+
+			if (total == 0)
+				return out;
+
+			out.m_count = total;
+			out.m_min = m_min.load(std::memory_order_relaxed);
+			out.m_max = m_max.load(std::memory_order_relaxed);
+			out.m_mean = double(m_sum.load(std::memory_order_relaxed)) / double(std::max(m_count.load(std::memory_order_relaxed), std::uint64_t{ 1 }));
+
+			auto const percentile = [&] (double p)
+			{
+				auto const rank = std::max(std::uint64_t(p * double(total) + 0.5), std::uint64_t{ 1 });
+				auto seen = std::uint64_t{ 0 };
+
+				for (auto i = std::size_t{ 0 }; i != BUCKET_COUNT; ++i)
+					if ((seen += counts[i]) >= rank)
+						return std::min(get_bucket_max(i), out.m_max);
+
+				return out.m_max;
+			};
+
+			out.m_p50 = percentile(0.5);
+			out.m_p90 = percentile(0.9);
+			out.m_p99 = percentile(0.99);
+			out.m_p999 = percentile(0.999);
+
+			return out;
+		}
+
+		counter& get_counter(std::string const& name)
+		{
+			auto& r = get_registry();
+			auto lock = std::lock_guard(r.m_mutex);
+
+			auto& c = r.m_counters[name];
+
+			if (!c)
+				c = std::make_unique<counter>();
+
+			return *c;
+		}
+
+		gauge& get_gauge(std::string const& name)
+		{
+			auto& r = get_registry();
+			auto lock = std::lock_guard(r.m_mutex);
+
+			auto& g = r.m_gauges[name];
+
+			if (!g)
+				g = std::make_unique<gauge>();
+
+			return *g;
+		}
+
+		histogram& get_histogram(std::string const& name, std::string const& unit)
+		{
+			auto& r = get_registry();
+			auto lock = std::lock_guard(r.m_mutex);
+
+			auto& h = r.m_histograms[name];
+
+			if (!h.m_histogram)
+				h = { unit, std::make_unique<histogram>() };
+
+			return *h.m_histogram;
+		}
+
+		snapshot take_snapshot()
+		{
+			auto& r = get_registry();
+			auto lock = std::lock_guard(r.m_mutex);
+
+			auto out = snapshot();
+			out.m_time = clock_t::now();
+
+			for (auto const& [name, c] : r.m_counters)
+				out.m_counters.push_back({ name, c->value() });
+
+			for (auto const& [name, g] : r.m_gauges)
+				out.m_gauges.push_back({ name, g->value() });
+
+			for (auto const& [name, h] : r.m_histograms)
+				out.m_histograms.push_back({ name, h.m_unit, h.m_histogram->summarize() });
+
+			return out;
+		}
+
+		void write_snapshot(std::ostream& os, snapshot const& snapshot)
+		{
+			os << "metrics:\n";
+
+			for (auto const& c : snapshot.m_counters)
+				os << "  " << c.m_name << ": " << c.m_value << "\n";
+
+			for (auto const& g : snapshot.m_gauges)
+				os << "  " << g.m_name << ": " << g.m_value << "\n";
+
+			for (auto const& h : snapshot.m_histograms)
+			{
+				auto const& s = h.m_summary;
+				auto const unit = h.m_unit.empty() ? std::string() : " " + h.m_unit;
+
+				os << "  " << h.m_name << ": count " << s.m_count;
+
+				if (s.m_count != 0)
+				{
+					os << std::fixed << std::setprecision(1)
+						<< ", mean " << s.m_mean
+						<< ", min " << s.m_min
+						<< ", p50 " << s.m_p50
+						<< ", p90 " << s.m_p90
+						<< ", p99 " << s.m_p99
+						<< ", p99.9 " << s.m_p999
+						<< ", max " << s.m_max
+						<< unit;
+				}
+
+				os << "\n";
+			}
+		}
+
+		void start_reporting(std::chrono::milliseconds interval, std::filesystem::path const& path)
+		{
+			get_reporter().start(interval, path);
+		}
+
+		void stop_reporting()
+		{
+			get_reporter().stop();
+		}
+
+		void set_overlay_hook(std::function<void(snapshot const&)> hook)
+		{
+			get_reporter().set_hook(std::move(hook));
+		}
+
+	} // metrics
+
+} // bump
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "bump_time.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bump
+{
+
+	namespace metrics
+	{
+
+		/* metrics
+		 *
+		 * Named counters, gauges and histograms that are always on. Updating
+		 * one is a relaxed atomic operation (no locks), so they can be used
+		 * from any thread, in hot code. Looking one up by name takes a lock,
+		 * so call sites should keep a reference, e.g.:
+		 *
+		 *     static auto& searches = bump::metrics::get_counter("find_path.searches");
+		 *     searches.add();
+		 *
+		 * Metrics are never removed, so references stay valid.
+		 *
+		 */
+
+		class counter
+		{
+		public:
+
+			void add(std::uint64_t n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+			std::uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+		private:
+
+			std::atomic<std::uint64_t> m_value = 0;
+		};
+
+		class gauge
+		{
+		public:
+
+			void set(std::int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+			std::int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+		private:
+
+			std::atomic<std::int64_t> m_value = 0;
+		};
+
+		/* histogram
+		 *
+		 * Counts values in log-linear buckets (as in HdrHistogram): values
+		 * below 128 are exact, and larger values fall in one of 64 buckets
+		 * per power of two, so percentiles are accurate to within ~1.6%.
+		 *
+		 * Durations are recorded in microseconds.
+		 *
+		 */
+		class histogram
+		{
+		public:
+
+			static constexpr auto SUB_BUCKET_BITS = 7;
+			static constexpr auto BUCKET_COUNT = std::size_t{ (64 - SUB_BUCKET_BITS + 2) << (SUB_BUCKET_BITS - 1) };
+
+			void record(std::uint64_t value);
+			void record(duration_t duration) { record(std::uint64_t(std::max(std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), std::int64_t{ 0 }))); }
+
+			static std::size_t get_bucket(std::uint64_t value);
+			static std::uint64_t get_bucket_min(std::size_t bucket);
+			static std::uint64_t get_bucket_max(std::size_t bucket);
+
+			struct summary
+			{
+				std::uint64_t m_count = 0;
+				std::uint64_t m_min = 0;
+				std::uint64_t m_max = 0;
+				double m_mean = 0.0;
+				std::uint64_t m_p50 = 0;
+				std::uint64_t m_p90 = 0;
+				std::uint64_t m_p99 = 0;
+				std::uint64_t m_p999 = 0;
+			};
+
+			// (the percentiles are the highest value in the bucket they fall in, clamped to the max recorded)
+			summary summarize() const;
+
+		private:
+
+			std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> m_buckets = { };
+			std::atomic<std::uint64_t> m_count = 0;
+			std::atomic<std::uint64_t> m_sum = 0;
+			std::atomic<std::uint64_t> m_min = std::numeric_limits<std::uint64_t>::max();
+			std::atomic<std::uint64_t> m_max = 0;
+		};
+
+		counter& get_counter(std::string const& name);
+		gauge& get_gauge(std::string const& name);
+		histogram& get_histogram(std::string const& name, std::string const& unit = "");
+
+		struct snapshot
+		{
+			struct counter_value { std::string m_name; std::uint64_t m_value; };
+			struct gauge_value { std::string m_name; std::int64_t m_value; };
+			struct histogram_value { std::string m_name; std::string m_unit; histogram::summary m_summary; };
+
+			time_point_t m_time;
+			std::vector<counter_value> m_counters;
+			std::vector<gauge_value> m_gauges;
+			std::vector<histogram_value> m_histograms;
+		};
+
+		// (sorted by name)
+		snapshot take_snapshot();
+		void write_snapshot(std::ostream& os, snapshot const& snapshot);
+
+		/* start_reporting()
+		 *
+		 * Takes a snapshot every `interval` on a background thread, and
+		 * writes it to the file at `path` (appending), or to stderr if
+		 * `path` is empty. Call again to change the interval or file, or
+		 * call stop_reporting() to stop.
+		 *
+		 */
+		void start_reporting(std::chrono::milliseconds interval, std::filesystem::path const& path = { });
+		void stop_reporting();
+
+		/* set_overlay_hook()
+		 *
+		 * Also passes each snapshot taken while reporting to `hook` (e.g. to
+		 * copy it for drawing on screen). Note that the hook is called on the
+		 * reporting thread. Pass an empty function to remove it.
+		 *
+		 */
+		void set_overlay_hook(std::function<void(snapshot const&)> hook);
+
+	} // metrics
+
+} // bump
@@ -0,0 +1,81 @@
+#include <bump_metrics.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bump
+{
+
+	TEST(Test_bump_metrics, histogram_buckets)
+	{
+		using h = metrics::histogram;
+
+		// every value is within its bucket, and the buckets are contiguous
+		for (auto v : { std::uint64_t{ 0 }, std::uint64_t{ 1 }, std::uint64_t{ 127 }, std::uint64_t{ 128 }, std::uint64_t{ 129 }, std::uint64_t{ 1'000'000 }, std::numeric_limits<std::uint64_t>::max() })
+		{
+			auto const b = h::get_bucket(v);
+			ASSERT_LT(b, h::BUCKET_COUNT);
+			EXPECT_LE(h::get_bucket_min(b), v);
+			EXPECT_GE(h::get_bucket_max(b), v);
+		}
+
+		for (auto b = std::size_t{ 1 }; b != h::BUCKET_COUNT; ++b)
+		{
+			ASSERT_EQ(h::get_bucket_min(b), h::get_bucket_max(b - 1) + 1);
+			ASSERT_EQ(h::get_bucket(h::get_bucket_min(b)), b);
+		}
+
+		EXPECT_EQ(h::get_bucket_max(h::BUCKET_COUNT - 1), std::numeric_limits<std::uint64_t>::max());
+	}
+
+	TEST(Test_bump_metrics, histogram_percentiles)
+	{
+		auto h = metrics::histogram();
+
+		for (auto v = std::uint64_t{ 1 }; v <= 10'000; ++v)
+			h.record(v);
+
+		auto const s = h.summarize();
+
+		EXPECT_EQ(s.m_count, 10'000);
+		EXPECT_EQ(s.m_min, 1);
+		EXPECT_EQ(s.m_max, 10'000);
+		EXPECT_DOUBLE_EQ(s.m_mean, 5'000.5);
+		EXPECT_NEAR(double(s.m_p50), 5'000.0, 5'000.0 / 64.0);
+		EXPECT_NEAR(double(s.m_p99), 9'900.0, 9'900.0 / 64.0);
+		EXPECT_EQ(s.m_p999, 10'000); // (clamped to the max)
+	}
+
+	TEST(Test_bump_metrics, registry)
+	{
+		auto& c = metrics::get_counter("test.counter");
+		EXPECT_EQ(&c, &metrics::get_counter("test.counter"));
+
+		{
+			auto threads = std::vector<std::jthread>();
+
+			for (auto t = 0; t != 4; ++t)
+				threads.emplace_back([&] () { for (auto i = 0; i != 1000; ++i) c.add(); });
+		}
+
+		metrics::get_gauge("test.gauge").set(-7);
+		metrics::get_histogram("test.histogram", "us").record(bump::duration_t(std::chrono::milliseconds(3)));
+
+		auto const s = metrics::take_snapshot();
+
+		auto os = std::ostringstream();
+		metrics::write_snapshot(os, s);
+		auto const text = os.str();
+
+		EXPECT_NE(text.find("test.counter: 4000\n"), std::string::npos);
+		EXPECT_NE(text.find("test.gauge: -7\n"), std::string::npos);
+		EXPECT_NE(text.find("test.histogram: count 1, mean 3000.0"), std::string::npos);
+		EXPECT_NE(text.find(", max 3000 us\n"), std::string::npos);
+	}
+
+} // bump
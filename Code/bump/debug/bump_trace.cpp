@@ -0,0 +1,207 @@
+#include "bump_trace.hpp"
+
+#include "bump_log.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace bump
+{
+
+	namespace trace
+	{
+
+		namespace detail
+		{
+
+			std::atomic<bool> g_capturing = false;
+
+		} // detail
+
+		namespace
+		{
+
+			struct event
+			{
+				char const* m_name;
+				time_point_t m_start;
+				time_point_t m_end;
+			};
+
+			// only the owning thread writes to a buffer. the exporter reads m_count (and the events before it)
+			struct thread_buffer
+			{
+				std::uint32_t m_thread_id;
+				std::atomic<std::uint64_t> m_capture; // (the capture the events are from)
+				std::atomic<std::size_t> m_count;
+				std::unique_ptr<event[]> m_events;
+			};
+
+			struct tracer
+			{
+				std::mutex m_mutex; // (for m_buffers, and start / stop)
+				std::vector<std::unique_ptr<thread_buffer>> m_buffers; // (never removed, so threads can keep pointers to them)
+
+				std::atomic<std::uint64_t> m_capture = 0;
+				time_point_t m_capture_start;
+			};
+
+			tracer& get_tracer()
+			{
+				static auto instance = tracer();
+				return instance;
+			}
+
+			thread_buffer& get_thread_buffer()
+			{
+				thread_local auto* buffer = static_cast<thread_buffer*>(nullptr);
+
+				if (!buffer)
+				{
+					auto& tracer = get_tracer();
+					auto lock = std::lock_guard(tracer.m_mutex);
+
+					auto b = std::make_unique<thread_buffer>();
+					b->m_thread_id = std::uint32_t(tracer.m_buffers.size());
+					b->m_capture = 0;
+					b->m_count = 0;
+					b->m_events = std::make_unique<event[]>(MAX_EVENTS_PER_THREAD);
+
+					buffer = b.get();
+					tracer.m_buffers.push_back(std::move(b));
+				}
+
+				return *buffer;
+			}
+
+			void write_escaped(std::ostream& os, char const* str)
+			{
+				auto constexpr hex_digits = "0123456789abcdef";
+
+				for (; *str; ++str)
+				{
+					auto const c = std::uint8_t(*str);
+
+					if (c == '"' || c == '\\')
+						os << '\\' << *str;
+					else if (c == '\n')
+						os << "\\n";
+					else if (c == '\t')
+						os << "\\t";
+					else if (c < 0x20) // (other control characters aren't allowed in json strings either)
+						os << "\\u00" << hex_digits[c >> 4] << hex_digits[c & 0xF];
+					else
+						os << *str;
+				}
+			}
+
+		} // unnamed
+
+		void start()
+		{
+			auto& tracer = get_tracer();
+			auto lock = std::lock_guard(tracer.m_mutex);
+
+			tracer.m_capture_start = clock_t::now();
+			tracer.m_capture.fetch_add(1, std::memory_order_release);
+
+			detail::g_capturing.store(true, std::memory_order_relaxed);
+		}
+
+		void stop()
+		{
+			detail::g_capturing.store(false, std::memory_order_relaxed);
+		}
+
+		void write_json(std::ostream& os)
+		{
+			auto& tracer = get_tracer();
+			auto lock = std::lock_guard(tracer.m_mutex);
+
+			auto const capture = tracer.m_capture.load(std::memory_order_acquire);
+			auto const to_us = [&] (time_point_t t) { return std::chrono::duration<double, std::micro>(t - tracer.m_capture_start).count(); };
+
+			os << std::fixed << std::setprecision(3);
+			os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+			auto first = true;
+
+			for (auto const& b : tracer.m_buffers)
+			{
+				if (b->m_capture.load(std::memory_order_acquire) != capture)
+					continue;
+
+				auto const count = b->m_count.load(std::memory_order_acquire);
+
+				if (count == 0)
+					continue;
+
+				os << (first ? "\n" : ",\n");
+				os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << b->m_thread_id << ",\"args\":{\"name\":\"thread " << b->m_thread_id << "\"}}";
+				first = false;
+
+				for (auto i = std::size_t{ 0 }; i != count; ++i)
+				{
+					auto const& e = b->m_events[i];
+
+					os << ",\n{\"name\":\"";
+					write_escaped(os, e.m_name);
+					os << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << b->m_thread_id << ",\"ts\":" << to_us(e.m_start) << ",\"dur\":" << to_us(e.m_end) - to_us(e.m_start) << "}";
+				}
+			}
+
+			os << "\n]}\n";
+		}
+
+		bool save_json(std::filesystem::path const& path)
+		{
+			auto file = std::ofstream(path, std::ios::binary);
+
+			if (!file.is_open())
+			{
+				log_error("trace::save_json() failed: could not open file: {}", path.string());
+				return false;
+			}
+
+			write_json(file);
+
+			return file.good();
+		}
+
+		namespace detail
+		{
+
+			void record(char const* name, time_point_t start, time_point_t end)
+			{
+				// (it stopped while the zone was open)
+				if (!g_capturing.load(std::memory_order_relaxed))
+					return;
+
+				auto& buffer = get_thread_buffer();
+				auto const capture = get_tracer().m_capture.load(std::memory_order_acquire);
+
+				// (the first event of a new capture)
+				if (buffer.m_capture.load(std::memory_order_relaxed) != capture)
+				{
+					buffer.m_count.store(0, std::memory_order_relaxed);
+					buffer.m_capture.store(capture, std::memory_order_release);
+				}
+
+				auto const count = buffer.m_count.load(std::memory_order_relaxed);
+
+				if (count == MAX_EVENTS_PER_THREAD)
+					return;
+
+				buffer.m_events[count] = { name, start, end };
+				buffer.m_count.store(count + 1, std::memory_order_release);
+			}
+
+		} // detail
+
+	} // trace
+
+} // bump
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "bump_time.hpp"
+
+#include <atomic>
+#include <filesystem>
+#include <ostream>
+
+namespace bump
+{
+
+	namespace trace
+	{
+
+		/* tracing
+		 *
+		 * Records timed zones (see zone below) while a capture is running,
+		 * into a buffer per thread (so recording never takes a lock), and
+		 * exports them as Chrome trace event JSON, which can be loaded
+		 * into chrome://tracing or https://ui.perfetto.dev.
+		 *
+		 * When no capture is running, a zone costs one relaxed atomic load.
+		 *
+		 * start() and stop() should be called from one thread (e.g. the
+		 * main thread). Zones still open when the capture stops aren't
+		 * recorded, and each thread keeps at most MAX_EVENTS_PER_THREAD
+		 * events per capture.
+		 *
+		 */
+		auto constexpr MAX_EVENTS_PER_THREAD = std::size_t{ 1 } << 16;
+
+		void start();
+		void stop();
+
+		// (the last capture, or the current one so far)
+		void write_json(std::ostream& os);
+		bool save_json(std::filesystem::path const& path);
+
+		namespace detail
+		{
+
+			extern std::atomic<bool> g_capturing;
+
+			void record(char const* name, time_point_t start, time_point_t end);
+
+		} // detail
+
+		inline bool is_capturing() { return detail::g_capturing.load(std::memory_order_relaxed); }
+
+		/* zone
+		 *
+		 * Records the time from construction to destruction, e.g.:
+		 *
+		 *     auto const zone = bump::trace::zone("update");
+		 *
+		 * `name` must outlive the capture (i.e. use a string literal).
+		 *
+		 */
+		class zone
+		{
+		public:
+
+			explicit zone(char const* name):
+				m_name(is_capturing() ? name : nullptr),
+				m_start(m_name ? clock_t::now() : time_point_t()) { }
+
+			~zone()
+			{
+				if (m_name)
+					detail::record(m_name, m_start, clock_t::now());
+			}
+
+			zone(zone const&) = delete;
+			zone& operator=(zone const&) = delete;
+			zone(zone&&) = delete;
+			zone& operator=(zone&&) = delete;
+
+		private:
+
+			char const* m_name;
+			time_point_t m_start;
+		};
+
+	} // trace
+
+} // bump
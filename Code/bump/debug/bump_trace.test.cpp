@@ -0,0 +1,86 @@
+#include <bump_trace.hpp>
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace bump
+{
+
+	namespace
+	{
+
+		std::string get_json()
+		{
+			auto os = std::ostringstream();
+			trace::write_json(os);
+			return os.str();
+		}
+
+		std::size_t count(std::string const& str, std::string const& what)
+		{
+			auto n = std::size_t{ 0 };
+
+			for (auto pos = str.find(what); pos != std::string::npos; pos = str.find(what, pos + 1))
+				++n;
+
+			return n;
+		}
+
+	} // unnamed
+
+	TEST(Test_bump_trace, zones)
+	{
+		{
+			auto const zone = trace::zone("before");
+		}
+
+		trace::start();
+
+		{
+			auto const outer = trace::zone("outer");
+
+			for (auto i = 0; i != 3; ++i)
+				auto const inner = trace::zone("inner \"quoted\"");
+
+			auto thread = std::jthread([] () { auto const zone = trace::zone("other thread"); });
+		}
+
+		trace::stop();
+
+		{
+			auto const zone = trace::zone("after");
+		}
+
+		auto const json = get_json();
+
+		EXPECT_EQ(json.find("\"before\""), std::string::npos);
+		EXPECT_EQ(json.find("\"after\""), std::string::npos);
+		EXPECT_EQ(count(json, "\"outer\""), 1);
+		EXPECT_EQ(count(json, "\"inner \\\"quoted\\\"\""), 3);
+		EXPECT_EQ(count(json, "\"other thread\""), 1);
+		EXPECT_EQ(count(json, "\"thread_name\""), 2);
+
+		// a new capture starts empty
+		trace::start();
+		trace::stop();
+
+		EXPECT_EQ(get_json().find("\"outer\""), std::string::npos);
+	}
+
+	TEST(Test_bump_trace, control_characters_are_escaped)
+	{
+		trace::start();
+
+		{
+			auto const zone = trace::zone("a\tb\nc\x01\\");
+		}
+
+		trace::stop();
+
+		EXPECT_EQ(count(get_json(), "\"a\\tb\\nc\\u0001\\\\\""), 1);
+	}
+
+} // bump
@@ -5,6 +5,7 @@
 #include "bump_app.hpp"
 #include "bump_load_gl_texture.hpp"
 #include "bump_log.hpp"
+#include "bump_trace.hpp"
 
 #include <array>
 #include <fstream>
@@ -50,6 +51,8 @@ namespace bump
 	
 	assets load_assets(app& app, asset_metadata const& m)
 	{
+		auto const zone = trace::zone("load_assets");
+
 		auto out = assets();
 
 		// load fonts:
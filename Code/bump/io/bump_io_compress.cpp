@@ -0,0 +1,204 @@
+#include "bump_io_compress.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace bump
+{
+
+	namespace io
+	{
+
+		namespace
+		{
+
+			auto constexpr MIN_MATCH = std::size_t{ 4 };
+			auto constexpr MAX_OFFSET = std::size_t{ 0xFFFF };
+			auto constexpr HASH_BITS = 14;
+			auto constexpr NIBBLE_MAX = std::size_t{ 15 };
+
+			std::uint32_t read_u32(char const* p)
+			{
+				auto value = std::uint32_t{ 0 };
+				std::memcpy(&value, p, sizeof(value));
+				return value;
+			}
+
+			std::uint32_t hash(std::uint32_t value)
+			{
+				return (value * 2654435761u) >> (32 - HASH_BITS);
+			}
+
+			// lengths that don't fit in a nibble continue in bytes of 255, ending with a byte < 255
+			void write_length(std::string& out, std::size_t length)
+			{
+				for (; length >= 255; length -= 255)
+					out.push_back(char(255));
+
+				out.push_back(char(length));
+			}
+
+			bool read_length(std::string_view data, std::size_t& pos, std::size_t& length)
+			{
+				while (true)
+				{
+					if (pos == data.size())
+						return false;
+
+					auto const b = std::uint8_t(data[pos++]);
+					length += b;
+
+					if (b != 255)
+						return true;
+				}
+			}
+
+			void write_sequence(std::string& out, std::string_view literals, std::size_t match_length, std::size_t offset)
+			{
+				auto const match_code = (match_length == 0 ? 0 : match_length - MIN_MATCH);
+				auto const token = (std::min(literals.size(), NIBBLE_MAX) << 4) | std::min(match_code, NIBBLE_MAX);
+
+				out.push_back(char(token));
+
+				if (literals.size() >= NIBBLE_MAX)
+					write_length(out, literals.size() - NIBBLE_MAX);
+
+				out.append(literals);
+
+				if (match_length == 0)
+					return;
+
+				out.push_back(char(offset & 0xFF));
+				out.push_back(char(offset >> 8));
+
+				if (match_code >= NIBBLE_MAX)
+					write_length(out, match_code - NIBBLE_MAX);
+			}
+
+		} // unnamed
+
+		std::string compress(std::string_view data)
+		{
+			auto out = std::string();
+			out.reserve(8 + data.size() / 2);
+
+			// uncompressed size (little endian)
+			for (auto i = 0; i != 8; ++i)
+				out.push_back(char((std::uint64_t(data.size()) >> (i * 8)) & 0xFF));
+
+			// positions (+ 1, so 0 is empty) of the last occurrence of each hashed 4 bytes
+			auto table = std::array<std::uint32_t, std::size_t{ 1 } << HASH_BITS>();
+			table.fill(0);
+
+			auto literal_start = std::size_t{ 0 };
+			auto pos = std::size_t{ 0 };
+
+			while (data.size() >= MIN_MATCH && pos <= data.size() - MIN_MATCH)
+			{
+				auto const value = read_u32(data.data() + pos);
+				auto& entry = table[hash(value)];
+				auto const candidate = std::size_t(entry);
+				entry = std::uint32_t(pos + 1);
+
+				if (candidate == 0 || pos - (candidate - 1) > MAX_OFFSET || read_u32(data.data() + candidate - 1) != value)
+				{
+					++pos;
+					continue;
+				}
+
+				auto const match_pos = candidate - 1;
+				auto length = MIN_MATCH;
+
+				while (pos + length != data.size() && data[match_pos + length] == data[pos + length])
+					++length;
+
+				write_sequence(out, data.substr(literal_start, pos - literal_start), length, pos - match_pos);
+
+				pos += length;
+				literal_start = pos;
+			}
+
+			if (literal_start != data.size() || data.empty())
+				write_sequence(out, data.substr(literal_start), 0, 0);
+
+			return out;
+		}
+
+		std::optional<std::string> decompress(std::string_view data)
+		{
+			if (data.size() < 8)
+				return { };
+
+			auto size = std::uint64_t{ 0 };
+
+			for (auto i = 0; i != 8; ++i)
+				size |= std::uint64_t(std::uint8_t(data[i])) << (i * 8);
+
+			auto out = std::string();
+
+			if (size > out.max_size())
+				return { };
+
+			// (the size could be corrupt, so don't reserve more than the input is likely to expand to)
+			out.reserve(std::size_t(std::min(size, std::uint64_t(data.size()) * 4)));
+
+			auto pos = std::size_t{ 8 };
+
+			while (true)
+			{
+				if (pos == data.size())
+					return { };
+
+				auto const token = std::uint8_t(data[pos++]);
+
+				auto literal_length = std::size_t(token >> 4);
+
+				if (literal_length == NIBBLE_MAX && !read_length(data, pos, literal_length))
+					return { };
+
+				if (literal_length > data.size() - pos || literal_length > size - out.size())
+					return { };
+
+				out.append(data.substr(pos, literal_length));
+				pos += literal_length;
+
+				if (out.size() == size)
+					break;
+
+				if (data.size() - pos < 2)
+					return { };
+
+				auto const offset = std::size_t(std::uint8_t(data[pos])) | (std::size_t(std::uint8_t(data[pos + 1])) << 8);
+				pos += 2;
+
+				auto match_length = std::size_t(token & 0x0F);
+
+				if (match_length == NIBBLE_MAX && !read_length(data, pos, match_length))
+					return { };
+
+				match_length += MIN_MATCH;
+
+				if (offset == 0 || offset > out.size() || match_length > size - out.size())
+					return { };
+
+				// the match can overlap the bytes it's producing, so copy a byte at a time
+				auto const match_start = out.size() - offset;
+
+				for (auto i = std::size_t{ 0 }; i != match_length; ++i)
+					out.push_back(out[match_start + i]);
+
+				if (out.size() == size)
+					break;
+			}
+
+			if (pos != data.size())
+				return { };
+
+			return out;
+		}
+
+	} // io
+
+} // bump
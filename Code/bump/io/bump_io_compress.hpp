@@ -0,0 +1,32 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace bump
+{
+
+	namespace io
+	{
+
+		/* compress(), decompress()
+		 *
+		 * A small, fast LZ77 byte compressor (in the style of LZ4), for
+		 * shrinking serialized data that's kept in memory or written to disk.
+		 *
+		 * The output starts with the uncompressed size, followed by a series
+		 * of sequences. Each sequence is a token byte (literal length in the
+		 * high 4 bits, match length - 4 in the low 4 bits, with 15 meaning
+		 * "more length bytes follow"), the literal bytes, and a 2 byte offset
+		 * back to the match. The last sequence has no match.
+		 *
+		 * decompress() returns nothing if the data is malformed.
+		 *
+		 */
+		std::string compress(std::string_view data);
+		std::optional<std::string> decompress(std::string_view data);
+
+	} // io
+
+} // bump
@@ -0,0 +1,78 @@
+#include <bump_io_compress.hpp>
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+namespace bump
+{
+
+	namespace io
+	{
+
+		TEST(Test_bump_io_compress, empty)
+		{
+			auto const c = compress("");
+			EXPECT_EQ(decompress(c), std::string());
+		}
+
+		TEST(Test_bump_io_compress, round_trip)
+		{
+			auto rng = std::mt19937(1);
+
+			auto const random_string = [&] (std::size_t size, int alphabet)
+			{
+				auto s = std::string(size, '\0');
+
+				for (auto& c : s)
+					c = char(std::uniform_int_distribution<int>(0, alphabet - 1)(rng));
+
+				return s;
+			};
+
+			auto inputs = std::vector<std::string>
+			{
+				"a",
+				"abc",
+				"abcd",
+				"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+				std::string(100000, '#'),
+				random_string(1000, 256),
+				random_string(70000, 4),
+				random_string(300000, 2),
+			};
+
+			for (auto const& in : inputs)
+			{
+				auto const c = compress(in);
+				EXPECT_EQ(decompress(c), in);
+			}
+
+			// long runs should shrink a lot
+			EXPECT_LT(compress(std::string(100000, '#')).size(), 1000);
+		}
+
+		TEST(Test_bump_io_compress, malformed)
+		{
+			auto const c = compress(std::string(1000, 'x') + "abcdefgh" + std::string(1000, 'y'));
+
+			EXPECT_FALSE(decompress(c.substr(0, 4)).has_value());
+			EXPECT_FALSE(decompress(c.substr(0, c.size() - 1)).has_value());
+			EXPECT_FALSE(decompress(c + "z").has_value());
+
+			// a corrupt size in the header
+			for (auto const size : { std::uint64_t{ 1 } << 40, std::uint64_t{ 1 } << 62, ~std::uint64_t{ 0 } })
+			{
+				auto header = c;
+
+				for (auto i = 0; i != 8; ++i)
+					header[std::size_t(i)] = char((size >> (i * 8)) & 0xFF);
+
+				EXPECT_FALSE(decompress(header).has_value());
+			}
+		}
+
+	} // io
+
+} // bump
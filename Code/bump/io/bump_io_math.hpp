@@ -36,6 +36,14 @@ namespace bump
 			}
 		};
 
+		template<size_t S, class T, glm::qualifier Q>
+		struct bulk_impl<glm::vec<S, T, Q>, std::enable_if_t<bulk_impl<T>::enabled>>
+		{
+			static constexpr bool enabled = (sizeof(glm::vec<S, T, Q>) == sizeof(T) * S); // not padded / aligned
+			using value_type = T;
+			static constexpr std::size_t size = S;
+		};
+
 #pragma endregion
 
 #pragma region quat
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <algorithm>
 #include <bit>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <type_traits>
 
 namespace bump
 {
@@ -93,11 +98,131 @@ namespace bump
 		template<class T> struct write_impl;
 
 		template<class T>
-		void write(std::ostream& os, T value)
+		void write(std::ostream& os, T const& value)
 		{
 			return write_impl<std::decay_t<T>>::write(os, value);
 		}
 
+		/* bulk_impl
+		 *
+		 * Specialized for types that are stored in memory as `size` contiguous
+		 * values of an arithmetic `value_type` (with no padding), and written
+		 * the same way as those values would be. Arrays of these types are
+		 * read / written with one stream call by read_array() / write_array().
+		 *
+		 */
+		template<class T, class Enable = void>
+		struct bulk_impl
+		{
+			static constexpr bool enabled = false;
+		};
+
+		template<class T>
+		struct bulk_impl<T, std::enable_if_t<std::is_arithmetic_v<T> && !std::is_same_v<T, bool>>>
+		{
+			static constexpr bool enabled = true;
+			using value_type = T;
+			static constexpr std::size_t size = 1;
+		};
+
+		template<class T>
+		struct bulk_impl<T, std::enable_if_t<std::is_enum_v<T>>>
+		{
+			static constexpr bool enabled = bulk_impl<std::underlying_type_t<T>>::enabled;
+			using value_type = std::underlying_type_t<T>;
+			static constexpr std::size_t size = 1;
+		};
+
+		namespace detail
+		{
+
+			template<std::size_t Bytes> struct unsigned_of_size;
+			template<> struct unsigned_of_size<1> { using type = std::uint8_t; };
+			template<> struct unsigned_of_size<2> { using type = std::uint16_t; };
+			template<> struct unsigned_of_size<4> { using type = std::uint32_t; };
+			template<> struct unsigned_of_size<8> { using type = std::uint64_t; };
+
+			// values are byte swapped through a small buffer when the stream endianness isn't native
+			std::size_t constexpr BULK_SWAP_BUFFER_SIZE = 4096;
+
+		} // detail
+
+		/* write_array(), read_array()
+		 *
+		 * Write / read `count` values of type T. Types with bulk_impl enabled
+		 * are copied straight to / from the stream, other types are written
+		 * one at a time with write_impl / read_impl.
+		 *
+		 * Neither function writes / reads the count itself.
+		 *
+		 */
+		template<class T>
+		void write_array(std::ostream& os, T const* data, std::size_t count)
+		{
+			if constexpr (bulk_impl<T>::enabled)
+			{
+				using value_t = typename bulk_impl<T>::value_type;
+				using unsigned_t = typename detail::unsigned_of_size<sizeof(value_t)>::type;
+				static_assert(sizeof(T) == sizeof(value_t) * bulk_impl<T>::size, "type T must be made of bulk_impl<T>::size values with no padding");
+
+				auto constexpr no_swap = (sizeof(value_t) == 1);
+
+				if (no_swap || get_endian(os) == std::endian::native)
+				{
+					os.write(reinterpret_cast<char const*>(data), std::streamsize(sizeof(T) * count));
+					return;
+				}
+
+				auto const values = reinterpret_cast<unsigned_t const*>(data);
+				auto const total = count * bulk_impl<T>::size;
+
+				unsigned_t buffer[detail::BULK_SWAP_BUFFER_SIZE];
+
+				for (auto i = std::size_t{ 0 }; i < total; i += detail::BULK_SWAP_BUFFER_SIZE)
+				{
+					auto const n = std::min(total - i, detail::BULK_SWAP_BUFFER_SIZE);
+
+					for (auto j = std::size_t{ 0 }; j != n; ++j)
+						buffer[j] = std::byteswap(values[i + j]);
+
+					os.write(reinterpret_cast<char const*>(buffer), std::streamsize(sizeof(unsigned_t) * n));
+				}
+			}
+			else
+			{
+				for (auto i = std::size_t{ 0 }; i != count; ++i)
+					io::write<T>(os, data[i]);
+			}
+		}
+
+		template<class T>
+		void read_array(std::istream& is, T* data, std::size_t count)
+		{
+			if constexpr (bulk_impl<T>::enabled)
+			{
+				using value_t = typename bulk_impl<T>::value_type;
+				using unsigned_t = typename detail::unsigned_of_size<sizeof(value_t)>::type;
+				static_assert(sizeof(T) == sizeof(value_t) * bulk_impl<T>::size, "type T must be made of bulk_impl<T>::size values with no padding");
+
+				auto constexpr no_swap = (sizeof(value_t) == 1);
+
+				is.read(reinterpret_cast<char*>(data), std::streamsize(sizeof(T) * count));
+
+				if (no_swap || get_endian(is) == std::endian::native)
+					return;
+
+				auto const values = reinterpret_cast<unsigned_t*>(data);
+
+				for (auto i = std::size_t{ 0 }; i != count * bulk_impl<T>::size; ++i)
+					values[i] = std::byteswap(values[i]);
+			}
+			else
+			{
+				for (auto i = std::size_t{ 0 }; i != count; ++i)
+					data[i] = io::read<T>(is);
+			}
+		}
+
 	} // io
 
 } // bump
@@ -2,6 +2,9 @@
 
 #include <gtest/gtest.h>
 
+#include <string>
+#include <vector>
+
 namespace bump
 {
 
@@ -56,6 +59,59 @@ namespace bump
 			set_endian(is, std::endian::native);
 			EXPECT_EQ(read<std::uint16_t>(is), (std::uint16_t{ 0x1234 }));
 		}
+
+		TEST(Test_bump_io_read_write, array_matches_single_values)
+		{
+			auto values = std::vector<std::int32_t>();
+
+			for (auto i = 0; i != 10000; ++i)
+				values.push_back(i * 7919 - 123456);
+
+			for (auto endian : { std::endian::big, std::endian::little })
+			{
+				auto single = std::ostringstream();
+				set_endian(single, endian);
+
+				for (auto v : values)
+					write(single, v);
+
+				auto bulk = std::ostringstream();
+				set_endian(bulk, endian);
+				write_array(bulk, values.data(), values.size());
+
+				EXPECT_EQ(single.str(), bulk.str());
+
+				auto is = std::istringstream(bulk.str());
+				set_endian(is, endian);
+
+				auto result = std::vector<std::int32_t>(values.size());
+				read_array(is, result.data(), result.size());
+
+				EXPECT_TRUE(is);
+				EXPECT_EQ(result, values);
+			}
+		}
+
+		TEST(Test_bump_io_read_write, array_of_vectors)
+		{
+			static_assert(bulk_impl<glm::ivec2>::enabled);
+			static_assert(!bulk_impl<std::string>::enabled);
+
+			auto const values = std::vector<glm::ivec2>{ { 1, 2 }, { -3, 4 }, { 0x12345678, -1 } };
+
+			auto os = std::ostringstream();
+			write_array(os, values.data(), values.size());
+
+			auto s = std::move(os.str());
+			EXPECT_EQ(s.size(), 24);
+			EXPECT_EQ(s.substr(16, 4), (std::string{ '\x12', '\x34', '\x56', '\x78' }));
+
+			auto is = std::istringstream(std::move(s));
+			auto result = std::vector<glm::ivec2>(values.size());
+			read_array(is, result.data(), result.size());
+
+			EXPECT_EQ(result, values);
+		}
 	
 	} // io
 
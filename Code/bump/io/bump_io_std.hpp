@@ -4,6 +4,7 @@
 #include "bump_log.hpp"
 #include "bump_range.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <map>
 #include <string>
@@ -15,6 +16,13 @@ namespace bump
 
 	namespace io
 	{
+
+		namespace detail
+		{
+
+			std::uint64_t constexpr READ_BLOCK_SIZE = 64 * 1024; // items
+
+		} // detail
 	
 #pragma region std::pair
 
@@ -98,9 +106,7 @@ namespace bump
 			static void write(std::ostream& os, std::basic_string<CharT, Traits, Alloc> const& value)
 			{
 				io::write<std::uint64_t>(os, value.size());
-
-				for (auto const& item : value)
-					io::write<CharT>(os, item);
+				io::write_array<CharT>(os, value.data(), value.size());
 			}
 		};
 
@@ -110,9 +116,7 @@ namespace bump
 			static void write(std::ostream& os, std::basic_string_view<CharT, Traits> const& value)
 			{
 				io::write<std::uint64_t>(os, value.size());
-
-				for (auto const& item : value)
-					io::write<CharT>(os, item);
+				io::write_array<CharT>(os, value.data(), value.size());
 			}
 		};
 
@@ -132,10 +136,14 @@ namespace bump
 					return { };
 				}
 
-				result.reserve(size);
-
-				for ([[maybe_unused]] auto _ : range(0, size))
-					result.push_back(io::read<CharT>(is));
+				// read in blocks, so a bad size fails at the end of the stream, instead of with a huge allocation
+				for (auto read = std::uint64_t{ 0 }; read != size && is; )
+				{
+					auto const n = std::min<std::uint64_t>(size - read, detail::READ_BLOCK_SIZE);
+					result.resize(std::size_t(read + n));
+					io::read_array<CharT>(is, result.data() + read, std::size_t(n));
+					read += n;
+				}
 
 				return result;
 			}
@@ -152,8 +160,11 @@ namespace bump
 			{
 				io::write<std::uint64_t>(os, value.size());
 
-				for (auto const& item : value)
-					io::write<T>(os, item);
+				if constexpr (bulk_impl<T>::enabled)
+					io::write_array<T>(os, value.data(), value.size());
+				else
+					for (auto const& item : value)
+						io::write<T>(os, item);
 			}
 		};
 
@@ -173,10 +184,25 @@ namespace bump
 					return { };
 				}
 
-				result.reserve(size);
+				if constexpr (bulk_impl<T>::enabled)
+				{
+					// read in blocks, so a bad size fails at the end of the stream, instead of with a huge allocation
+					for (auto read = std::uint64_t{ 0 }; read != size && is; )
+					{
+						auto const n = std::min<std::uint64_t>(size - read, detail::READ_BLOCK_SIZE);
+						result.resize(std::size_t(read + n));
+						io::read_array<T>(is, result.data() + read, std::size_t(n));
+						read += n;
+					}
+				}
+				else
+				{
+					// (likewise, only reserve up to a block, and stop at the first error)
+					result.reserve(std::size_t(std::min<std::uint64_t>(size, detail::READ_BLOCK_SIZE)));
 
-				for ([[maybe_unused]] auto _ : range(0, size))
-					result.push_back(io::read<T>(is));
+					for (auto read = std::uint64_t{ 0 }; read != size && is; ++read)
+						result.push_back(io::read<T>(is));
+				}
 
 				return result;
 			}
@@ -2,6 +2,8 @@
 
 #include "bump_lua_io.hpp"
 #include "bump_lua_state.hpp"
+#include "bump_metrics.hpp"
+#include "bump_trace.hpp"
 
 namespace bump
 {
@@ -37,6 +39,9 @@ namespace bump
 				if (lua.call(num_args, num_rets) != lua_status::ok)
 					throw std::runtime_error(lua.pop_string());
 
+				static auto& memory_bytes = metrics::get_gauge("lua.memory_bytes");
+				memory_bytes.set(lua.gc_count_bytes());
+
 				if constexpr (num_rets == 0)
 				{
 					return;
@@ -60,6 +65,8 @@ namespace bump
 		template<class... Rets, class... Args>
 		auto run(state_view& lua, std::string const& code, Args&&... args)
 		{
+			auto const zone = trace::zone("lua::run");
+
 			if (lua.load_string(code) != lua_status::ok)
 				throw std::runtime_error(lua.pop_string());
 			
@@ -69,6 +76,8 @@ namespace bump
 		template<class... Rets, class... Args>
 		auto frun(state_view& lua, std::string const& file_path, Args&&... args)
 		{
+			auto const zone = trace::zone("lua::frun");
+
 			if (lua.load_file(file_path) != lua_status::ok)
 				throw std::runtime_error(lua.pop_string());
 			
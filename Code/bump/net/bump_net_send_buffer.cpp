@@ -1,5 +1,7 @@
 #include "bump_net_send_buffer.hpp"
 
+#include "bump_metrics.hpp"
+
 namespace bump
 {
 	
@@ -21,6 +23,9 @@ namespace bump
 			m_buffer.clear();
 			m_stream.erase(m_stream.begin(), m_stream.begin() + bytes_sent.value());
 
+			static auto& total_bytes_sent = metrics::get_counter("net.bytes_sent");
+			total_bytes_sent.add(bytes_sent.value());
+
 			return make_ok(bytes_sent.value());
 		}
 		
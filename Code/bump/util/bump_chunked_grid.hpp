@@ -0,0 +1,256 @@
+#pragma once
+
+#include "bump_die.hpp"
+#include "bump_math.hpp"
+#include "bump_range.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace bump
+{
+
+	/* chunked_grid2
+	 *
+	 * A 2D grid stored as square chunks of CHUNK_SIZE x CHUNK_SIZE values.
+	 *
+	 * Chunks start out "uniform" (every value in the chunk is the same, so
+	 * only that value is stored), and the chunk's data is only allocated
+	 * when a different value is set. compact() turns allocated chunks back
+	 * into uniform ones where possible.
+	 *
+	 * This means that memory scales with the area that's actually been
+	 * changed (explored, populated, etc.), rather than the grid's extents.
+	 *
+	 * Values can't be set through references, since that would need the
+	 * chunk to be allocated for every non-const access. Use set() instead.
+	 *
+	 */
+	template<class T, std::int32_t CHUNK_SIZE = 32>
+	class chunked_grid2
+	{
+	public:
+
+		static_assert(CHUNK_SIZE > 0, "chunked_grid2<T>: chunk size must not be zero.");
+		static_assert(!std::is_same_v<T, bool>, "chunked_grid2<T>: use bit_grid (or std::uint8_t) for bools."); // std::vector<bool> can't return references
+
+		using value_type = T;
+		using coords_type = glm::ivec2;
+
+		static constexpr std::int32_t CHUNK_AREA = CHUNK_SIZE * CHUNK_SIZE;
+
+		chunked_grid2():
+			m_extents(0), m_chunk_extents(0) { }
+
+		explicit chunked_grid2(coords_type extents, value_type const& value = value_type()):
+			m_extents(extents),
+			m_chunk_extents((extents + (CHUNK_SIZE - 1)) / CHUNK_SIZE),
+			m_chunks(m_chunk_extents.x * m_chunk_extents.y, chunk{ value, { } })
+		{
+			die_if(extents.x < 0 || extents.y < 0);
+		}
+
+		coords_type extents() const { return m_extents; }
+		coords_type chunk_extents() const { return m_chunk_extents; }
+
+		bool in_bounds(coords_type coords) const
+		{
+			return coords.x >= 0 && coords.y >= 0 && coords.x < m_extents.x && coords.y < m_extents.y;
+		}
+
+		value_type const& at(coords_type coords) const
+		{
+			die_if(!in_bounds(coords));
+
+			auto const& c = m_chunks[chunk_index(coords)];
+			return c.is_uniform() ? c.m_value : c.m_data[local_index(coords)];
+		}
+
+		void set(coords_type coords, value_type const& value)
+		{
+			die_if(!in_bounds(coords));
+
+			auto& c = m_chunks[chunk_index(coords)];
+
+			if (c.is_uniform())
+			{
+				if (c.m_value == value)
+					return;
+
+				c.m_data.assign(CHUNK_AREA, c.m_value);
+			}
+
+			c.m_data[local_index(coords)] = value;
+		}
+
+		// sets every value in the grid (freeing all chunk data)
+		void fill(value_type const& value)
+		{
+			for (auto& c : m_chunks)
+				c = chunk{ value, { } };
+		}
+
+		/* assign()
+		 *
+		 * Sets every value in the grid from `values`, an array of
+		 * extents.x * extents.y values in row order. Chunks where every value
+		 * is the same are left uniform.
+		 *
+		 */
+		void assign(value_type const* values)
+		{
+			for (auto cy : range(0, m_chunk_extents.y))
+			{
+				for (auto cx : range(0, m_chunk_extents.x))
+				{
+					auto& c = m_chunks[cy * m_chunk_extents.x + cx];
+					auto const origin = coords_type{ cx, cy } * CHUNK_SIZE;
+					auto const end = glm::min(origin + CHUNK_SIZE, m_extents);
+
+					auto const width = end.x - origin.x;
+					auto const row_start = [&] (std::int32_t y) { return values + std::size_t(y) * m_extents.x + origin.x; };
+					auto const& first = *row_start(origin.y);
+
+					auto uniform = true;
+
+					for (auto y : range(origin.y, end.y))
+						uniform = uniform && std::all_of(row_start(y), row_start(y) + width, [&] (value_type const& v) { return v == first; });
+
+					if (uniform)
+					{
+						c = chunk{ first, { } };
+						continue;
+					}
+
+					// (any part of the chunk outside the grid gets the first value)
+					c.m_data.assign(CHUNK_AREA, first);
+
+					for (auto y : range(origin.y, end.y))
+						std::copy(row_start(y), row_start(y) + width, c.m_data.begin() + (y - origin.y) * CHUNK_SIZE);
+				}
+			}
+		}
+
+		/* compact()
+		 *
+		 * Frees the data of any allocated chunks where every value is the
+		 * same. Returns the number of chunks freed.
+		 *
+		 * Only the part of a chunk inside the grid is compared (the rest of
+		 * an edge chunk is never set, so it may still hold an old value).
+		 *
+		 */
+		std::size_t compact()
+		{
+			auto freed = std::size_t{ 0 };
+
+			for (auto cy : range(0, m_chunk_extents.y))
+			{
+				for (auto cx : range(0, m_chunk_extents.x))
+				{
+					auto& c = m_chunks[cy * m_chunk_extents.x + cx];
+
+					if (c.is_uniform())
+						continue;
+
+					auto const origin = coords_type{ cx, cy } * CHUNK_SIZE;
+					auto const size = glm::min(origin + CHUNK_SIZE, m_extents) - origin;
+
+					auto const row_start = [&] (std::int32_t y) { return c.m_data.begin() + y * CHUNK_SIZE; };
+					auto const& first = c.m_data.front();
+
+					auto uniform = true;
+
+					for (auto y : range(0, size.y))
+						uniform = uniform && std::all_of(row_start(y), row_start(y) + size.x, [&] (value_type const& v) { return v == first; });
+
+					if (!uniform)
+						continue;
+
+					c.m_value = first;
+					c.m_data = std::vector<value_type>();
+					++freed;
+				}
+			}
+
+			return freed;
+		}
+
+		bool is_chunk_uniform(coords_type chunk_coords) const { return m_chunks[chunk_coords.y * m_chunk_extents.x + chunk_coords.x].is_uniform(); }
+
+		std::size_t allocated_chunk_count() const
+		{
+			auto count = std::size_t{ 0 };
+
+			for (auto const& c : m_chunks)
+				count += !c.is_uniform();
+
+			return count;
+		}
+
+		// approximate heap memory used (in bytes)
+		std::size_t memory_usage() const
+		{
+			return m_chunks.capacity() * sizeof(chunk) + allocated_chunk_count() * CHUNK_AREA * sizeof(value_type);
+		}
+
+		/* for_each()
+		 *
+		 * Calls f(coords, value) for every tile in the grid, a chunk at a
+		 * time (and in row order within each chunk), so that allocated chunks
+		 * are read contiguously.
+		 *
+		 */
+		template<class F>
+		void for_each(F&& f) const
+		{
+			for (auto cy : range(0, m_chunk_extents.y))
+			{
+				for (auto cx : range(0, m_chunk_extents.x))
+				{
+					auto const& c = m_chunks[cy * m_chunk_extents.x + cx];
+					auto const origin = coords_type{ cx, cy } * CHUNK_SIZE;
+					auto const end = glm::min(origin + CHUNK_SIZE, m_extents);
+
+					for (auto y : range(origin.y, end.y))
+					{
+						auto const row = c.is_uniform() ? nullptr : c.m_data.data() + (y - origin.y) * CHUNK_SIZE;
+
+						for (auto x : range(origin.x, end.x))
+							f(coords_type{ x, y }, row ? row[x - origin.x] : c.m_value);
+					}
+				}
+			}
+		}
+
+	private:
+
+		struct chunk
+		{
+			value_type m_value; // the value of every tile (only used if m_data is empty)
+			std::vector<value_type> m_data;
+
+			bool is_uniform() const { return m_data.empty(); }
+		};
+
+		std::size_t chunk_index(coords_type coords) const
+		{
+			auto const c = coords / CHUNK_SIZE;
+			return std::size_t(c.y) * m_chunk_extents.x + c.x;
+		}
+
+		static std::size_t local_index(coords_type coords)
+		{
+			auto const l = coords % CHUNK_SIZE;
+			return std::size_t(l.y) * CHUNK_SIZE + l.x;
+		}
+
+		coords_type m_extents;
+		coords_type m_chunk_extents;
+		std::vector<chunk> m_chunks;
+	};
+
+} // bump
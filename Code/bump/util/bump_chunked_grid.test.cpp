@@ -0,0 +1,122 @@
+#include <bump_chunked_grid.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace bump
+{
+
+	TEST(Test_bump_chunked_grid, starts_uniform)
+	{
+		auto g = chunked_grid2<std::int32_t, 4>({ 10, 7 }, 5);
+
+		EXPECT_EQ(g.extents(), glm::ivec2(10, 7));
+		EXPECT_EQ(g.chunk_extents(), glm::ivec2(3, 2));
+		EXPECT_EQ(g.allocated_chunk_count(), 0);
+
+		for (auto y : range(0, 7))
+			for (auto x : range(0, 10))
+				EXPECT_EQ(g.at({ x, y }), 5);
+	}
+
+	TEST(Test_bump_chunked_grid, set_allocates_one_chunk)
+	{
+		auto g = chunked_grid2<std::int32_t, 4>({ 10, 7 }, 0);
+
+		g.set({ 9, 6 }, 0);
+		EXPECT_EQ(g.allocated_chunk_count(), 0);
+
+		g.set({ 9, 6 }, 3);
+		g.set({ 8, 5 }, 4);
+		EXPECT_EQ(g.allocated_chunk_count(), 1);
+		EXPECT_FALSE(g.is_chunk_uniform({ 2, 1 }));
+
+		EXPECT_EQ(g.at({ 9, 6 }), 3);
+		EXPECT_EQ(g.at({ 8, 5 }), 4);
+		EXPECT_EQ(g.at({ 8, 6 }), 0);
+		EXPECT_EQ(g.at({ 7, 6 }), 0);
+	}
+
+	TEST(Test_bump_chunked_grid, compact)
+	{
+		auto g = chunked_grid2<std::int32_t, 4>({ 8, 8 }, 0);
+
+		g.set({ 1, 1 }, 1);
+		g.set({ 5, 5 }, 1);
+		EXPECT_EQ(g.allocated_chunk_count(), 2);
+
+		g.set({ 1, 1 }, 0);
+		EXPECT_EQ(g.compact(), 1);
+		EXPECT_EQ(g.allocated_chunk_count(), 1);
+		EXPECT_EQ(g.at({ 5, 5 }), 1);
+
+		for (auto y : range(4, 8))
+			for (auto x : range(4, 8))
+				g.set({ x, y }, 1);
+
+		EXPECT_EQ(g.compact(), 1);
+		EXPECT_EQ(g.allocated_chunk_count(), 0);
+		EXPECT_EQ(g.at({ 4, 7 }), 1);
+		EXPECT_EQ(g.at({ 3, 7 }), 0);
+	}
+
+	TEST(Test_bump_chunked_grid, compact_edge_chunk)
+	{
+		auto g = chunked_grid2<std::int32_t, 4>({ 6, 6 }, 0);
+
+		// the bottom right chunk only has 2x2 tiles inside the grid
+		for (auto y : range(4, 6))
+			for (auto x : range(4, 6))
+				g.set({ x, y }, 1);
+
+		EXPECT_FALSE(g.is_chunk_uniform({ 1, 1 }));
+		EXPECT_EQ(g.compact(), 1);
+		EXPECT_EQ(g.allocated_chunk_count(), 0);
+		EXPECT_TRUE(g.is_chunk_uniform({ 1, 1 }));
+		EXPECT_EQ(g.at({ 5, 5 }), 1);
+		EXPECT_EQ(g.at({ 3, 5 }), 0);
+	}
+
+	TEST(Test_bump_chunked_grid, for_each_visits_every_tile_once)
+	{
+		auto g = chunked_grid2<std::int32_t, 4>({ 10, 7 }, -1);
+
+		for (auto y : range(0, 7))
+			for (auto x : range(0, 10))
+				if ((x + y) % 3 == 0)
+					g.set({ x, y }, y * 10 + x);
+
+		auto visited = 0;
+
+		g.for_each([&] (glm::ivec2 p, std::int32_t v)
+		{
+			++visited;
+			EXPECT_EQ(v, ((p.x + p.y) % 3 == 0) ? p.y * 10 + p.x : -1);
+		});
+
+		EXPECT_EQ(visited, 70);
+	}
+
+	TEST(Test_bump_chunked_grid, assign)
+	{
+		auto values = std::vector<std::int32_t>(10 * 7, 2);
+		values[6 * 10 + 9] = 8; // only in the last chunk
+
+		auto g = chunked_grid2<std::int32_t, 4>({ 10, 7 }, 0);
+		g.set({ 0, 0 }, 1);
+		g.assign(values.data());
+
+		EXPECT_EQ(g.allocated_chunk_count(), 1);
+		EXPECT_FALSE(g.is_chunk_uniform({ 2, 1 }));
+
+		for (auto y : range(0, 7))
+			for (auto x : range(0, 10))
+				EXPECT_EQ(g.at({ x, y }), values[y * 10 + x]);
+
+		g.set({ 9, 6 }, 2);
+		EXPECT_EQ(g.compact(), 1);
+	}
+
+} // bump
@@ -1,15 +1,64 @@
 
 #include "rog_gamestates.hpp"
+#include "rog_journal.hpp"
 
 #include <bump_app.hpp>
 #include <bump_gamestate.hpp>
 #include <bump_log.hpp>
+#include <bump_metrics.hpp>
 
 #include <SDL.h>
 #include <SDL_main.h>
 
-int main(int , char* [])
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+int main(int argc, char* argv[])
 {
+	// rog [journal [cycle]]: replays a session journal (to the given cycle, or the end), then carries on from there
+	auto replay = std::optional<rog::journal>();
+	auto replay_to_cycle = std::numeric_limits<std::uint64_t>::max();
+
+	if (argc > 1)
+	{
+		replay = rog::load_journal(argv[1]);
+
+		if (!replay.has_value())
+			return EXIT_FAILURE;
+
+		if (argc > 2)
+		{
+			auto const arg = std::string_view(argv[2]);
+			auto const [end, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), replay_to_cycle);
+
+			if (ec != std::errc() || end != arg.data() + arg.size())
+			{
+				bump::log_error("usage: rog [journal [cycle]] (invalid cycle: {})", arg);
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	// metrics are appended to a file every few seconds (emptied at the start of each session, so it doesn't grow forever)
+	{
+		auto const metrics_dir = std::filesystem::temp_directory_path() / "rog";
+		auto ec = std::error_code();
+		std::filesystem::create_directories(metrics_dir, ec);
+
+		auto const metrics_path = metrics_dir / "metrics.txt";
+		std::ofstream(metrics_path, std::ios::trunc);
+
+		bump::metrics::start_reporting(std::chrono::seconds(10), metrics_path);
+	}
 
 	{
 		auto const metadata = bump::asset_metadata
@@ -50,9 +99,15 @@ int main(int , char* [])
 		};
 
 		auto app = bump::app(metadata, { 1024, 768 }, "rog", bump::sdl::window::display_mode::WINDOWED);
-		bump::run_state({ [] (bump::app& app) { return rog::gamestate_dungeon(app, 1); } }, app);
+
+		if (replay.has_value())
+			bump::run_state({ [&] (bump::app& app) { return rog::gamestate_dungeon_replay(app, replay.value(), replay_to_cycle); } }, app);
+		else
+			bump::run_state({ [] (bump::app& app) { return rog::gamestate_dungeon(app, 1); } }, app);
 	}
 
+	bump::metrics::stop_reporting();
+
 	bump::log_info("done!");
 
 	return EXIT_SUCCESS;
@@ -0,0 +1,228 @@
+#include "rog_bit_grid.hpp"
+
+#include <bump_die.hpp>
+#include <bump_range.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+namespace rog
+{
+
+	bit_grid::bit_grid(glm::ivec2 extents, bool value)
+	{
+		resize(extents, value);
+	}
+
+	void bit_grid::resize(glm::ivec2 extents, bool value)
+	{
+		bump::die_if(extents.x < 0 || extents.y < 0);
+
+		m_extents = extents;
+		m_words_per_row = (extents.x + WORD_BITS - 1) / WORD_BITS;
+		m_words.assign(std::size_t(m_words_per_row) * std::size_t(extents.y), word_t{ 0 });
+
+		if (value)
+			fill(true);
+	}
+
+	void bit_grid::fill(bool value)
+	{
+		if (!value)
+		{
+			std::fill(m_words.begin(), m_words.end(), word_t{ 0 });
+			return;
+		}
+
+		std::fill(m_words.begin(), m_words.end(), ~word_t{ 0 });
+
+		// keep the bits past the end of each row clear
+		auto const extra_bits = m_extents.x % WORD_BITS;
+
+		if (extra_bits == 0)
+			return;
+
+		auto const last_word_mask = (word_t{ 1 } << extra_bits) - 1;
+
+		for (auto y : bump::range(0, m_extents.y))
+			row(y)[m_words_per_row - 1] = last_word_mask;
+	}
+
+	void bit_grid::set(glm::ivec2 pos, bool value)
+	{
+		auto const bit = word_t{ 1 } << (pos.x % WORD_BITS);
+
+		if (value)
+			word(pos) |= bit;
+		else
+			word(pos) &= ~bit;
+	}
+
+	std::uint32_t bit_grid::get_triple(std::int32_t x, std::int32_t y) const
+	{
+		if (y < 0 || y >= m_extents.y)
+			return 0;
+
+		auto const first = x - 1;
+		auto const shift = first % WORD_BITS;
+
+		// all three bits in the same word
+		if (first >= 0 && x + 1 < m_extents.x && shift <= WORD_BITS - 3)
+			return std::uint32_t(row(y)[first / WORD_BITS] >> shift) & 0b111u;
+
+		auto result = 0u;
+
+		for (auto i : bump::range(0, 3))
+			if (in_bounds({ first + i, y }) && test({ first + i, y }))
+				result |= (1u << i);
+
+		return result;
+	}
+
+	std::uint8_t bit_grid::neighbours(glm::ivec2 pos) const
+	{
+		auto const above = get_triple(pos.x, pos.y - 1);
+		auto const middle = get_triple(pos.x, pos.y);
+		auto const below = get_triple(pos.x, pos.y + 1);
+
+		return std::uint8_t(above | ((middle & 0b001u) << 3) | ((middle & 0b100u) << 2) | (below << 5));
+	}
+
+	std::size_t bit_grid::count() const
+	{
+		return std::accumulate(m_words.begin(), m_words.end(), std::size_t{ 0 },
+			[] (std::size_t total, word_t w) { return total + std::size_t(std::popcount(w)); });
+	}
+
+	bool intersects(bit_grid const& a, bit_grid const& b)
+	{
+		bump::die_if(a.extents() != b.extents());
+
+		for (auto y : bump::range(0, a.extents().y))
+			for (auto w : bump::range(0, a.words_per_row()))
+				if (a.row(y)[w] & b.row(y)[w])
+					return true;
+
+		return false;
+	}
+
+	namespace
+	{
+
+		using word_t = bit_grid::word_t;
+
+		word_t reverse_bits(word_t v)
+		{
+			v = ((v >> 1) & 0x5555555555555555ull) | ((v & 0x5555555555555555ull) << 1);
+			v = ((v >> 2) & 0x3333333333333333ull) | ((v & 0x3333333333333333ull) << 2);
+			v = ((v >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((v & 0x0F0F0F0F0F0F0F0Full) << 4);
+			v = ((v >> 8) & 0x00FF00FF00FF00FFull) | ((v & 0x00FF00FF00FF00FFull) << 8);
+			v = ((v >> 16) & 0x0000FFFF0000FFFFull) | ((v & 0x0000FFFF0000FFFFull) << 16);
+			return (v >> 32) | (v << 32);
+		}
+
+		// adding a seed bit to a run of set bits carries all the way to the
+		// end of the run, so ((p + s) ^ p) & p is every bit from each seed to
+		// the (upper) end of its run. the carry continues into the next word.
+		word_t fill_runs_up(word_t p, word_t s, word_t& carry)
+		{
+			auto const sum = p + s;
+			auto const carry_out = (sum < p);
+			auto const total = sum + carry;
+
+			carry = word_t(carry_out || total < sum);
+
+			return (((total ^ p) & p) | s);
+		}
+
+		// expands each seed in `seeds` (which must be a subset of `passable`)
+		// to the whole run of set bits containing it
+		void fill_row_runs(word_t const* passable, word_t* seeds, std::int32_t words)
+		{
+			auto carry = word_t{ 0 };
+
+			for (auto w : bump::range(0, words))
+				seeds[w] = fill_runs_up(passable[w], seeds[w], carry);
+
+			// same thing in the other direction, on the reversed row
+			carry = 0;
+
+			for (auto w = words - 1; w >= 0; --w)
+			{
+				auto const down = fill_runs_up(reverse_bits(passable[w]), reverse_bits(seeds[w]), carry);
+				seeds[w] |= reverse_bits(down);
+			}
+		}
+
+		// a row with each bit spread to the bits either side of it
+		word_t spread(word_t const* row, std::int32_t w, std::int32_t words)
+		{
+			auto const v = row[w];
+			auto result = v | (v << 1) | (v >> 1);
+
+			if (w > 0)
+				result |= row[w - 1] >> (bit_grid::WORD_BITS - 1);
+
+			if (w + 1 < words)
+				result |= row[w + 1] << (bit_grid::WORD_BITS - 1);
+
+			return result;
+		}
+
+	} // unnamed
+
+	void flood_fill(bit_grid const& passable, glm::ivec2 src, bit_grid& reached)
+	{
+		auto const extents = passable.extents();
+		auto const words = passable.words_per_row();
+
+		reached.resize(extents, false);
+
+		if (!passable.in_bounds(src) || !passable.test(src))
+			return;
+
+		reached.set(src, true);
+
+		auto row_seeds = std::vector<word_t>(std::size_t(words));
+
+		// returns true if anything was added to row y
+		auto const fill_row = [&] (std::int32_t y)
+		{
+			auto const pass = passable.row(y);
+			auto const current = reached.row(y);
+
+			for (auto w : bump::range(0, words))
+			{
+				auto seeds = current[w];
+
+				if (y > 0)
+					seeds |= spread(reached.row(y - 1), w, words);
+
+				if (y + 1 < extents.y)
+					seeds |= spread(reached.row(y + 1), w, words);
+
+				row_seeds[w] = seeds & pass[w];
+			}
+
+			fill_row_runs(pass, row_seeds.data(), words);
+
+			if (std::equal(row_seeds.begin(), row_seeds.end(), current))
+				return false;
+
+			std::copy(row_seeds.begin(), row_seeds.end(), reached.row(y));
+			return true;
+		};
+
+		for (auto changed = true; changed; )
+		{
+			changed = false;
+
+			for (auto y : bump::range(0, extents.y))
+				changed |= fill_row(y);
+
+			for (auto y = extents.y - 1; y >= 0; --y)
+				changed |= fill_row(y);
+		}
+	}
+
+} // rog
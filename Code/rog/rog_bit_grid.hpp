@@ -0,0 +1,113 @@
+#pragma once
+
+#include <bump_math.hpp>
+#include <bump_range.hpp>
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace rog
+{
+
+	/* bit_grid
+	 *
+	 * A 2d grid of bits, packed into 64 bit words. Each row starts at a new
+	 * word, and the unused bits at the end of each row are always zero, so
+	 * whole rows can be combined with bitwise operations.
+	 *
+	 * Bit `x % 64` of word `x / 64` in a row is the tile at `x`.
+	 *
+	 */
+	class bit_grid
+	{
+	public:
+
+		using word_t = std::uint64_t;
+		static constexpr std::int32_t WORD_BITS = 64;
+
+		// bit i of neighbours() corresponds to the tile at pos + neighbour_offsets[i]
+		static constexpr auto neighbour_offsets = std::array<glm::ivec2, 8>
+		{
+			glm::ivec2{ -1, -1 }, glm::ivec2{  0, -1 }, glm::ivec2{ +1, -1 },
+			glm::ivec2{ -1,  0 },                       glm::ivec2{ +1,  0 },
+			glm::ivec2{ -1, +1 }, glm::ivec2{  0, +1 }, glm::ivec2{ +1, +1 },
+		};
+
+		bit_grid() = default;
+		explicit bit_grid(glm::ivec2 extents, bool value = false);
+
+		glm::ivec2 extents() const { return m_extents; }
+		std::int32_t words_per_row() const { return m_words_per_row; }
+
+		void resize(glm::ivec2 extents, bool value = false);
+		void fill(bool value);
+
+		bool in_bounds(glm::ivec2 pos) const { return pos.x >= 0 && pos.y >= 0 && pos.x < m_extents.x && pos.y < m_extents.y; }
+
+		bool test(glm::ivec2 pos) const { return (word(pos) >> (pos.x % WORD_BITS)) & word_t{ 1 }; }
+		void set(glm::ivec2 pos, bool value);
+
+		/* neighbours()
+		 *
+		 * Returns the 8 tiles around `pos` as a bitmask, in the order of
+		 * neighbour_offsets. Tiles outside the grid are zero.
+		 *
+		 */
+		std::uint8_t neighbours(glm::ivec2 pos) const;
+
+		word_t* row(std::int32_t y) { return m_words.data() + std::size_t(y) * m_words_per_row; }
+		word_t const* row(std::int32_t y) const { return m_words.data() + std::size_t(y) * m_words_per_row; }
+
+		std::size_t count() const;
+
+		// calls f(pos) for each set bit, in row order
+		template<class FuncT>
+		void for_each_set(FuncT&& f) const;
+
+		bool operator==(bit_grid const&) const = default;
+
+	private:
+
+		word_t const& word(glm::ivec2 pos) const { return row(pos.y)[pos.x / WORD_BITS]; }
+		word_t& word(glm::ivec2 pos) { return row(pos.y)[pos.x / WORD_BITS]; }
+
+		// bits x - 1, x and x + 1 of row y (as bits 0, 1 and 2)
+		std::uint32_t get_triple(std::int32_t x, std::int32_t y) const;
+
+		glm::ivec2 m_extents = glm::ivec2(0);
+		std::int32_t m_words_per_row = 0;
+		std::vector<word_t> m_words;
+	};
+
+	template<class FuncT>
+	void bit_grid::for_each_set(FuncT&& f) const
+	{
+		for (auto y : bump::range(0, m_extents.y))
+		{
+			auto const r = row(y);
+
+			for (auto w : bump::range(0, m_words_per_row))
+				for (auto bits = r[w]; bits != 0; bits &= bits - 1)
+					f(glm::ivec2{ w * WORD_BITS + std::countr_zero(bits), y });
+		}
+	}
+
+	// true if any bit is set in both grids (which must be the same size)
+	bool intersects(bit_grid const& a, bit_grid const& b);
+
+	/* flood_fill()
+	 *
+	 * Finds every tile that is 8-connected to `src` through set tiles of
+	 * `passable` (including `src`, if it is passable), setting them in
+	 * `reached`.
+	 *
+	 * This works on whole words at a time: each pass spreads the reached
+	 * tiles to their neighbours across a row with shifts, and masks them
+	 * with `passable`. Rows are swept down then up until nothing changes.
+	 *
+	 */
+	void flood_fill(bit_grid const& passable, glm::ivec2 src, bit_grid& reached);
+
+} // rog
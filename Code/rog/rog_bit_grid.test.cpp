@@ -0,0 +1,122 @@
+#include "rog_bit_grid.hpp"
+
+#include "rog_random.hpp"
+
+#include <bump_range.hpp>
+
+#include <gtest/gtest.h>
+
+#include <queue>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		bit_grid make_random_grid(random::rng_t& rng, glm::ivec2 size, float set_chance)
+		{
+			auto grid = bit_grid(size, false);
+
+			for (auto y : bump::range(0, size.y))
+				for (auto x : bump::range(0, size.x))
+					if (random::rand_01<float>(rng) < set_chance)
+						grid.set({ x, y }, true);
+
+			return grid;
+		}
+
+		// a breadth first search, a tile at a time
+		bit_grid flood_fill_slow(bit_grid const& passable, glm::ivec2 src)
+		{
+			auto reached = bit_grid(passable.extents(), false);
+
+			if (!passable.test(src))
+				return reached;
+
+			auto open = std::queue<glm::ivec2>();
+
+			reached.set(src, true);
+			open.push(src);
+
+			while (!open.empty())
+			{
+				auto const current = open.front();
+				open.pop();
+
+				for (auto const& offset : bit_grid::neighbour_offsets)
+				{
+					auto const next = current + offset;
+
+					if (!passable.in_bounds(next) || !passable.test(next) || reached.test(next))
+						continue;
+
+					reached.set(next, true);
+					open.push(next);
+				}
+			}
+
+			return reached;
+		}
+
+	} // unnamed
+
+	TEST(Test_rog_bit_grid, flood_fill_matches_breadth_first_search)
+	{
+		auto rng = random::rng_t(56789);
+		auto reached = bit_grid();
+
+		// (widths at and around word boundaries)
+		for (auto width : { 1, 63, 64, 65, 130 })
+		{
+			for (auto grid : bump::range(0, 30))
+			{
+				auto const size = glm::ivec2{ width, random::rand_range(rng, 1, 24) };
+				auto const passable = make_random_grid(rng, size, random::rand_range(rng, 0.4f, 0.8f));
+
+				for (auto query : bump::range(0, 5))
+				{
+					auto const src = random::rand_range(rng, glm::ivec2(0), size - 1);
+
+					SCOPED_TRACE(testing::Message() << "width " << width << ", grid " << grid << ", query " << query);
+
+					flood_fill(passable, src, reached);
+
+					// (comparing the whole grids also checks the unused bits at the end of each row are zero)
+					EXPECT_EQ(reached, flood_fill_slow(passable, src));
+				}
+			}
+		}
+	}
+
+	TEST(Test_rog_bit_grid, neighbours_order)
+	{
+		auto rng = random::rng_t(67890);
+
+		for (auto width : { 1, 2, 63, 64, 65, 130 })
+		{
+			auto const size = glm::ivec2{ width, 5 };
+			auto const grid = make_random_grid(rng, size, 0.5f);
+
+			for (auto y : bump::range(0, size.y))
+			{
+				for (auto x : bump::range(0, size.x))
+				{
+					auto expected = std::uint8_t{ 0 };
+
+					for (auto i : bump::range(0, 8))
+					{
+						auto const p = glm::ivec2{ x, y } + bit_grid::neighbour_offsets[i];
+
+						if (grid.in_bounds(p) && grid.test(p))
+							expected |= std::uint8_t(1u << i);
+					}
+
+					SCOPED_TRACE(testing::Message() << "width " << width << ", tile " << x << ", " << y);
+					EXPECT_EQ(grid.neighbours({ x, y }), expected);
+				}
+			}
+		}
+	}
+
+} // rog
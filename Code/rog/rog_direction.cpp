@@ -22,5 +22,14 @@ namespace rog
 
 		bump::die();
 	}
+
+	direction get_direction(glm::ivec2 vector)
+	{
+		bump::die_if(vector.x < -1 || vector.x > 1);
+		bump::die_if(vector.y < -1 || vector.y > 1);
+
+		// directions are declared in row-major order, from UP_LEFT to DOWN_RIGHT
+		return static_cast<direction>((vector.y + 1) * 3 + (vector.x + 1));
+	}
 	
 } // rog
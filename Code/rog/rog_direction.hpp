@@ -19,6 +19,7 @@ namespace rog
 	};
 
 	glm::ivec2 get_direction_vector(direction dir);
+	direction get_direction(glm::ivec2 vector); // vector components must be in [-1, 1]
 	
 	enum class stairs_direction
 	{
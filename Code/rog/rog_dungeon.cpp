@@ -0,0 +1,230 @@
+#include "rog_dungeon.hpp"
+
+#include "rog_level_io.hpp"
+
+#include <bump_die.hpp>
+#include <bump_io_compress.hpp>
+#include <bump_log.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <system_error>
+#include <utility>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		// unique to each dungeon in this process, and (very likely) between processes, so dungeons with the same seed don't share swap files
+		std::uint64_t make_instance_id()
+		{
+			static auto const process_id = [] ()
+			{
+				auto rd = std::random_device();
+				return (std::uint64_t(rd()) << 32) | rd();
+			}();
+
+			static auto counter = std::atomic<std::uint64_t>(0);
+
+			return process_id + counter++;
+		}
+
+	} // unnamed
+
+	dungeon::dungeon(std::uint64_t seed, glm::ivec2 level_size, std::size_t memory_budget, std::filesystem::path swap_dir):
+		m_seed(seed),
+		m_level_size(level_size),
+		m_memory_budget(memory_budget),
+		m_swap_dir(std::move(swap_dir)),
+		m_instance_id(make_instance_id()),
+		m_stored_memory(0),
+		m_store_counter(0),
+		m_pregen(seed, level_size) { }
+
+	dungeon::~dungeon()
+	{
+		for (auto const& [depth, s] : m_stored)
+		{
+			if (!s.m_on_disk)
+				continue;
+
+			auto ec = std::error_code();
+			std::filesystem::remove(get_swap_path(depth), ec);
+		}
+	}
+
+	level dungeon::enter(std::int32_t depth)
+	{
+		bump::die_if(depth < 1);
+		bump::die_if(m_current_depth.has_value()); // leave() the current level first!
+
+		auto result = [&] ()
+		{
+			if (auto node = m_live.extract(depth); !node.empty())
+				return std::move(node.mapped());
+
+			if (m_stored.contains(depth))
+				return restore(depth);
+
+			return m_pregen.take(depth);
+		}();
+
+		m_current_depth = depth;
+		m_visited.insert(depth);
+
+		// only the levels next to this one stay live
+		for (auto i = m_live.begin(); i != m_live.end(); )
+		{
+			if (std::abs(i->first - depth) <= 1)
+			{
+				++i;
+				continue;
+			}
+
+			store(i->second);
+			i = m_live.erase(i);
+		}
+
+		for (auto const adjacent : std::array<std::int32_t, 2>{ depth - 1, depth + 1 })
+		{
+			if (adjacent < 1 || m_live.contains(adjacent))
+				continue;
+
+			if (m_stored.contains(adjacent))
+				m_live.emplace(adjacent, restore(adjacent));
+			else if (!is_visited(adjacent))
+				m_pregen.request(adjacent);
+		}
+
+		m_pregen.discard_outside(depth - 1, depth + 1);
+
+		enforce_budget();
+
+		return result;
+	}
+
+	void dungeon::leave(level&& level)
+	{
+		bump::die_if(!m_current_depth.has_value());
+		bump::die_if(level.m_depth != m_current_depth.value());
+
+		auto const depth = level.m_depth;
+		m_live.insert_or_assign(depth, std::move(level));
+		m_current_depth.reset();
+	}
+
+	void dungeon::store(level const& level)
+	{
+		auto os = std::ostringstream();
+		write_level(os, level);
+
+		auto s = stored_level();
+		s.m_data = bump::io::compress(os.str());
+		s.m_size = s.m_data.size();
+		s.m_store_order = ++m_store_counter;
+
+		m_stored_memory += s.m_size;
+		m_stored.insert_or_assign(level.m_depth, std::move(s));
+	}
+
+	level dungeon::restore(std::int32_t depth)
+	{
+		auto node = m_stored.extract(depth);
+		bump::die_if(node.empty());
+
+		auto& s = node.mapped();
+		auto data = std::string();
+
+		if (s.m_on_disk)
+		{
+			auto const path = get_swap_path(depth);
+			auto file = std::ifstream(path, std::ios::binary);
+
+			if (!file)
+			{
+				bump::log_error("dungeon::restore() failed: could not open level file: {}", path.string());
+				bump::die();
+			}
+
+			data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+			file.close();
+
+			auto ec = std::error_code();
+			std::filesystem::remove(path, ec);
+		}
+		else
+		{
+			m_stored_memory -= s.m_size;
+			data = std::move(s.m_data);
+		}
+
+		auto decompressed = bump::io::decompress(data);
+
+		if (!decompressed.has_value())
+		{
+			bump::log_error("dungeon::restore() failed: invalid compressed level data!");
+			bump::die();
+		}
+
+		auto is = std::istringstream(std::move(decompressed.value()));
+		auto l = read_level(is);
+
+		if (!l.has_value())
+		{
+			bump::log_error("dungeon::restore() failed: invalid level data!");
+			bump::die();
+		}
+
+		return std::move(l.value());
+	}
+
+	void dungeon::enforce_budget()
+	{
+		while (m_stored_memory > m_memory_budget)
+		{
+			// evict the level stored longest ago that's still in memory
+			auto oldest = m_stored.end();
+
+			for (auto i = m_stored.begin(); i != m_stored.end(); ++i)
+				if (!i->second.m_on_disk && (oldest == m_stored.end() || i->second.m_store_order < oldest->second.m_store_order))
+					oldest = i;
+
+			if (oldest == m_stored.end())
+				return;
+
+			auto& [depth, s] = *oldest;
+			auto const path = get_swap_path(depth);
+
+			auto ec = std::error_code();
+			std::filesystem::create_directories(m_swap_dir, ec);
+
+			auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+			file.write(s.m_data.data(), std::streamsize(s.m_data.size()));
+			file.close();
+
+			if (!file)
+			{
+				bump::log_error("dungeon::enforce_budget() failed: could not write level file: {}", path.string());
+				return; // keep it in memory
+			}
+
+			m_stored_memory -= s.m_size;
+			s.m_data = std::string();
+			s.m_on_disk = true;
+		}
+	}
+
+	std::filesystem::path dungeon::get_swap_path(std::int32_t depth) const
+	{
+		return m_swap_dir / ("dungeon_" + std::to_string(m_seed) + "_" + std::to_string(m_instance_id) + "_level_" + std::to_string(depth) + ".bin");
+	}
+
+} // rog
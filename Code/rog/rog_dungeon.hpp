@@ -0,0 +1,95 @@
+#pragma once
+
+#include "rog_level.hpp"
+#include "rog_level_pregen.hpp"
+
+#include <bump_math.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+
+namespace rog
+{
+
+	/* dungeon
+	 *
+	 * Keeps every level that the player has visited, so that going back to
+	 * a depth restores it as it was left, instead of generating it again.
+	 *
+	 * The current level is owned by the caller (see enter() and leave()).
+	 * Visited levels next to the current depth are kept live, so that the
+	 * stairs are instant (unvisited ones are pre-generated in the
+	 * background). Other visited levels are serialized and compressed.
+	 *
+	 * When the compressed levels held in memory exceed `memory_budget`
+	 * bytes, the ones stored longest ago are moved to files in `swap_dir`
+	 * (which are deleted again when the dungeon is destroyed). Only the
+	 * stored levels count towards the budget, not the live ones (which
+	 * can't be moved out).
+	 *
+	 */
+	class dungeon
+	{
+	public:
+
+		dungeon(std::uint64_t seed, glm::ivec2 level_size, std::size_t memory_budget, std::filesystem::path swap_dir);
+		~dungeon();
+
+		dungeon(dungeon const&) = delete;
+		dungeon& operator=(dungeon const&) = delete;
+		dungeon(dungeon&&) = delete;
+		dungeon& operator=(dungeon&&) = delete;
+
+		/* enter()
+		 *
+		 * Returns the level at `depth` (restored if it's been visited), and
+		 * makes it the current depth. The level should be given back with
+		 * leave() before entering another depth.
+		 *
+		 */
+		level enter(std::int32_t depth);
+		void leave(level&& level);
+
+		bool is_visited(std::int32_t depth) const { return m_visited.contains(depth); }
+
+		std::size_t memory_budget() const { return m_memory_budget; }
+		std::size_t stored_memory() const { return m_stored_memory; } // bytes of compressed levels in memory
+
+	private:
+
+		struct stored_level
+		{
+			std::string m_data; // compressed (empty if on disk)
+			std::size_t m_size = 0; // compressed size
+			bool m_on_disk = false;
+			std::uint64_t m_store_order = 0;
+		};
+
+		void store(level const& level);
+		level restore(std::int32_t depth);
+
+		void enforce_budget();
+		std::filesystem::path get_swap_path(std::int32_t depth) const;
+
+		std::uint64_t m_seed;
+		glm::ivec2 m_level_size;
+		std::size_t m_memory_budget;
+		std::filesystem::path m_swap_dir;
+		std::uint64_t m_instance_id; // (in the swap file names)
+
+		std::optional<std::int32_t> m_current_depth;
+		std::set<std::int32_t> m_visited;
+		std::map<std::int32_t, level> m_live;
+		std::map<std::int32_t, stored_level> m_stored;
+		std::size_t m_stored_memory;
+		std::uint64_t m_store_counter;
+
+		level_pregenerator m_pregen;
+	};
+
+} // rog
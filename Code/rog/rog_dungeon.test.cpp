@@ -0,0 +1,168 @@
+#include "rog_dungeon.hpp"
+
+#include "rog_level_gen.hpp"
+#include "rog_level_io.hpp"
+
+#include <bump_range.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		auto constexpr SEED = std::uint64_t{ 0x5eed };
+		auto constexpr LEVEL_SIZE = glm::ivec2{ 48, 32 };
+
+		// an empty directory for each test's swap files
+		std::filesystem::path make_swap_dir(std::string const& name)
+		{
+			auto const dir = std::filesystem::temp_directory_path() / "rog_test_dungeon" / name;
+
+			auto ec = std::error_code();
+			std::filesystem::remove_all(dir, ec);
+
+			return dir;
+		}
+
+		bool is_swapped_out(std::filesystem::path const& swap_dir, std::int32_t depth)
+		{
+			auto ec = std::error_code();
+			auto const suffix = "_level_" + std::to_string(depth) + ".bin";
+
+			for (auto const& entry : std::filesystem::directory_iterator(swap_dir, ec))
+				if (entry.path().filename().string().ends_with(suffix))
+					return true;
+
+			return false;
+		}
+
+		std::string to_bytes(level const& level)
+		{
+			auto os = std::ostringstream();
+			write_level(os, level);
+			return os.str();
+		}
+
+		// enters and leaves each depth from `from` to `to` in turn
+		void walk(dungeon& d, std::int32_t from, std::int32_t to)
+		{
+			auto const step = (to < from ? -1 : 1);
+
+			for (auto depth = from; depth != to + step; depth += step)
+				d.leave(d.enter(depth));
+		}
+
+	} // unnamed
+
+	TEST(Test_rog_dungeon, restores_levels_as_they_were_left)
+	{
+		auto const swap_dir = make_swap_dir("restore");
+		auto d = dungeon(SEED, LEVEL_SIZE, 1024 * 1024, swap_dir);
+
+		// change the first level, so it can't just have been generated again
+		auto first = d.enter(1);
+		first.set_feature({ 1, 1 }, feature{ { '#', colors::violet, colors::black }, feature::flags::NO_WALK });
+		first.set_feature({ 2, 1 }, features::floor);
+
+		auto const bytes = to_bytes(first);
+		d.leave(std::move(first));
+
+		// levels 1 and 2 are now compressed in memory
+		walk(d, 2, 4);
+
+		EXPECT_TRUE(d.is_visited(1));
+		EXPECT_GT(d.stored_memory(), 0);
+		EXPECT_LE(d.stored_memory(), d.memory_budget());
+		EXPECT_FALSE(is_swapped_out(swap_dir, 1));
+
+		walk(d, 3, 2);
+
+		auto restored = d.enter(1);
+		EXPECT_EQ(to_bytes(restored), bytes);
+		d.leave(std::move(restored));
+	}
+
+	TEST(Test_rog_dungeon, evicts_levels_to_swap_files)
+	{
+		auto const swap_dir = make_swap_dir("evict");
+
+		{
+			// (too small for any level)
+			auto d = dungeon(SEED, LEVEL_SIZE, 1, swap_dir);
+
+			auto first = d.enter(1);
+			first.set_feature({ 1, 1 }, features::floor);
+
+			auto const bytes = to_bytes(first);
+			d.leave(std::move(first));
+
+			walk(d, 2, 4);
+
+			EXPECT_EQ(d.stored_memory(), 0);
+			EXPECT_TRUE(is_swapped_out(swap_dir, 1));
+			EXPECT_TRUE(is_swapped_out(swap_dir, 2));
+
+			// reloading a level deletes its file
+			walk(d, 3, 2);
+			EXPECT_FALSE(is_swapped_out(swap_dir, 1));
+
+			auto restored = d.enter(1);
+			EXPECT_EQ(to_bytes(restored), bytes);
+			d.leave(std::move(restored));
+
+			walk(d, 2, 4);
+			EXPECT_TRUE(is_swapped_out(swap_dir, 1));
+		}
+
+		// and the dungeon deletes the rest
+		EXPECT_FALSE(is_swapped_out(swap_dir, 1));
+		EXPECT_FALSE(is_swapped_out(swap_dir, 2));
+	}
+
+	TEST(Test_rog_dungeon, evicts_least_recently_stored_first)
+	{
+		// find the compressed size of each level (levels 1, 2 and 3 are stored on entering 3, 4 and 5)
+		auto sizes = std::vector<std::size_t>();
+
+		{
+			auto d = dungeon(SEED, LEVEL_SIZE, 1024 * 1024, make_swap_dir("measure"));
+			walk(d, 1, 2);
+
+			for (auto depth : bump::range(3, 6))
+			{
+				auto const before = d.stored_memory();
+				d.leave(d.enter(depth));
+				sizes.push_back(d.stored_memory() - before);
+			}
+		}
+
+		// room for any one of them, but not two
+		auto const swap_dir = make_swap_dir("order");
+		auto d = dungeon(SEED, LEVEL_SIZE, *std::max_element(sizes.begin(), sizes.end()), swap_dir);
+
+		walk(d, 1, 3);
+		EXPECT_EQ(d.stored_memory(), sizes[0]);
+		EXPECT_FALSE(is_swapped_out(swap_dir, 1));
+
+		d.leave(d.enter(4));
+		EXPECT_EQ(d.stored_memory(), sizes[1]);
+		EXPECT_TRUE(is_swapped_out(swap_dir, 1));
+		EXPECT_FALSE(is_swapped_out(swap_dir, 2));
+
+		d.leave(d.enter(5));
+		EXPECT_EQ(d.stored_memory(), sizes[2]);
+		EXPECT_TRUE(is_swapped_out(swap_dir, 2));
+		EXPECT_FALSE(is_swapped_out(swap_dir, 3));
+	}
+
+} // rog
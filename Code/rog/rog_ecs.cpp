@@ -27,8 +27,7 @@ namespace rog
 
 	bool player_can_use_stairs(level& level, stairs_direction dir)
 	{
-		auto const& grid = level.m_grid;
-		auto const level_size = grid.extents();
+		auto const level_size = level.size();
 
 		auto const& pos = level.m_registry.get<c_position>(level.m_player);
 
@@ -37,7 +36,7 @@ namespace rog
 
 		if (dir == stairs_direction::UP)
 		{
-			if (!(grid.at(pos.m_pos).m_flags & feature::flags::STAIRS_UP))
+			if (!level.m_layers.m_stairs_up.test(pos.m_pos))
 			{
 				bump::log_info("There are no upward stairs here.");
 				return false;
@@ -47,7 +46,7 @@ namespace rog
 		}
 		else
 		{
-			if (!(grid.at(pos.m_pos).m_flags & feature::flags::STAIRS_DOWN))
+			if (!level.m_layers.m_stairs_down.test(pos.m_pos))
 			{
 				bump::log_info("There are no downward stairs here.");
 				return false;
@@ -69,13 +68,42 @@ namespace rog
 		return monster;
 	}
 	
-	void monster_move(level& level, entt::entity monster, c_position& pos, random::rng_t& rng)
+	monster_move_intent monster_choose_move(level const& level, glm::ivec2 pos, direction random_dir)
 	{
-		// todo: random direction function? (and ignore 5?)
-		auto const dir_idx = random::rand_range(rng, 0, 8);
-		auto const dir = static_cast<direction>(dir_idx);
+		auto const& to_player = level.m_distance_fields.m_to_player;
 
-		(void)level.move_actor(monster, pos, dir); // todo: try a different direction?
+		// only wander if there's no way to the player at all
+		if (!to_player.is_reachable(pos))
+			return { random_dir, false };
+
+		// next to the player (the tile at distance 0): wait there (todo: attack)
+		if (to_player.at(pos) <= 1)
+			return { direction::NONE, true };
+
+		// head towards the player (or wait, if other monsters are in the way)
+		auto const can_enter = [&] (glm::ivec2 p) { return !level.is_occupied(p); };
+		return { to_player.downhill(pos, can_enter), true };
+	}
+
+	void monster_apply_move(level& level, entt::entity monster, c_position& pos, monster_move_intent const& intent)
+	{
+		if (intent.m_dir != direction::NONE && level.move_actor(monster, pos, intent.m_dir))
+			return;
+
+		if (!intent.m_towards_player)
+			return; // todo: try a different direction?
+
+		auto const& to_player = level.m_distance_fields.m_to_player;
+
+		if (to_player.at(pos.m_pos) <= 1)
+			return;
+
+		// another monster got there first (or was in the way, and has since moved)
+		auto const can_enter = [&] (glm::ivec2 p) { return !level.is_occupied(p); };
+		auto const downhill_dir = to_player.downhill(pos.m_pos, can_enter);
+
+		if (downhill_dir != direction::NONE)
+			(void)level.move_actor(monster, pos, downhill_dir);
 	}
 
 } // rog
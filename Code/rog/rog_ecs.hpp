@@ -83,6 +83,29 @@ namespace rog
 	// MONSTER:
 
 	entt::entity monster_create_entity(entt::registry& registry);
-	void monster_move(level& level, entt::entity monster, c_position& pos, random::rng_t& rng);
+
+	struct monster_move_intent
+	{
+		direction m_dir = direction::NONE;
+		bool m_towards_player = false;
+	};
+
+	/* monster_choose_move(), monster_apply_move()
+	 *
+	 * Monsters move in two steps, so that many monsters can choose their
+	 * moves at once (see simulation::monster_turns()).
+	 *
+	 * monster_choose_move() heads towards the player, waiting when next to
+	 * the player or when other monsters are in the way. It only moves in
+	 * `random_dir` if the player can't be reached at all. It doesn't
+	 * change the level (note: level.m_distance_fields must be up to date).
+	 *
+	 * monster_apply_move() makes the move, if it's still possible. If a
+	 * move towards the player has since been blocked, the monster looks
+	 * for another way closer instead.
+	 *
+	 */
+	monster_move_intent monster_choose_move(level const& level, glm::ivec2 pos, direction random_dir);
+	void monster_apply_move(level& level, entt::entity monster, c_position& pos, monster_move_intent const& intent);
 
 } // rog
@@ -22,8 +22,12 @@ namespace rog
 		
 		screen_cell m_cell;
 		flags m_flags;
+
+		bool operator==(feature const&) const = default;
 	};
 
+	using feature_id = std::uint8_t; // an index into a feature_palette
+
 	namespace features
 	{
 		
@@ -36,4 +40,16 @@ namespace rog
 
 	} // features
 
+	namespace feature_ids
+	{
+
+		// the ids of the features above in the default palette
+		auto constexpr empty = feature_id{ 0 };
+		auto constexpr wall = feature_id{ 1 };
+		auto constexpr floor = feature_id{ 2 };
+		auto constexpr stairs_down = feature_id{ 3 };
+		auto constexpr stairs_up = feature_id{ 4 };
+
+	} // feature_ids
+
 } // rog
@@ -0,0 +1,44 @@
+#include "rog_feature_layers.hpp"
+
+#include <bump_die.hpp>
+#include <bump_range.hpp>
+
+namespace rog
+{
+
+	void feature_layers::build(terrain_grid const& terrain)
+	{
+		auto const extents = terrain.extents();
+
+		m_walkable.resize(extents, false);
+		m_no_fly.resize(extents, false);
+		m_stairs_down.resize(extents, false);
+		m_stairs_up.resize(extents, false);
+
+		terrain.for_each([&] (glm::ivec2 pos, feature const& f) { set(pos, f.m_flags); });
+	}
+
+	void feature_layers::set(glm::ivec2 pos, feature::flags flags)
+	{
+		bump::die_if(!m_walkable.in_bounds(pos));
+
+		m_walkable.set(pos, !(flags & feature::flags::NO_WALK));
+		m_no_fly.set(pos, flags & feature::flags::NO_FLY);
+		m_stairs_down.set(pos, flags & feature::flags::STAIRS_DOWN);
+		m_stairs_up.set(pos, flags & feature::flags::STAIRS_UP);
+	}
+
+	bit_grid const& feature_layers::get(feature::flags flag) const
+	{
+		switch (flag)
+		{
+		case feature::flags::NO_WALK:     return m_walkable;
+		case feature::flags::NO_FLY:      return m_no_fly;
+		case feature::flags::STAIRS_DOWN: return m_stairs_down;
+		case feature::flags::STAIRS_UP:   return m_stairs_up;
+		}
+
+		bump::die();
+	}
+
+} // rog
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "rog_bit_grid.hpp"
+#include "rog_feature.hpp"
+#include "rog_terrain_grid.hpp"
+
+#include <bump_math.hpp>
+
+namespace rog
+{
+
+	/* feature_layers
+	 *
+	 * Packed copies of the feature::flags in a terrain_grid, with one
+	 * bit per tile for each flag. Searches and floods only need one or two
+	 * bits per tile, so they don't need to read whole features.
+	 *
+	 * NO_WALK is stored inverted (as "walkable"), so that walkable areas can
+	 * be found by and-ing rows together.
+	 *
+	 */
+	struct feature_layers
+	{
+		void build(terrain_grid const& terrain);
+		void set(glm::ivec2 pos, feature::flags flags);
+
+		// the layer where the bits are set for tiles with `flag` (n.b. walkable for NO_WALK)
+		bit_grid const& get(feature::flags flag) const;
+
+		bit_grid m_walkable;
+		bit_grid m_no_fly;
+		bit_grid m_stairs_down;
+		bit_grid m_stairs_up;
+	};
+
+} // rog
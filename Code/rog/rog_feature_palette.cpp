@@ -0,0 +1,50 @@
+#include "rog_feature_palette.hpp"
+
+#include <bump_die.hpp>
+
+#include <algorithm>
+
+namespace rog
+{
+
+	feature_id feature_palette::add(feature const& f)
+	{
+		if (auto const id = find(f); id.has_value())
+			return id.value();
+
+		bump::die_if(m_features.size() == MAX_SIZE);
+
+		m_features.push_back(f);
+
+		return feature_id(m_features.size() - 1);
+	}
+
+	std::optional<feature_id> feature_palette::find(feature const& f) const
+	{
+		auto const i = std::find(m_features.begin(), m_features.end(), f);
+
+		if (i == m_features.end())
+			return { };
+
+		return feature_id(i - m_features.begin());
+	}
+
+	feature_palette const& get_default_palette()
+	{
+		static auto const palette = []
+		{
+			auto p = feature_palette();
+
+			bump::die_if(p.add(features::empty) != feature_ids::empty);
+			bump::die_if(p.add(features::wall) != feature_ids::wall);
+			bump::die_if(p.add(features::floor) != feature_ids::floor);
+			bump::die_if(p.add(features::stairs_down) != feature_ids::stairs_down);
+			bump::die_if(p.add(features::stairs_up) != feature_ids::stairs_up);
+
+			return p;
+		}();
+
+		return palette;
+	}
+
+} // rog
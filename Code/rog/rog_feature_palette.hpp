@@ -0,0 +1,45 @@
+#pragma once
+
+#include "rog_feature.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace rog
+{
+
+	/* feature_palette
+	 *
+	 * A table of distinct features, so that terrain can store a small
+	 * feature_id per tile instead of a whole feature.
+	 *
+	 */
+	class feature_palette
+	{
+	public:
+
+		// the largest id is reserved by terrain_grid for tiles with overrides
+		static constexpr std::size_t MAX_SIZE = std::numeric_limits<feature_id>::max();
+
+		// returns the id of an equal feature, adding it if it isn't already in the palette
+		feature_id add(feature const& f);
+		std::optional<feature_id> find(feature const& f) const;
+
+		feature const& get(feature_id id) const { return m_features[id]; }
+		std::size_t size() const { return m_features.size(); }
+
+	private:
+
+		std::vector<feature> m_features;
+	};
+
+	/* get_default_palette()
+	 *
+	 * The features defined in rog_feature.hpp, with the ids in feature_ids.
+	 *
+	 */
+	feature_palette const& get_default_palette();
+
+} // rog
@@ -0,0 +1,147 @@
+#include "rog_fov.hpp"
+
+#include <bump_die.hpp>
+#include <bump_range.hpp>
+
+#include <array>
+
+namespace rog
+{
+
+	void field_of_view::compute(bit_grid const& transparent, glm::ivec2 origin, std::int32_t radius)
+	{
+		bump::die_if(radius < 0);
+		bump::die_if(!transparent.in_bounds(origin));
+
+		auto const window_size = glm::ivec2(2 * radius + 1);
+
+		if (m_visible.extents() != window_size)
+			m_visible.resize(window_size, false);
+		else
+			m_visible.fill(false);
+
+		m_origin = origin;
+		m_radius = radius;
+
+		m_visible.set(glm::ivec2(radius), true);
+
+		// the x and y axes of each octant (in level coordinates)
+		auto constexpr octants = std::array<std::array<glm::ivec2, 2>, 8>
+		{{
+			{ glm::ivec2{  1,  0 }, glm::ivec2{  0,  1 } },
+			{ glm::ivec2{  0,  1 }, glm::ivec2{  1,  0 } },
+			{ glm::ivec2{  0,  1 }, glm::ivec2{ -1,  0 } },
+			{ glm::ivec2{ -1,  0 }, glm::ivec2{  0,  1 } },
+			{ glm::ivec2{ -1,  0 }, glm::ivec2{  0, -1 } },
+			{ glm::ivec2{  0, -1 }, glm::ivec2{ -1,  0 } },
+			{ glm::ivec2{  0, -1 }, glm::ivec2{  1,  0 } },
+			{ glm::ivec2{  1,  0 }, glm::ivec2{  0, -1 } },
+		}};
+
+		for (auto const& [x_axis, y_axis] : octants)
+			cast_light(transparent, 1, 1.f, 0.f, x_axis, y_axis);
+	}
+
+	bool field_of_view::is_visible(glm::ivec2 pos) const
+	{
+		auto const local = pos - (m_origin - m_radius);
+		return m_visible.in_bounds(local) && m_visible.test(local);
+	}
+
+	/* cast_light()
+	 *
+	 * Recursive shadowcasting (Bergstrom, 2001) for one octant.
+	 *
+	 * Scans the rows of the octant outwards from `row`, lighting the tiles
+	 * between `start_slope` and `end_slope`. When a run of opaque tiles is
+	 * found, the part of the next row that can be seen past its start is
+	 * scanned recursively, and this scan continues from its end.
+	 *
+	 */
+	void field_of_view::cast_light(bit_grid const& transparent, std::int32_t row, float start_slope, float end_slope, glm::ivec2 x_axis, glm::ivec2 y_axis)
+	{
+		if (start_slope < end_slope)
+			return;
+
+		auto const radius_squared = m_radius * m_radius;
+		auto next_start_slope = start_slope;
+
+		for (auto i : bump::range(row, m_radius + 1))
+		{
+			auto blocked = false;
+			auto const dy = -i;
+
+			for (auto dx : bump::range(-i, 1))
+			{
+				auto const left_slope = (dx - 0.5f) / (dy + 0.5f);
+				auto const right_slope = (dx + 0.5f) / (dy - 0.5f);
+
+				if (start_slope < right_slope)
+					continue;
+
+				if (end_slope > left_slope)
+					break;
+
+				auto const pos = m_origin + dx * x_axis + dy * y_axis;
+				auto const in_level = transparent.in_bounds(pos);
+				auto const opaque = !in_level || !transparent.test(pos);
+
+				if (in_level && dx * dx + dy * dy <= radius_squared)
+					m_visible.set(pos - (m_origin - m_radius), true);
+
+				if (blocked)
+				{
+					if (opaque)
+					{
+						next_start_slope = right_slope;
+						continue;
+					}
+
+					blocked = false;
+					start_slope = next_start_slope;
+				}
+				else if (opaque && i < m_radius)
+				{
+					blocked = true;
+					cast_light(transparent, i + 1, start_slope, left_slope, x_axis, y_axis);
+					next_start_slope = right_slope;
+				}
+			}
+
+			if (blocked)
+				break;
+		}
+	}
+
+	field_of_view const& fov_cache::update(entt::entity viewer, bit_grid const& transparent, std::uint32_t terrain_generation, glm::ivec2 pos, std::int32_t radius)
+	{
+		auto i = m_entries.find(viewer);
+
+		if (i == m_entries.end())
+			i = m_entries.try_emplace(viewer).first;
+
+		auto& e = i->second;
+
+		auto const stale =
+			!e.m_valid ||
+			e.m_terrain_generation != terrain_generation ||
+			e.m_fov.origin() != pos ||
+			e.m_fov.radius() != radius;
+
+		if (stale)
+		{
+			e.m_fov.compute(transparent, pos, radius);
+			e.m_terrain_generation = terrain_generation;
+			e.m_valid = true;
+		}
+
+		return e.m_fov;
+	}
+
+	field_of_view const* fov_cache::find(entt::entity viewer) const
+	{
+		auto const i = m_entries.find(viewer);
+		return (i == m_entries.end() ? nullptr : &i->second.m_fov);
+	}
+
+} // rog
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "rog_bit_grid.hpp"
+
+#include <bump_aabb.hpp>
+#include <bump_math.hpp>
+
+#include <entt.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace rog
+{
+
+	/* field_of_view
+	 *
+	 * The tiles visible from `origin` within `radius`, found by recursive
+	 * shadowcasting over the set tiles of `transparent`.
+	 *
+	 * Visibility is stored in a bit_grid covering only the square around
+	 * the origin, so each viewer needs (2 * radius + 1)^2 bits, no matter
+	 * how large the level is. The same storage is reused for each compute.
+	 *
+	 */
+	class field_of_view
+	{
+	public:
+
+		void compute(bit_grid const& transparent, glm::ivec2 origin, std::int32_t radius);
+
+		glm::ivec2 origin() const { return m_origin; }
+		std::int32_t radius() const { return m_radius; }
+
+		bool is_visible(glm::ivec2 pos) const;
+
+		// the (level) area containing all the visible tiles
+		bump::iaabb2 bounds() const { return { m_origin - m_radius, glm::ivec2(2 * m_radius + 1) }; }
+
+	private:
+
+		void cast_light(bit_grid const& transparent, std::int32_t row, float start_slope, float end_slope, glm::ivec2 x_axis, glm::ivec2 y_axis);
+
+		glm::ivec2 m_origin = glm::ivec2(0);
+		std::int32_t m_radius = 0;
+		bit_grid m_visible;
+	};
+
+	/* fov_cache
+	 *
+	 * The last field of view computed for each viewer. It's only computed
+	 * again if the viewer has moved, or the terrain has changed (i.e. the
+	 * level's terrain generation has changed since).
+	 *
+	 * update() can be called for different viewers on several threads at
+	 * once, as long as each of them has been added (with add_viewer())
+	 * first, so that the cache itself isn't changed.
+	 *
+	 */
+	class fov_cache
+	{
+	public:
+
+		field_of_view const& update(entt::entity viewer, bit_grid const& transparent, std::uint32_t terrain_generation, glm::ivec2 pos, std::int32_t radius);
+		field_of_view const* find(entt::entity viewer) const;
+
+		void add_viewer(entt::entity viewer) { (void)m_entries.try_emplace(viewer); }
+
+		void erase(entt::entity viewer) { m_entries.erase(viewer); }
+		void clear() { m_entries.clear(); }
+
+	private:
+
+		struct entry
+		{
+			field_of_view m_fov;
+			std::uint32_t m_terrain_generation = 0;
+			bool m_valid = false;
+		};
+
+		std::unordered_map<entt::entity, entry> m_entries;
+	};
+
+} // rog
@@ -0,0 +1,145 @@
+#include "rog_fov.hpp"
+
+#include "rog_feature.hpp"
+#include "rog_level.hpp"
+#include "rog_level_gen.hpp"
+
+#include <bump_range.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		// a room of `size` with walls around the edge
+		bit_grid make_room(glm::ivec2 size)
+		{
+			auto transparent = bit_grid(size, false);
+
+			for (auto y : bump::range(1, size.y - 1))
+				for (auto x : bump::range(1, size.x - 1))
+					transparent.set({ x, y }, true);
+
+			return transparent;
+		}
+
+		std::int32_t distance_squared(glm::ivec2 a, glm::ivec2 b)
+		{
+			auto const d = a - b;
+			return d.x * d.x + d.y * d.y;
+		}
+
+	} // unnamed
+
+	TEST(Test_rog_fov, radius)
+	{
+		auto const transparent = make_room({ 41, 41 });
+		auto const origin = glm::ivec2{ 20, 20 };
+
+		auto fov = field_of_view();
+
+		for (auto radius : { 0, 1, 5, 12 })
+		{
+			fov.compute(transparent, origin, radius);
+
+			for (auto y : bump::range(0, 41))
+				for (auto x : bump::range(0, 41))
+					EXPECT_EQ(fov.is_visible({ x, y }), distance_squared({ x, y }, origin) <= radius * radius) << "radius " << radius << ", tile " << x << ", " << y;
+		}
+	}
+
+	TEST(Test_rog_fov, walls_hide_tiles_behind_them)
+	{
+		auto transparent = make_room({ 21, 21 });
+		transparent.set({ 13, 10 }, false); // a pillar
+		transparent.set({ 10, 13 }, false);
+
+		auto fov = field_of_view();
+		fov.compute(transparent, { 10, 10 }, 9);
+
+		// the pillars are visible, but the tiles behind them aren't
+		EXPECT_TRUE(fov.is_visible({ 13, 10 }));
+		EXPECT_FALSE(fov.is_visible({ 14, 10 }));
+		EXPECT_FALSE(fov.is_visible({ 17, 10 }));
+
+		EXPECT_TRUE(fov.is_visible({ 10, 13 }));
+		EXPECT_FALSE(fov.is_visible({ 10, 14 }));
+		EXPECT_FALSE(fov.is_visible({ 10, 17 }));
+
+		// a wall right across the room is visible, and nothing beyond it
+		auto wall_room = make_room({ 21, 21 });
+
+		for (auto y : bump::range(0, 21))
+			wall_room.set({ 5, y }, false);
+
+		fov.compute(wall_room, { 10, 10 }, 9);
+		EXPECT_TRUE(fov.is_visible({ 5, 10 }));
+
+		for (auto y : bump::range(0, 21))
+			for (auto x : bump::range(0, 5))
+				EXPECT_FALSE(fov.is_visible({ x, y })) << "tile " << x << ", " << y;
+	}
+
+	TEST(Test_rog_fov, symmetric_in_open_room)
+	{
+		auto const size = glm::ivec2{ 15, 11 };
+		auto const transparent = make_room(size);
+		auto const radius = 8;
+
+		auto a_fov = field_of_view();
+		auto b_fov = field_of_view();
+
+		for (auto ay : bump::range(1, size.y - 1))
+		{
+			for (auto ax : bump::range(1, size.x - 1))
+			{
+				auto const a = glm::ivec2{ ax, ay };
+				a_fov.compute(transparent, a, radius);
+
+				for (auto by : bump::range(1, size.y - 1))
+				{
+					for (auto bx : bump::range(1, size.x - 1))
+					{
+						auto const b = glm::ivec2{ bx, by };
+						b_fov.compute(transparent, b, radius);
+
+						EXPECT_EQ(a_fov.is_visible(b), b_fov.is_visible(a)) << ax << ", " << ay << " and " << bx << ", " << by;
+					}
+				}
+			}
+		}
+	}
+
+	TEST(Test_rog_fov, cache_recomputes_when_terrain_changes)
+	{
+		auto const size = glm::ivec2{ 16, 12 };
+
+		auto level = level_gen::generate_level(0x5eed, 1, size);
+		level.set_terrain(terrain_grid(size, feature_ids::floor));
+
+		auto const viewer = level.m_player;
+		auto const pos = glm::ivec2{ 2, 5 };
+		auto const generation = level.m_terrain_generation;
+
+		EXPECT_TRUE(level.update_fov(viewer, pos, 10).is_visible({ 8, 5 }));
+
+		// changing the layers without the terrain generation doesn't recompute it
+		level.m_layers.m_walkable.set({ 4, 5 }, false);
+		EXPECT_TRUE(level.update_fov(viewer, pos, 10).is_visible({ 8, 5 }));
+		EXPECT_EQ(level.m_terrain_generation, generation);
+
+		// changing the terrain does
+		level.set_feature({ 4, 6 }, features::wall);
+		EXPECT_NE(level.m_terrain_generation, generation);
+
+		auto const& fov = level.update_fov(viewer, pos, 10);
+		EXPECT_TRUE(fov.is_visible({ 4, 5 }));
+		EXPECT_FALSE(fov.is_visible({ 8, 5 }));
+	}
+
+} // rog
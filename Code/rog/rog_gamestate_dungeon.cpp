@@ -1,17 +1,24 @@
 #include "rog_gamestates.hpp"
 
 #include "rog_ecs.hpp"
+#include "rog_journal.hpp"
 #include "rog_level.hpp"
 #include "rog_level_gen.hpp"
 #include "rog_player_action.hpp"
 #include "rog_random.hpp"
 #include "rog_screen.hpp"
+#include "rog_simulation.hpp"
 
 #include <bump_app.hpp>
 #include <bump_input.hpp>
 #include <bump_log.hpp>
 #include <bump_math.hpp>
+#include <bump_metrics.hpp>
 #include <bump_timer.hpp>
+#include <bump_trace.hpp>
+
+#include <filesystem>
+#include <string>
 
 namespace rog
 {
@@ -19,272 +26,280 @@ namespace rog
 	auto constexpr TIME_PER_CYCLE = bump::high_res_duration_from_seconds(0.05f);
 	auto constexpr TIME_PER_TURN = TIME_PER_CYCLE * 10;
 
-	bump::gamestate gamestate_dungeon(bump::app& app, std::int32_t level_depth)
-	{
-		bump::log_info("main loop - start");
+	auto constexpr DUNGEON_MEMORY_BUDGET = std::size_t{ 16 * 1024 * 1024 }; // for compressed levels (beyond that, they're written to disk)
 
-		// setup
-		auto rng = random::seed_rng();
-
-		auto const tile_size_px = glm::ivec2{ 24, 36 };
+	namespace
+	{
 
-		// todo: screen needs to be "map_panel" or something (i.e. origin_px, size_px)
-		// todo: set map panel px size to min of window / map size (for now) and center it (for now)
-		// todo: convert mouse coords from window px to map panel px, then onwards...
+		// the journal of the last session is kept, so it can be replayed
+		std::filesystem::path get_journal_path()
+		{
+			return std::filesystem::temp_directory_path() / "rog" / "last_session.rogj";
+		}
 
-		auto screen = rog::screen(
-			app.m_assets.m_shaders.at("tile"),
-			app.m_assets.m_textures_2d_array.at("ascii_tiles"),
-			app.m_assets.m_shaders.at("tile_border"),
-			app.m_window.get_size(),
-			tile_size_px);
+		std::filesystem::path get_trace_path()
+		{
+			return std::filesystem::temp_directory_path() / "rog" / "trace.json";
+		}
 
-		auto app_events   = std::queue<bump::input::app_event>();
-		auto input_events = std::queue<bump::input::input_event>();
+		// F12 starts a trace capture, and stops and saves it the next time
+		void toggle_trace_capture()
+		{
+			if (!bump::trace::is_capturing())
+			{
+				bump::trace::start();
+				bump::log_info("trace capture started");
+				return;
+			}
 
-		// main loop
-		auto app_paused = false;
-		auto player_paused = false;
-		
-		auto level = level_gen::generate_level(level_depth, rng);
+			bump::trace::stop();
 
-		auto queued_action = std::optional<player_action>();
+			auto const path = get_trace_path();
 
-		auto timer = bump::frame_timer(bump::duration_t{ 0 });
-		auto time_accumulator = bump::duration_t{ 0 };
+			if (bump::trace::save_json(path))
+				bump::log_info("trace capture saved: {}", path.string());
+		}
 
-		while (true)
+		bump::gamestate run_dungeon(bump::app& app, std::uint64_t seed, std::int32_t level_depth, glm::ivec2 level_size, journal const* replay, std::uint64_t replay_to_cycle)
 		{
-			// input
-			{
-				app.m_input_handler.poll(app_events, input_events);
+			bump::log_info("main loop - start");
 
-				// process app events:
-				while (!app_events.empty())
-				{
-					auto event = std::move(app_events.front());
-					app_events.pop();
+			// setup
+			auto const tile_size_px = glm::ivec2{ 24, 36 };
 
-					namespace ae = bump::input::app_events;
+			// todo: screen needs to be "map_panel" or something (i.e. origin_px, size_px)
+			// todo: set map panel px size to min of window / map size (for now) and center it (for now)
+			// todo: convert mouse coords from window px to map panel px, then onwards...
 
-					if (std::holds_alternative<ae::quit>(event))
-						return { }; // todo: save!
+			auto screen = rog::screen(
+				app.m_assets.m_shaders.at("tile"),
+				app.m_assets.m_textures_2d_array.at("ascii_tiles"),
+				app.m_assets.m_shaders.at("tile_border"),
+				app.m_window.get_size(),
+				tile_size_px);
 
-					if (std::holds_alternative<ae::pause>(event))
-					{
-						auto const& p = std::get<ae::pause>(event);
-						app_paused = p.m_pause; // todo: mute audio, etc.
-						continue;
-					}
+			screen.buffer().fill(screen_cell_blank);
 
-					if (std::holds_alternative<ae::resize>(event))
-					{
-						auto const& r = std::get<ae::resize>(event);
-						auto const& window_size = r.m_size;
-						screen.resize(window_size, screen.tile_size());
-						continue;
-					}
-				}
+			auto app_events   = std::queue<bump::input::app_event>();
+			auto input_events = std::queue<bump::input::input_event>();
 
-				// process input events:
-				while (!input_events.empty())
-				{
-					auto event = std::move(input_events.front());
-					input_events.pop();
+			// main loop
+			auto app_paused = false;
+			auto player_paused = false;
+			
+			// visited levels are kept, and the levels next to the current one are ready in advance, so using the stairs is instant
+			auto sim = simulation(seed, level_depth, level_size, DUNGEON_MEMORY_BUDGET, std::filesystem::temp_directory_path() / "rog");
 
-					namespace ie = bump::input::input_events;
+			if (replay)
+			{
+				bump::log_info("replaying to cycle {}...", replay_to_cycle);
+				replay_journal(sim, *replay, replay_to_cycle);
+			}
 
-					if (std::holds_alternative<ie::keyboard_key>(event))
-					{
-						auto const& k = std::get<ie::keyboard_key>(event);
+			auto const end_session = [&] ()
+			{
+				auto const path = get_journal_path();
 
-						using kt = bump::input::keyboard_key;
+				if (save_journal(path, sim.get_journal()))
+					bump::log_info("session journal saved: {}", path.string());
+			};
 
-						// app inputs
-						if (k.m_key == kt::ESCAPE && k.m_value)
-							return { }; // todo: save!
-						
-						if (k.m_key == kt::SPACE && k.m_value)
-							player_paused = !player_paused;
-
-						// action inputs
-						else if (k.m_key == kt::NUM7 && k.m_value) queued_action = player_actions::move{ direction::UP_LEFT };
-						else if (k.m_key == kt::NUM8 && k.m_value) queued_action = player_actions::move{ direction::UP };
-						else if (k.m_key == kt::NUM9 && k.m_value) queued_action = player_actions::move{ direction::UP_RIGHT };
-						else if (k.m_key == kt::NUM4 && k.m_value) queued_action = player_actions::move{ direction::LEFT };
-						else if (k.m_key == kt::NUM6 && k.m_value) queued_action = player_actions::move{ direction::RIGHT };
-						else if (k.m_key == kt::NUM1 && k.m_value) queued_action = player_actions::move{ direction::DOWN_LEFT };
-						else if (k.m_key == kt::NUM2 && k.m_value) queued_action = player_actions::move{ direction::DOWN };
-						else if (k.m_key == kt::NUM3 && k.m_value) queued_action = player_actions::move{ direction::DOWN_RIGHT };
-						else if (k.m_key == kt::DOT && k.m_value && k.m_mods.shift())   queued_action = player_actions::use_stairs{ stairs_direction::DOWN };
-						else if (k.m_key == kt::COMMA && k.m_value && k.m_mods.shift()) queued_action = player_actions::use_stairs{ stairs_direction::UP };
-
-						if (queued_action.has_value())
-							level.m_queued_path.clear();
-
-						continue;
-					}
+			auto timer = bump::frame_timer(bump::duration_t{ 0 });
+			auto& frame_times = bump::metrics::get_histogram("frame_time", "us");
+			auto time_accumulator = bump::duration_t{ 0 };
 
-					if (std::holds_alternative<ie::mouse_motion>(event))
-					{
-						// auto const& m = std::get<ie::mouse_motion>(event);
+			while (true)
+			{
+				// input
+				{
+					auto const zone = bump::trace::zone("input");
 
-						// auto const map_panel_lv = level.get_map_panel(ui_main.m_map_sb.m_size);
-						// auto const mouse_pos_pn = screen.sb_to_pn(screen.px_to_sb(m.m_position), ui_main.m_map_sb.m_origin);
-						// auto const mouse_pos_lv = panel_cell_to_map_coords(mouse_pos_pn, map_panel_lv.m_origin);
+					app.m_input_handler.poll(app_events, input_events);
 
-						// level.m_hovered_tile = level.in_bounds(mouse_pos_lv) ? std::optional<glm::ivec2>(mouse_pos_lv) : std::optional<glm::ivec2>();
+					// process app events:
+					while (!app_events.empty())
+					{
+						auto event = std::move(app_events.front());
+						app_events.pop();
 
-						continue;
-					}
+						namespace ae = bump::input::app_events;
 
-					if (std::holds_alternative<ie::mouse_button>(event))
-					{
-						auto const& m = std::get<ie::mouse_button>(event);
+						if (std::holds_alternative<ae::quit>(event))
+						{
+							end_session();
+							return { }; // todo: save!
+						}
 
-						using bt = bump::input::mouse_button;
+						if (std::holds_alternative<ae::pause>(event))
+						{
+							auto const& p = std::get<ae::pause>(event);
+							app_paused = p.m_pause; // todo: mute audio, etc.
+							continue;
+						}
 
-						if (m.m_button != bt::LEFT)
+						if (std::holds_alternative<ae::resize>(event))
+						{
+							auto const& r = std::get<ae::resize>(event);
+							auto const& window_size = r.m_size;
+							screen.resize(window_size, screen.tile_size());
+							screen.buffer().fill(screen_cell_blank);
 							continue;
-						
-						// auto const map_panel_lv = level.get_map_panel(ui_main.m_map_sb.m_size);
-						// auto const mouse_pos_pn = screen.sb_to_pn(screen.px_to_sb(m.m_position), ui_main.m_map_sb.m_origin);
-						// auto const mouse_pos_lv = panel_cell_to_map_coords(mouse_pos_pn, map_panel_lv.m_origin);
-
-						// if (level.in_bounds(mouse_pos_lv))
-						// {
-						// 	auto const& player_pos_lv = level.m_registry.get<c_position>(level.m_player).m_pos;
-						// 	level.m_queued_path = find_path(level.m_grid, player_pos_lv, mouse_pos_lv);
-						// 	queued_action.reset();
-						// }
-
-						continue;
+						}
 					}
-				}
-			}
 
-			// update
-			{
-				if (app_paused || player_paused)
-					time_accumulator = bump::duration_t{ 0 };
-				else
-					time_accumulator += timer.get_last_frame_time();
-
-				// do cycle
-				if (time_accumulator >= TIME_PER_CYCLE)
-				{
-					time_accumulator -= TIME_PER_CYCLE;
-
-					bump::log_info("cycle");
-
-					// add actor cycle energy
+					// process input events:
+					while (!input_events.empty())
 					{
-						auto view = level.m_registry.view<c_actor>();
+						auto event = std::move(input_events.front());
+						input_events.pop();
 
-						for (auto a : view)
-							view.get<c_actor>(a).add_energy();
-					}
+						namespace ie = bump::input::input_events;
 
-					// player turn
-					if (level.m_registry.get<c_actor>(level.m_player).has_turn_energy())
-					{
-						bump::log_info("player turn!");
-
-						// do player action!
-						if (queued_action.has_value())
+						if (std::holds_alternative<ie::keyboard_key>(event))
 						{
-							auto action = std::move(queued_action.value());
-							queued_action.reset();
+							auto const& k = std::get<ie::keyboard_key>(event);
 
-							namespace pa = player_actions;
+							using kt = bump::input::keyboard_key;
 
-							if (std::holds_alternative<pa::move>(action))
-							{
-								auto const& move = std::get<pa::move>(action);
+							auto queued_action = std::optional<player_action>();
 
-								auto& pos = level.m_registry.get<c_position>(level.m_player);
-								if (!level.move_actor(level.m_player, pos, move.m_dir))
-								{
-									bump::log_info("There is something in the way.");
-								}
-							}
-							else if (std::holds_alternative<pa::use_stairs>(action))
+							// app inputs
+							if (k.m_key == kt::ESCAPE && k.m_value)
 							{
-								auto const& use_stairs = std::get<pa::use_stairs>(action);
-
-								if (player_can_use_stairs(level, use_stairs.m_dir))
-								{
-									auto const delta_depth = (use_stairs.m_dir == stairs_direction::UP ? +1 : -1);
-									auto const next_depth = level_depth + delta_depth;
-									return { [&, next_depth] (bump::app& app) { return gamestate_dungeon(app, next_depth); } };
-								}
+								end_session();
+								return { }; // todo: save!
 							}
+							
+							if (k.m_key == kt::F12 && k.m_value)
+								toggle_trace_capture();
+
+							if (k.m_key == kt::SPACE && k.m_value)
+								player_paused = !player_paused;
+
+							// action inputs
+							else if (k.m_key == kt::NUM7 && k.m_value) queued_action = player_actions::move{ direction::UP_LEFT };
+							else if (k.m_key == kt::NUM8 && k.m_value) queued_action = player_actions::move{ direction::UP };
+							else if (k.m_key == kt::NUM9 && k.m_value) queued_action = player_actions::move{ direction::UP_RIGHT };
+							else if (k.m_key == kt::NUM4 && k.m_value) queued_action = player_actions::move{ direction::LEFT };
+							else if (k.m_key == kt::NUM6 && k.m_value) queued_action = player_actions::move{ direction::RIGHT };
+							else if (k.m_key == kt::NUM1 && k.m_value) queued_action = player_actions::move{ direction::DOWN_LEFT };
+							else if (k.m_key == kt::NUM2 && k.m_value) queued_action = player_actions::move{ direction::DOWN };
+							else if (k.m_key == kt::NUM3 && k.m_value) queued_action = player_actions::move{ direction::DOWN_RIGHT };
+							else if (k.m_key == kt::DOT && k.m_value && k.m_mods.shift())   queued_action = player_actions::use_stairs{ stairs_direction::DOWN };
+							else if (k.m_key == kt::COMMA && k.m_value && k.m_mods.shift()) queued_action = player_actions::use_stairs{ stairs_direction::UP };
+
+							if (queued_action.has_value())
+								sim.queue_action(std::move(queued_action.value()));
+
+							continue;
 						}
-						else if (!level.m_queued_path.empty())
-						{
-							auto& pos = level.m_registry.get<c_position>(level.m_player);
 
-							auto target = level.m_queued_path.back();
-							level.m_queued_path.pop_back();
+						if (std::holds_alternative<ie::mouse_motion>(event))
+						{
+							// auto const& m = std::get<ie::mouse_motion>(event);
 
-							if (!level.move_actor(level.m_player, pos, target))
-							{
-								bump::log_info("There is something in the way.");
-								level.m_queued_path.clear();
-							}
-						}
+							// auto const map_panel_lv = level.get_map_panel(ui_main.m_map_sb.m_size);
+							// auto const mouse_pos_pn = screen.sb_to_pn(screen.px_to_sb(m.m_position), ui_main.m_map_sb.m_origin);
+							// auto const mouse_pos_lv = panel_cell_to_map_coords(mouse_pos_pn, map_panel_lv.m_origin);
 
-						level.m_registry.get<c_actor>(level.m_player).take_turn_energy();
-					}
+							// level.m_hovered_tile = level.in_bounds(mouse_pos_lv) ? std::optional<glm::ivec2>(mouse_pos_lv) : std::optional<glm::ivec2>();
 
-					// monster turn
-					{
-						auto view = level.m_registry.view<c_actor, c_monster_tag, c_position>();
+							continue;
+						}
 
-						for (auto m : view)
+						if (std::holds_alternative<ie::mouse_button>(event))
 						{
-							auto [p, a] = view.get<c_position, c_actor>(m);
+							auto const& m = std::get<ie::mouse_button>(event);
 
-							if (!a.has_turn_energy())
+							using bt = bump::input::mouse_button;
+
+							if (m.m_button != bt::LEFT)
 								continue;
 							
-							bump::log_info("monster turn!");
-							
-							monster_move(level, m, p, rng);
+							// auto const map_panel_lv = level.get_map_panel(ui_main.m_map_sb.m_size);
+							// auto const mouse_pos_pn = screen.sb_to_pn(screen.px_to_sb(m.m_position), ui_main.m_map_sb.m_origin);
+							// auto const mouse_pos_lv = panel_cell_to_map_coords(mouse_pos_pn, map_panel_lv.m_origin);
 
-							a.take_turn_energy();
+							// if (level.in_bounds(mouse_pos_lv))
+							// {
+							// 	sim.queue_action(player_actions::travel{ mouse_pos_lv });
+							// }
+
+							continue;
 						}
 					}
 				}
-			}
-			
-			// drawing
-			{
-				screen.buffer().fill(screen_cell_blank);
 
-				// todo: draw ui
+				// update
+				{
+					auto const zone = bump::trace::zone("update");
 
-				//draw_level(screen.buffer(), level, ui_main.m_map_sb);
-			}
+					if (app_paused || player_paused)
+						time_accumulator = bump::duration_t{ 0 };
+					else
+						time_accumulator += timer.get_last_frame_time();
 
-			// render
-			{
-				auto& window = app.m_window;
-				auto& renderer = app.m_renderer;
+					// do cycle
+					if (time_accumulator >= TIME_PER_CYCLE)
+					{
+						time_accumulator -= TIME_PER_CYCLE;
 
-				renderer.clear_color_buffers({ 0.f, 0.f, 0.f, 1.f });
-				renderer.clear_depth_buffers();
-				renderer.set_viewport({ 0, 0 }, glm::uvec2(window.get_size()));
+						// start the new level on the next frame
+						if (sim.cycle().m_level_changed)
+						{
+							timer.tick();
+							continue;
+						}
+					}
+				}
+				
+				// drawing
+				{
+					auto const zone = bump::trace::zone("drawing");
 
-				screen.render(renderer);
+					// (the buffer isn't cleared each frame, as that would mark every drawn cell dirty; composite() blanks the cells nothing draws)
 
-				window.swap_buffers();
-			}
+					// todo: draw ui
+
+					auto& level = sim.level();
+					(void)level.update_fov(level.m_player, PLAYER_SIGHT_RADIUS);
+					//draw_level(screen.buffer(), level, ui_main.m_map_sb);
+				}
+
+				// render
+				{
+					auto const zone = bump::trace::zone("render");
+
+					auto& window = app.m_window;
+					auto& renderer = app.m_renderer;
+
+					renderer.clear_color_buffers({ 0.f, 0.f, 0.f, 1.f });
+					renderer.clear_depth_buffers();
+					renderer.set_viewport({ 0, 0 }, glm::uvec2(window.get_size()));
 
-			timer.tick();
+					screen.render(renderer);
+
+					window.swap_buffers();
+				}
+
+				timer.tick();
+				frame_times.record(timer.get_last_frame_time());
+			}
+		
+			bump::log_info("main loop - exit");
 		}
-	
-		bump::log_info("main loop - exit");
+
+	} // unnamed
+
+	bump::gamestate gamestate_dungeon(bump::app& app, std::int32_t level_depth)
+	{
+		auto rng = random::seed_rng();
+		return run_dungeon(app, rng(), level_depth, level_gen::DEFAULT_LEVEL_SIZE, nullptr, 0);
+	}
+
+	bump::gamestate gamestate_dungeon_replay(bump::app& app, journal const& journal, std::uint64_t to_cycle)
+	{
+		return run_dungeon(app, journal.m_seed, journal.m_depth, journal.m_level_size, &journal, to_cycle);
 	}
 
 } // rog
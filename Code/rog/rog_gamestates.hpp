@@ -1,5 +1,7 @@
 #pragma once
 
+#include "rog_journal.hpp"
+
 #include <bump_gamestate.hpp>
 
 #include <cstdint>
@@ -9,4 +11,7 @@ namespace rog
 
 	bump::gamestate gamestate_dungeon(bump::app& app, std::int32_t level_depth);
 
+	// plays `journal` back to `to_cycle` (as fast as possible), then carries on playing from there
+	bump::gamestate gamestate_dungeon_replay(bump::app& app, journal const& journal, std::uint64_t to_cycle);
+
 } // rog
@@ -0,0 +1,203 @@
+#include "rog_journal.hpp"
+
+#include "rog_level_gen.hpp"
+#include "rog_simulation.hpp"
+
+#include <bump_die.hpp>
+#include <bump_log.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <variant>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		auto constexpr JOURNAL_MAGIC = std::uint32_t{ 0x524F474A }; // "ROGJ"
+		auto constexpr JOURNAL_VERSION = std::uint32_t{ 1 };
+
+		enum class action_type : std::uint8_t
+		{
+			MOVE,
+			USE_STAIRS,
+			TRAVEL,
+		};
+
+		std::optional<journal> read_error(std::istream& is, std::string const& message)
+		{
+			bump::log_error("read_journal() failed: " + message);
+			is.setstate(std::ios::failbit);
+			return { };
+		}
+
+	} // unnamed
+
+	void write_journal(std::ostream& os, journal const& journal)
+	{
+		bump::io::set_endian(os, std::endian::little);
+
+		bump::io::write(os, JOURNAL_MAGIC);
+		bump::io::write(os, JOURNAL_VERSION);
+
+		bump::io::write(os, journal.m_seed);
+		bump::io::write(os, journal.m_depth);
+		bump::io::write(os, journal.m_level_size);
+		bump::io::write(os, journal.m_entries);
+
+		bump::io::write(os, journal.m_cycle_count);
+		bump::io::write(os, journal.m_checksum);
+	}
+
+	std::optional<journal> read_journal(std::istream& is)
+	{
+		bump::io::set_endian(is, std::endian::little);
+
+		if (bump::io::read<std::uint32_t>(is) != JOURNAL_MAGIC || bump::io::read<std::uint32_t>(is) != JOURNAL_VERSION)
+			return read_error(is, "not a journal, or an unsupported version!");
+
+		auto result = journal();
+
+		result.m_seed = bump::io::read<std::uint64_t>(is);
+		result.m_depth = bump::io::read<std::int32_t>(is);
+		result.m_level_size = bump::io::read<glm::ivec2>(is);
+
+		// (checked before reading any further, as the simulation would die with these)
+		if (!is)
+			return read_error(is, "invalid journal data!");
+
+		if (!level_gen::is_valid_depth(result.m_depth))
+			return read_error(is, "invalid depth!");
+
+		if (!level_gen::is_valid_level_size(result.m_level_size))
+			return read_error(is, "invalid level size!");
+
+		result.m_entries = bump::io::read<std::vector<journal::entry>>(is);
+
+		result.m_cycle_count = bump::io::read<std::uint64_t>(is);
+		result.m_checksum = bump::io::read<std::uint64_t>(is);
+
+		if (!is)
+			return read_error(is, "invalid journal data!");
+
+		auto const by_cycle = [] (journal::entry const& a, journal::entry const& b) { return a.m_cycle < b.m_cycle; };
+
+		if (!std::is_sorted(result.m_entries.begin(), result.m_entries.end(), by_cycle) ||
+			(!result.m_entries.empty() && result.m_entries.back().m_cycle > result.m_cycle_count))
+			return read_error(is, "entries out of order!");
+
+		return result;
+	}
+
+	bool save_journal(std::filesystem::path const& path, journal const& journal)
+	{
+		auto ec = std::error_code();
+		std::filesystem::create_directories(path.parent_path(), ec);
+
+		auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+		write_journal(file, journal);
+		file.close();
+
+		if (!file)
+		{
+			bump::log_error("save_journal() failed: could not write file: {}", path.string());
+			return false;
+		}
+
+		return true;
+	}
+
+	std::optional<journal> load_journal(std::filesystem::path const& path)
+	{
+		auto file = std::ifstream(path, std::ios::binary);
+
+		if (!file)
+		{
+			bump::log_error("load_journal() failed: could not open file: {}", path.string());
+			return { };
+		}
+
+		return read_journal(file);
+	}
+
+	void replay_journal(simulation& sim, journal const& journal, std::uint64_t to_cycle)
+	{
+		to_cycle = std::min(to_cycle, journal.m_cycle_count);
+
+		// the first action that hasn't been queued yet
+		auto next = std::lower_bound(journal.m_entries.begin(), journal.m_entries.end(), sim.cycle_count(),
+			[] (journal::entry const& e, std::uint64_t cycle) { return e.m_cycle < cycle; });
+
+		while (sim.cycle_count() < to_cycle)
+		{
+			for (; next != journal.m_entries.end() && next->m_cycle == sim.cycle_count(); ++next)
+				sim.queue_action(next->m_action);
+
+			(void)sim.cycle();
+		}
+	}
+
+} // rog
+
+namespace bump
+{
+
+	namespace io
+	{
+
+		void write_impl<rog::journal::entry>::write(std::ostream& os, rog::journal::entry const& value)
+		{
+			namespace pa = rog::player_actions;
+
+			io::write(os, value.m_cycle);
+
+			if (std::holds_alternative<pa::move>(value.m_action))
+			{
+				io::write(os, std::uint8_t(rog::action_type::MOVE));
+				io::write(os, std::uint8_t(std::get<pa::move>(value.m_action).m_dir));
+			}
+			else if (std::holds_alternative<pa::use_stairs>(value.m_action))
+			{
+				io::write(os, std::uint8_t(rog::action_type::USE_STAIRS));
+				io::write(os, std::uint8_t(std::get<pa::use_stairs>(value.m_action).m_dir));
+			}
+			else if (std::holds_alternative<pa::travel>(value.m_action))
+			{
+				io::write(os, std::uint8_t(rog::action_type::TRAVEL));
+				io::write(os, std::get<pa::travel>(value.m_action).m_dst);
+			}
+			else
+			{
+				die();
+			}
+		}
+
+		rog::journal::entry read_impl<rog::journal::entry>::read(std::istream& is)
+		{
+			namespace pa = rog::player_actions;
+
+			auto const cycle = io::read<std::uint64_t>(is);
+			auto const type = io::read<std::uint8_t>(is);
+
+			if (type == std::uint8_t(rog::action_type::TRAVEL))
+				return { cycle, pa::travel{ io::read<glm::ivec2>(is) } };
+
+			auto const dir = io::read<std::uint8_t>(is);
+
+			// (invalid values are read as waiting in place, and fail the stream)
+			if (type == std::uint8_t(rog::action_type::MOVE) && dir <= std::uint8_t(rog::direction::DOWN_RIGHT))
+				return { cycle, pa::move{ rog::direction(dir) } };
+
+			if (type == std::uint8_t(rog::action_type::USE_STAIRS) && dir <= std::uint8_t(rog::stairs_direction::DOWN))
+				return { cycle, pa::use_stairs{ rog::stairs_direction(dir) } };
+
+			is.setstate(std::ios::failbit);
+			return { cycle, pa::move{ rog::direction::NONE } };
+		}
+
+	} // io
+
+} // bump
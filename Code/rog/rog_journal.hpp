@@ -0,0 +1,103 @@
+#pragma once
+
+#include "rog_player_action.hpp"
+
+#include <bump_io.hpp>
+#include <bump_math.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+namespace rog
+{
+
+	class simulation;
+
+	/* journal
+	 *
+	 * Everything needed to play a session again: the simulation's seed and
+	 * starting depth, and every player action queued, with the number of
+	 * cycles that had been run when it was queued. The simulation is
+	 * deterministic, so replaying the actions on the same cycles gives the
+	 * same game.
+	 *
+	 * m_cycle_count and m_checksum record where the session ended, so a
+	 * replay can be checked against it.
+	 *
+	 */
+	struct journal
+	{
+		struct entry
+		{
+			std::uint64_t m_cycle;
+			player_action m_action;
+		};
+
+		std::uint64_t m_seed = 0;
+		std::int32_t m_depth = 0;
+		glm::ivec2 m_level_size = glm::ivec2(0);
+		std::vector<entry> m_entries;
+
+		std::uint64_t m_cycle_count = 0;
+		std::uint64_t m_checksum = 0;
+	};
+
+	/* write_journal(), read_journal()
+	 *
+	 * Journals are written little endian. Each entry is the cycle, the
+	 * action type, and its direction or destination (10 or 17 bytes).
+	 *
+	 * read_journal() returns nothing if the data is invalid.
+	 *
+	 */
+	void write_journal(std::ostream& os, journal const& journal);
+	std::optional<journal> read_journal(std::istream& is);
+
+	bool save_journal(std::filesystem::path const& path, journal const& journal);
+	std::optional<journal> load_journal(std::filesystem::path const& path);
+
+	/* replay_journal()
+	 *
+	 * Runs `sim` (which should be started with the journal's seed, depth
+	 * and level size) until cycle `to_cycle`, or the end of the journal,
+	 * queueing the journal's actions on the same cycles as they were
+	 * recorded. Nothing is waited for, so this runs as fast as the
+	 * simulation can.
+	 *
+	 * A simulation that's part way through a replay can be replayed
+	 * further, so a session can be fast forwarded to just before a cycle
+	 * of interest, then stepped through.
+	 *
+	 */
+	void replay_journal(simulation& sim, journal const& journal, std::uint64_t to_cycle);
+
+} // rog
+
+namespace bump
+{
+
+	namespace io
+	{
+
+#pragma region rog::journal
+
+		template<>
+		struct write_impl<rog::journal::entry>
+		{
+			static void write(std::ostream& os, rog::journal::entry const& value);
+		};
+
+		template<>
+		struct read_impl<rog::journal::entry>
+		{
+			static rog::journal::entry read(std::istream& is);
+		};
+
+#pragma endregion
+
+	} // io
+
+} // bump
@@ -0,0 +1,155 @@
+#include "rog_journal.hpp"
+
+#include "rog_ecs.hpp"
+#include "rog_level_gen.hpp"
+#include "rog_random.hpp"
+#include "rog_simulation.hpp"
+
+#include <bump_range.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <sstream>
+#include <string>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		std::filesystem::path get_swap_dir()
+		{
+			return std::filesystem::temp_directory_path() / "rog_test_journal";
+		}
+
+		// a session with every kind of action, on random cycles
+		journal play_session(std::uint64_t seed, std::uint64_t cycles)
+		{
+			auto sim = simulation(seed, 1, level_gen::DEFAULT_LEVEL_SIZE, 1024 * 1024, get_swap_dir());
+			auto rng = random::rng_t(seed);
+
+			for ([[maybe_unused]] auto _ : bump::range(std::uint64_t{ 0 }, cycles))
+			{
+				auto const roll = random::rand_range(rng, 0, 99);
+
+				if (roll < 5)
+					sim.queue_action(player_actions::move{ direction(random::rand_range(rng, 0, 8)) });
+				else if (roll < 6)
+					sim.queue_action(player_actions::travel{ random::rand_range(rng, glm::ivec2(0), sim.level().size() - 1) });
+				else if (roll < 7)
+					sim.queue_action(player_actions::use_stairs{ stairs_direction(random::rand_range(rng, 0, 1)) });
+
+				(void)sim.cycle();
+			}
+
+			return sim.get_journal();
+		}
+
+		std::string to_bytes(journal const& journal)
+		{
+			auto os = std::ostringstream();
+			write_journal(os, journal);
+			return os.str();
+		}
+
+	} // unnamed
+
+	TEST(Test_rog_journal, replay_matches_session)
+	{
+		auto const recorded = play_session(777, 3'000);
+
+		auto is = std::istringstream(to_bytes(recorded));
+		auto const loaded = read_journal(is);
+
+		ASSERT_TRUE(loaded.has_value());
+		ASSERT_EQ(loaded->m_entries.size(), recorded.m_entries.size());
+		EXPECT_EQ(loaded->m_cycle_count, 3'000);
+
+		auto sim = simulation(loaded->m_seed, loaded->m_depth, loaded->m_level_size, 1024 * 1024, get_swap_dir());
+		replay_journal(sim, loaded.value(), loaded->m_cycle_count);
+
+		EXPECT_EQ(sim.cycle_count(), recorded.m_cycle_count);
+		EXPECT_EQ(sim.checksum(), recorded.m_checksum);
+
+		// and the replay's journal is the same as the original
+		EXPECT_EQ(to_bytes(sim.get_journal()), to_bytes(recorded));
+	}
+
+	TEST(Test_rog_journal, fast_forward_in_steps)
+	{
+		auto const recorded = play_session(31337, 2'000);
+
+		auto sim = simulation(recorded.m_seed, recorded.m_depth, recorded.m_level_size, 1024 * 1024, get_swap_dir());
+
+		for (auto to_cycle : { 1, 500, 501, 1'234, 5'000 })
+		{
+			replay_journal(sim, recorded, to_cycle);
+			EXPECT_EQ(sim.cycle_count(), std::min(std::uint64_t(to_cycle), recorded.m_cycle_count));
+		}
+
+		EXPECT_EQ(sim.checksum(), recorded.m_checksum);
+	}
+
+	TEST(Test_rog_journal, invalid_data)
+	{
+		auto const bytes = to_bytes(play_session(1, 500));
+
+		{
+			auto is = std::istringstream(std::string());
+			EXPECT_FALSE(read_journal(is).has_value());
+		}
+
+		{
+			auto is = std::istringstream(bytes.substr(0, bytes.size() - 1));
+			EXPECT_FALSE(read_journal(is).has_value());
+		}
+
+		{
+			auto corrupt = bytes;
+			corrupt[4] = '\x7F'; // version
+			auto is = std::istringstream(corrupt);
+			EXPECT_FALSE(read_journal(is).has_value());
+		}
+	}
+
+	TEST(Test_rog_journal, invalid_header)
+	{
+		auto const recorded = play_session(2, 100);
+
+		// each of these would kill (or hang) the simulation if it were replayed
+		auto const read_with = [&] (auto&& change)
+		{
+			auto j = recorded;
+			change(j);
+
+			auto is = std::istringstream(to_bytes(j));
+			return read_journal(is).has_value();
+		};
+
+		EXPECT_TRUE(read_with([] (journal&) { }));
+		EXPECT_FALSE(read_with([] (journal& j) { j.m_depth = 0; }));
+		EXPECT_FALSE(read_with([] (journal& j) { j.m_depth = -5; }));
+		EXPECT_FALSE(read_with([] (journal& j) { j.m_level_size = { 5, 5 }; }));
+		EXPECT_FALSE(read_with([] (journal& j) { j.m_level_size = { 100'000, 100'000 }; }));
+	}
+
+	TEST(Test_rog_journal, huge_entry_count)
+	{
+		auto bytes = to_bytes(play_session(3, 100));
+
+		// the entry count follows the magic, version, seed, depth and level size
+		auto const count_offset = std::size_t{ 4 + 4 + 8 + 4 + 8 };
+		auto const count = std::uint64_t{ 1 } << 40;
+
+		for (auto i : bump::range(0, 8))
+			bytes[count_offset + std::size_t(i)] = char((count >> (8 * i)) & 0xFF);
+
+		auto is = std::istringstream(bytes);
+		EXPECT_FALSE(read_journal(is).has_value());
+	}
+
+} // rog
@@ -10,13 +10,126 @@ namespace rog
 
 	bool level::is_walkable(glm::ivec2 pos) const
 	{
-		return !(m_grid.at(pos).m_flags & feature::flags::NO_WALK);
+		return m_layers.m_walkable.test(pos);
 	}
 
 	bool level::is_occupied(glm::ivec2 pos) const
 	{
 		return m_actors.at(pos) != entt::null;
 	}
+
+	void level::set_terrain(terrain_grid terrain)
+	{
+		m_grid = std::move(terrain);
+		++m_terrain_generation;
+
+		m_layers.build(m_grid);
+		m_path_hierarchy.clear(); // built when a path is first needed
+		m_path_replanner.reset();
+	}
+
+	void level::set_feature(glm::ivec2 pos, feature const& f)
+	{
+		bump::die_if(!in_bounds(pos));
+
+		auto const flags_changed = (m_grid.at(pos).m_flags != f.m_flags);
+
+		m_grid.set(pos, f);
+
+		// (just changing how a feature looks doesn't affect anything derived from the terrain)
+		if (flags_changed)
+		{
+			++m_terrain_generation;
+			m_layers.set(pos, f.m_flags);
+			m_path_hierarchy.update_tile(m_layers.m_walkable, pos);
+			m_path_replanner.tile_changed(pos);
+		}
+	}
+
+	void level::build_path_hierarchy()
+	{
+		if (!m_path_hierarchy.is_built_for(m_layers.m_walkable))
+			m_path_hierarchy.build(m_layers.m_walkable);
+	}
+
+	bool level::queue_path(glm::ivec2 src, glm::ivec2 dst)
+	{
+		clear_queued_path();
+
+		if (!in_bounds(src) || !in_bounds(dst))
+			return false;
+
+		build_path_hierarchy();
+
+		return m_path_hierarchy.find_abstract_path(m_layers.m_walkable, src, dst, m_queued_waypoints);
+	}
+
+	bool level::refine_queued_path(glm::ivec2 from)
+	{
+		if (!m_queued_path.empty())
+			return true;
+
+		if (m_queued_waypoints.empty())
+			return false;
+
+		auto const to = m_queued_waypoints.back();
+		m_queued_waypoints.pop_back();
+
+		build_path_hierarchy(); // e.g. if the path was loaded with the level
+
+		if (m_path_hierarchy.refine_segment(m_layers.m_walkable, from, to, m_queued_path))
+			return true;
+
+		// the level changed since the path was found, so try again
+		auto const dst = (m_queued_waypoints.empty() ? to : m_queued_waypoints.front());
+
+		if (!queue_path(from, dst) || m_queued_waypoints.empty())
+			return false;
+
+		auto const next = m_queued_waypoints.back();
+		m_queued_waypoints.pop_back();
+
+		return m_path_hierarchy.refine_segment(m_layers.m_walkable, from, next, m_queued_path);
+	}
+
+	std::optional<glm::ivec2> level::next_queued_step(glm::ivec2 from)
+	{
+		if (m_path_replanner.is_active())
+		{
+			if (auto const step = m_path_replanner.next_step(*this, from); step.has_value())
+				return step;
+
+			if (from != m_path_replanner.goal())
+				return { }; // the end of the segment can't be reached any more
+		}
+
+		if (!refine_queued_path(from))
+			return { };
+
+		auto const step = m_queued_path.back();
+		m_queued_path.pop_back();
+
+		return step;
+	}
+
+	bool level::repair_queued_path(glm::ivec2 from, glm::ivec2 blocked_step)
+	{
+		auto const segment_end =
+			m_path_replanner.is_active() ? m_path_replanner.goal() :
+			m_queued_path.empty() ? blocked_step :
+			m_queued_path.front();
+
+		m_queued_path.clear();
+
+		return m_path_replanner.plan(*this, from, segment_end);
+	}
+
+	void level::clear_queued_path()
+	{
+		m_queued_path.clear();
+		m_queued_waypoints.clear();
+		m_path_replanner.reset();
+	}
 	
 	bool level::move_actor(entt::entity entity, c_position& pos, glm::ivec2 target)
 	{
@@ -28,9 +141,15 @@ namespace rog
 		if (!is_walkable(target) || is_occupied(target))
 			return false;
 
-		m_actors.at(pos.m_pos) = entt::null;
+		if (entity != m_player)
+		{
+			m_path_replanner.tile_changed(pos.m_pos);
+			m_path_replanner.tile_changed(target);
+		}
+
+		m_actors.set(pos.m_pos, entt::null);
 		pos.m_pos = target;
-		m_actors.at(pos.m_pos) = entity;
+		m_actors.set(pos.m_pos, entity);
 
 		return true;
 	}
@@ -40,6 +159,16 @@ namespace rog
 		return move_actor(entity, pos, pos.m_pos + get_direction_vector(dir));
 	}
 
+	field_of_view const& level::update_fov(entt::entity viewer, std::int32_t radius)
+	{
+		return update_fov(viewer, m_registry.get<c_position>(viewer).m_pos, radius);
+	}
+
+	field_of_view const& level::update_fov(entt::entity viewer, glm::ivec2 viewer_pos, std::int32_t radius)
+	{
+		return m_fov.update(viewer, m_layers.m_walkable, m_terrain_generation, viewer_pos, radius);
+	}
+
 	namespace
 	{
 
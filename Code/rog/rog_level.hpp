@@ -2,19 +2,28 @@
 
 #include "rog_direction.hpp"
 #include "rog_feature.hpp"
+#include "rog_feature_layers.hpp"
+#include "rog_fov.hpp"
+#include "rog_level_distance_field.hpp"
+#include "rog_level_path_hierarchy.hpp"
+#include "rog_level_path_replanner.hpp"
+#include "rog_level_pathfinding.hpp"
+#include "rog_terrain_grid.hpp"
 
 #include <bump_aabb.hpp>
-#include <bump_grid.hpp>
+#include <bump_chunked_grid.hpp>
 
 #include <entt.hpp>
 
 #include <cstdint>
+#include <optional>
+#include <vector>
 
 namespace rog
 {
 
 	struct c_position;
-	struct screen_buffer;
+	class screen_buffer;
 
 	struct level
 	{
@@ -24,23 +33,102 @@ namespace rog
 		bool is_walkable(glm::ivec2 pos) const;
 		bool is_occupied(glm::ivec2 pos) const;
 
+		/* set_terrain(), set_feature()
+		 *
+		 * The only ways that m_grid should be changed, so that the packed
+		 * layers and the pathfinding structures derived from it are kept in
+		 * sync.
+		 *
+		 * set_terrain() doesn't build m_path_hierarchy, as it's slow on large
+		 * levels (and not every level is pathed on, e.g. levels that are only
+		 * loaded or pre-generated). It's built when it's first needed.
+		 *
+		 */
+		void set_terrain(terrain_grid terrain);
+		void set_feature(glm::ivec2 pos, feature const& f);
+
+		void build_path_hierarchy(); // if it isn't already built
+
+		/* queue_path()
+		 *
+		 * Finds a path from `src` to `dst` with m_path_hierarchy, storing the
+		 * waypoints in m_queued_waypoints. The steps between waypoints are only
+		 * found when needed, by refine_queued_path().
+		 *
+		 */
+		bool queue_path(glm::ivec2 src, glm::ivec2 dst);
+
+		/* refine_queued_path()
+		 *
+		 * If m_queued_path is empty, fills it with the steps from `from` to the
+		 * next waypoint. If the level has changed so that the next waypoint
+		 * can't be reached, the path to the final waypoint is found again.
+		 * Returns false if there are no more steps.
+		 *
+		 */
+		bool refine_queued_path(glm::ivec2 from);
+
+		/* next_queued_step()
+		 *
+		 * Removes and returns the next step of the queued path from `from`
+		 * (from m_path_replanner while it's active, otherwise from
+		 * m_queued_path, refining the next segment as needed).
+		 *
+		 */
+		std::optional<glm::ivec2> next_queued_step(glm::ivec2 from);
+
+		/* repair_queued_path()
+		 *
+		 * Called when `blocked_step` (the last step returned) couldn't be
+		 * taken. Plans a way around the obstacle to the end of the current
+		 * segment with m_path_replanner, which then supplies the steps until
+		 * it gets there, repairing its search as other actors move.
+		 *
+		 */
+		bool repair_queued_path(glm::ivec2 from, glm::ivec2 blocked_step);
+
+		bool has_queued_path() const { return !m_queued_path.empty() || !m_queued_waypoints.empty() || m_path_replanner.is_active(); }
+		void clear_queued_path();
+
 		bool move_actor(entt::entity entity, c_position& pos, glm::ivec2 target);
 		bool move_actor(entt::entity entity, c_position& pos, direction dir);
 
+		/* update_fov()
+		 *
+		 * Returns the field of view of `viewer` (which must have a position),
+		 * from m_fov. It's only recomputed if the viewer has moved or the
+		 * terrain has changed since it was last updated.
+		 *
+		 * The version taking the viewer's position doesn't touch the
+		 * registry, so it can be called for several viewers at once (see
+		 * fov_cache).
+		 *
+		 */
+		field_of_view const& update_fov(entt::entity viewer, std::int32_t radius);
+		field_of_view const& update_fov(entt::entity viewer, glm::ivec2 viewer_pos, std::int32_t radius);
+
 		bump::iaabb2 get_map_panel(glm::ivec2 panel_size, glm::ivec2 focus_lv) const;
 		bump::iaabb2 get_map_panel(glm::ivec2 panel_size) const;
 
 		std::int32_t m_depth;
-		bump::grid2<feature, glm::ivec2> m_grid;
+		terrain_grid m_grid;
+		feature_layers m_layers; // packed copies of the flags in m_grid
 
 		entt::registry m_registry;
 		entt::entity m_player;
-		bump::grid2<entt::entity, glm::ivec2> m_actors;
+		bump::chunked_grid2<entt::entity> m_actors; // only chunks containing actors are allocated
 
 		std::optional<glm::ivec2> m_hovered_tile;
 		std::vector<glm::ivec2> m_queued_path;
-	};
+		std::vector<glm::ivec2> m_queued_waypoints;
 
-	std::vector<glm::ivec2> find_path(bump::grid2<feature, glm::ivec2> const& grid, glm::ivec2 src, glm::ivec2 dst);
+		pathfinding_workspace m_pathfinding;
+		path_hierarchy m_path_hierarchy;
+		path_replanner m_path_replanner;
+
+		std::uint32_t m_terrain_generation = 0; // incremented whenever the flags in m_grid (walkability, stairs, etc.) change
+		level_distance_fields m_distance_fields;
+		fov_cache m_fov;
+	};
 
 } // rog
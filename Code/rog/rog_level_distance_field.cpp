@@ -0,0 +1,143 @@
+#include "rog_level_distance_field.hpp"
+
+#include "rog_ecs.hpp"
+#include "rog_level.hpp"
+
+#include <bump_die.hpp>
+#include <bump_range.hpp>
+
+#include <algorithm>
+#include <bit>
+
+namespace rog
+{
+
+	void distance_field::compute(bit_grid const& walkable)
+	{
+		m_extents = walkable.extents();
+		m_values.assign(std::size_t(m_extents.x) * std::size_t(m_extents.y), UNREACHABLE);
+
+		std::sort(m_sources.begin(), m_sources.end(), [] (source const& a, source const& b) { return a.m_value < b.m_value; });
+
+		// the queue only ever has values pushed in non-decreasing order, so
+		// taking the lowest of the queue front and the next source always
+		// expands the lowest value remaining (as dijkstra would).
+		m_queue.clear();
+		auto queue_front = std::size_t{ 0 };
+		auto next_source = m_sources.begin();
+
+		while (queue_front != m_queue.size() || next_source != m_sources.end())
+		{
+			auto current = entry();
+
+			if (next_source != m_sources.end() && (queue_front == m_queue.size() || next_source->m_value < m_queue[queue_front].m_value))
+			{
+				bump::die_if(next_source->m_pos.x < 0 || next_source->m_pos.x >= m_extents.x);
+				bump::die_if(next_source->m_pos.y < 0 || next_source->m_pos.y >= m_extents.y);
+
+				auto const source_pos = next_source->m_pos;
+				current = { next_source->m_value, to_index(source_pos) };
+				++next_source;
+
+				if (!walkable.test(source_pos) || current.m_value >= m_values[current.m_index])
+					continue;
+
+				m_values[current.m_index] = current.m_value;
+			}
+			else
+			{
+				current = m_queue[queue_front++];
+
+				if (current.m_value != m_values[current.m_index])
+					continue; // a lower value was found after this was queued
+			}
+
+			auto const pos = glm::ivec2{ current.m_index % m_extents.x, current.m_index / m_extents.x };
+			auto const next_value = current.m_value + 1;
+
+			for (auto neighbours = walkable.neighbours(pos); neighbours != 0; neighbours &= neighbours - 1)
+			{
+				auto const next_index = to_index(pos + bit_grid::neighbour_offsets[std::countr_zero(neighbours)]);
+
+				if (next_value >= m_values[next_index])
+					continue;
+
+				m_values[next_index] = next_value;
+				m_queue.push_back({ next_value, next_index });
+			}
+		}
+	}
+
+	void distance_field::set_sources_flee(distance_field const& toward)
+	{
+		// note: the coefficient must be less than -1 so that fleeing actors
+		// prefer open escape routes to getting cornered (following the
+		// field alone may lead past the player - see flee_direction())
+		auto constexpr FLEE_NUMERATOR = value_t{ -6 };
+		auto constexpr FLEE_DENOMINATOR = value_t{ 5 };
+
+		clear_sources();
+
+		auto const extents = toward.extents();
+
+		for (auto y : bump::range(0, extents.y))
+		{
+			for (auto x : bump::range(0, extents.x))
+			{
+				auto const value = toward.at({ x, y });
+
+				if (value == UNREACHABLE)
+					continue;
+
+				add_source({ x, y }, value * FLEE_NUMERATOR / FLEE_DENOMINATOR);
+			}
+		}
+	}
+
+	void level_distance_fields::update(level const& level)
+	{
+		auto const& player_pos = level.m_registry.get<c_position>(level.m_player).m_pos;
+
+		auto const terrain_changed = (!m_valid || m_terrain_generation != level.m_terrain_generation);
+		auto const player_moved = (!m_valid || m_player_pos != player_pos);
+
+		if (terrain_changed)
+		{
+			m_to_stairs.clear_sources();
+
+			auto const add_stairs = [&] (glm::ivec2 pos) { m_to_stairs.add_source(pos, 0); };
+			level.m_layers.m_stairs_down.for_each_set(add_stairs);
+			level.m_layers.m_stairs_up.for_each_set(add_stairs);
+
+			m_to_stairs.compute(level.m_layers.m_walkable);
+		}
+
+		if (terrain_changed || player_moved)
+		{
+			m_to_player.clear_sources();
+			m_to_player.add_source(player_pos, 0);
+			m_to_player.compute(level.m_layers.m_walkable);
+
+			m_flee_player_valid = false;
+		}
+
+		m_player_pos = player_pos;
+		m_terrain_generation = level.m_terrain_generation;
+		m_valid = true;
+	}
+
+	distance_field const& level_distance_fields::flee_player(level const& level)
+	{
+		bump::die_if(!m_valid);
+
+		if (!m_flee_player_valid)
+		{
+			m_flee_player.set_sources_flee(m_to_player);
+			m_flee_player.compute(level.m_layers.m_walkable);
+			m_flee_player_valid = true;
+		}
+
+		return m_flee_player;
+	}
+
+} // rog
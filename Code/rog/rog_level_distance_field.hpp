@@ -0,0 +1,165 @@
+#pragma once
+
+#include "rog_bit_grid.hpp"
+#include "rog_direction.hpp"
+
+#include <bump_math.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace rog
+{
+
+	struct level;
+
+	/* distance_field
+	 *
+	 * A "dijkstra map": the walking distance from every tile to the nearest
+	 * source tile (plus that source's starting value), computed once for the
+	 * whole level. Any number of actors can then move towards the sources by
+	 * stepping to their lowest neighbour, without doing their own search.
+	 *
+	 * Sources may start at different values. Every step costs 1, so the
+	 * field is computed by a breadth-first flood that merges in the sources
+	 * in order of value, rather than with a priority queue.
+	 *
+	 */
+	class distance_field
+	{
+	public:
+
+		using value_t = std::int32_t;
+		static constexpr value_t UNREACHABLE = std::numeric_limits<value_t>::max();
+
+		glm::ivec2 extents() const { return m_extents; }
+
+		value_t at(glm::ivec2 pos) const { return m_values[to_index(pos)]; }
+		bool is_reachable(glm::ivec2 pos) const { return at(pos) != UNREACHABLE; }
+
+		void clear_sources() { m_sources.clear(); }
+		void add_source(glm::ivec2 pos, value_t value) { m_sources.push_back({ value, pos }); }
+
+		void compute(bit_grid const& walkable);
+
+		/* set_sources_flee()
+		 *
+		 * Turns every reachable tile in `toward` into a source, with its
+		 * value multiplied by a negative coefficient. Following the computed
+		 * field downhill moves away from the original sources, but favours
+		 * escape routes that don't lead into dead ends.
+		 *
+		 */
+		void set_sources_flee(distance_field const& toward);
+
+		/* downhill()
+		 *
+		 * Returns the direction of the neighbour of `pos` with the lowest
+		 * value (less than the value at `pos`) that `can_enter` accepts, or
+		 * direction::NONE if there isn't one.
+		 *
+		 */
+		template<class PredT>
+		direction downhill(glm::ivec2 pos, PredT&& can_enter) const;
+
+	private:
+
+		using index_t = std::int32_t;
+
+		struct source
+		{
+			value_t m_value;
+			glm::ivec2 m_pos;
+		};
+
+		struct entry
+		{
+			value_t m_value;
+			index_t m_index;
+		};
+
+		index_t to_index(glm::ivec2 pos) const { return pos.y * m_extents.x + pos.x; }
+
+		glm::ivec2 m_extents = glm::ivec2(0);
+		std::vector<value_t> m_values;
+		std::vector<source> m_sources;
+		std::vector<entry> m_queue;
+	};
+
+	template<class PredT>
+	direction distance_field::downhill(glm::ivec2 pos, PredT&& can_enter) const
+	{
+		auto best = at(pos);
+		auto best_dir = direction::NONE;
+
+		for (auto y : { -1, 0, 1 })
+		{
+			for (auto x : { -1, 0, 1 })
+			{
+				auto const next = pos + glm::ivec2{ x, y };
+
+				if (next.x < 0 || next.y < 0 || next.x >= m_extents.x || next.y >= m_extents.y)
+					continue;
+
+				auto const value = at(next);
+
+				if (value < best && can_enter(next))
+				{
+					best = value;
+					best_dir = get_direction({ x, y });
+				}
+			}
+		}
+
+		return best_dir;
+	}
+
+	/* level_distance_fields
+	 *
+	 * The distance fields shared by all the monsters on a level. Each field
+	 * is only recomputed when its sources (the player's position or the
+	 * terrain) have changed since it was last computed. The flee field is
+	 * only computed when it's asked for (see flee_player()), as few
+	 * monsters need it.
+	 *
+	 */
+	struct level_distance_fields
+	{
+		void update(level const& level);
+
+		// computes the flee field first if the player has moved (note: update() must have been called)
+		distance_field const& flee_player(level const& level);
+
+		/* flee_direction()
+		 *
+		 * Returns the direction to step in to flee the player from `pos`
+		 * (downhill on the flee field, but never to a tile nearer the
+		 * player), or direction::NONE if there isn't one.
+		 *
+		 */
+		template<class PredT>
+		direction flee_direction(level const& level, glm::ivec2 pos, PredT&& can_enter);
+
+		distance_field m_to_player;
+		distance_field m_flee_player;
+		distance_field m_to_stairs;
+
+		glm::ivec2 m_player_pos = glm::ivec2(-1);
+		std::uint32_t m_terrain_generation = 0;
+		bool m_valid = false;
+		bool m_flee_player_valid = false;
+	};
+
+	template<class PredT>
+	direction level_distance_fields::flee_direction(level const& level, glm::ivec2 pos, PredT&& can_enter)
+	{
+		auto const distance = m_to_player.at(pos);
+
+		return flee_player(level).downhill(pos, [&] (glm::ivec2 next)
+		{
+			return m_to_player.at(next) >= distance && can_enter(next);
+		});
+	}
+
+} // rog
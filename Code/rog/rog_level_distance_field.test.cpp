@@ -0,0 +1,162 @@
+#include "rog_level_distance_field.hpp"
+
+#include "rog_bit_grid.hpp"
+#include "rog_level.hpp"
+#include "rog_level_gen.hpp"
+#include "rog_random.hpp"
+
+#include <bump_range.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <queue>
+#include <vector>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		bit_grid make_random_map(random::rng_t& rng, glm::ivec2 size, float wall_chance)
+		{
+			auto walkable = bit_grid(size, true);
+
+			for (auto y : bump::range(0, size.y))
+				for (auto x : bump::range(0, size.x))
+					if (random::rand_01<float>(rng) < wall_chance)
+						walkable.set({ x, y }, false);
+
+			return walkable;
+		}
+
+		// a breadth first search from `src` (every step costs 1)
+		std::vector<distance_field::value_t> distances_from(bit_grid const& walkable, glm::ivec2 src)
+		{
+			auto const size = walkable.extents();
+			auto const to_index = [&] (glm::ivec2 p) { return std::size_t(p.y) * std::size_t(size.x) + std::size_t(p.x); };
+
+			auto distances = std::vector<distance_field::value_t>(std::size_t(size.x) * std::size_t(size.y), distance_field::UNREACHABLE);
+			auto open = std::queue<glm::ivec2>();
+
+			distances[to_index(src)] = 0;
+			open.push(src);
+
+			while (!open.empty())
+			{
+				auto const current = open.front();
+				open.pop();
+
+				for (auto const& offset : bit_grid::neighbour_offsets)
+				{
+					auto const next = current + offset;
+
+					if (!walkable.in_bounds(next) || !walkable.test(next) || distances[to_index(next)] != distance_field::UNREACHABLE)
+						continue;
+
+					distances[to_index(next)] = distances[to_index(current)] + 1;
+					open.push(next);
+				}
+			}
+
+			return distances;
+		}
+
+	} // unnamed
+
+	TEST(Test_rog_level_distance_field, matches_breadth_first_search_from_several_goals)
+	{
+		auto rng = random::rng_t(78901);
+		auto field = distance_field();
+
+		for (auto map : bump::range(0, 50))
+		{
+			auto const size = random::rand_range(rng, glm::ivec2(2), glm::ivec2(40));
+			auto const walkable = make_random_map(rng, size, random::rand_range(rng, 0.f, 0.45f));
+
+			if (walkable.count() == 0)
+				continue;
+
+			auto const to_index = [&] (glm::ivec2 p) { return std::size_t(p.y) * std::size_t(size.x) + std::size_t(p.x); };
+
+			// the nearest goal, counting each goal's starting value
+			auto expected = std::vector<distance_field::value_t>(std::size_t(size.x) * std::size_t(size.y), distance_field::UNREACHABLE);
+
+			field.clear_sources();
+
+			for (auto goal : bump::range(0, random::rand_range(rng, 1, 5)))
+			{
+				(void)goal;
+
+				auto src = glm::ivec2(0);
+
+				do src = random::rand_range(rng, glm::ivec2(0), size - 1);
+				while (!walkable.test(src));
+
+				auto const value = random::rand_range(rng, 0, 8);
+				field.add_source(src, value);
+
+				auto const distances = distances_from(walkable, src);
+
+				for (auto i : bump::range(std::size_t{ 0 }, expected.size()))
+					if (distances[i] != distance_field::UNREACHABLE)
+						expected[i] = std::min(expected[i], distances[i] + value);
+			}
+
+			field.compute(walkable);
+
+			for (auto y : bump::range(0, size.y))
+				for (auto x : bump::range(0, size.x))
+					EXPECT_EQ(field.at({ x, y }), expected[to_index({ x, y })]) << "map " << map << ", tile " << x << ", " << y;
+		}
+	}
+
+	TEST(Test_rog_level_distance_field, fleeing_never_nears_the_player)
+	{
+		for (auto seed : bump::range(0, 10))
+		{
+			auto level = level_gen::generate_level(0x5eed + seed, 2, { 48, 32 });
+			auto& fields = level.m_distance_fields;
+			fields.update(level);
+
+			auto const& to_player = fields.m_to_player;
+			auto const can_enter = [&] (glm::ivec2 pos) { return level.is_walkable(pos); };
+
+			for (auto y : bump::range(0, level.size().y))
+			{
+				for (auto x : bump::range(0, level.size().x))
+				{
+					if (!to_player.is_reachable({ x, y }))
+						continue;
+
+					SCOPED_TRACE(testing::Message() << "seed " << seed << ", from " << x << ", " << y);
+
+					// follow the flee field until it stops (which it must, since each step is downhill)
+					auto pos = glm::ivec2{ x, y };
+
+					for (auto step : bump::range(0, level.size().x * level.size().y))
+					{
+						(void)step;
+
+						auto const dir = fields.flee_direction(level, pos, can_enter);
+
+						if (dir == direction::NONE)
+							break;
+
+						auto const next = pos + get_direction_vector(dir);
+
+						EXPECT_TRUE(level.is_walkable(next));
+						EXPECT_LT(fields.flee_player(level).at(next), fields.flee_player(level).at(pos));
+						EXPECT_GE(to_player.at(next), to_player.at(pos));
+
+						pos = next;
+					}
+
+					EXPECT_EQ(fields.flee_direction(level, pos, can_enter), direction::NONE);
+				}
+			}
+		}
+	}
+
+} // rog
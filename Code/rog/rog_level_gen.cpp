@@ -1,36 +1,70 @@
 #include "rog_level_gen.hpp"
 
+#include "rog_bit_grid.hpp"
 #include "rog_ecs.hpp"
 #include "rog_feature.hpp"
 #include "rog_random.hpp"
+#include "rog_terrain_grid.hpp"
 
 #include <bump_die.hpp>
 #include <bump_log.hpp>
 #include <bump_math.hpp>
 #include <bump_range.hpp>
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
 #include <map>
 #include <optional>
+#include <random>
+#include <utility>
+#include <vector>
 
 namespace rog
 {
-	
+
 	namespace level_gen
 	{
 
-		bump::grid2<feature, glm::ivec2> level_from_string(glm::ivec2 size, std::string const& in)
+		bool is_valid_depth(std::int64_t depth)
+		{
+			// (the level below must have a valid depth too)
+			return depth >= 1 && depth < std::numeric_limits<std::int32_t>::max();
+		}
+
+		bool is_valid_level_size(glm::ivec2 size)
 		{
-			bump::die_if(in.size() != size.x * size.y);
-			
-			auto const key = std::map<char, feature>
-			{
-				{ '.', features::floor },
-				{ '#', features::wall },
-				{ '<', features::stairs_up },
-				{ '>', features::stairs_down },
+			return glm::all(glm::greaterThanEqual(size, MIN_LEVEL_SIZE)) && glm::all(glm::lessThanEqual(size, MAX_LEVEL_SIZE));
+		}
+
+		random::rng_t make_level_rng(std::uint64_t dungeon_seed, std::int32_t depth)
+		{
+			auto seed = std::seed_seq{ std::uint32_t(dungeon_seed), std::uint32_t(dungeon_seed >> 32), std::uint32_t(depth) };
+
+			auto words = std::array<std::uint32_t, 8>();
+			seed.generate(words.begin(), words.end());
+
+			auto state = std::array<std::uint64_t, 4>();
+			for (auto i : bump::range(0, 4))
+				state[i] = (std::uint64_t(words[i * 2 + 1]) << 32) | words[i * 2];
+
+			return random::rng_t(state);
+		}
+
+		terrain_grid level_from_string(glm::ivec2 size, std::string const& in)
+		{
+			bump::die_if(in.size() != std::size_t(size.x) * std::size_t(size.y));
+
+			auto const key = std::map<char, feature_id>
+			{
+				{ '.', feature_ids::floor },
+				{ '#', feature_ids::wall },
+				{ '<', feature_ids::stairs_up },
+				{ '>', feature_ids::stairs_down },
 			};
 
-			auto grid = bump::grid2<feature, glm::ivec2>(size, features::floor);
+			auto grid = terrain_grid(size, feature_ids::floor);
 
 			for (auto const y : bump::range(0, size.y))
 			{
@@ -41,43 +75,253 @@ namespace rog
 
 					bump::die_if(f == key.end());
 
-					grid.at({ x, y }) = f->second;
+					grid.set({ x, y }, f->second);
 				}
 			}
 
+			grid.compact();
+
 			return grid;
 		}
 
-		auto const level_1 = level_from_string
-		(
-			{ 5, 4 },
-			"....."
-			".###."
-			".###."
-			"....<"
-		);
-		
-		auto const level_2 = level_from_string
-		(
-			{ 5, 4 },
-			">...#"
-			"....#"
-			"....#"
-			"####<"
-		);
-		
-		auto const level_3 = level_from_string
-		(
-			{ 5, 4 },
-			">.###"
-			"....#"
-			"#.###"
-			"#####"
-		);
+		namespace
+		{
+
+			struct room
+			{
+				glm::ivec2 m_origin;
+				glm::ivec2 m_size;
+
+				glm::ivec2 center() const { return m_origin + m_size / 2; }
+			};
+
+			// true if the rooms overlap or touch (so there's always a wall between them)
+			bool rooms_touch(room const& a, room const& b)
+			{
+				return
+					a.m_origin.x <= b.m_origin.x + b.m_size.x && b.m_origin.x <= a.m_origin.x + a.m_size.x &&
+					a.m_origin.y <= b.m_origin.y + b.m_size.y && b.m_origin.y <= a.m_origin.y + a.m_size.y;
+			}
+
+			void carve_room(bit_grid& open, room const& r)
+			{
+				for (auto y : bump::range(r.m_origin.y, r.m_origin.y + r.m_size.y))
+					for (auto x : bump::range(r.m_origin.x, r.m_origin.x + r.m_size.x))
+						open.set({ x, y }, true);
+			}
+
+			// an L-shaped corridor from `a` to `b`
+			void carve_corridor(bit_grid& open, glm::ivec2 a, glm::ivec2 b, bool horizontal_first)
+			{
+				auto const corner = (horizontal_first ? glm::ivec2{ b.x, a.y } : glm::ivec2{ a.x, b.y });
+
+				auto const carve_line = [&] (glm::ivec2 from, glm::ivec2 to)
+				{
+					auto const step = glm::sign(to - from);
+
+					for (auto p = from; p != to; p += step)
+						open.set(p, true);
+
+					open.set(to, true);
+				};
+
+				carve_line(a, corner);
+				carve_line(corner, b);
+			}
+
+			void generate_rooms(bit_grid& open, random::rng_t& rng)
+			{
+				auto const size = open.extents();
+				auto const max_room_size = glm::ivec2{ std::min(14, size.x / 3), std::min(9, size.y / 3) };
+				auto const min_room_size = glm::ivec2{ 4, 3 };
+				auto const max_rooms = std::max(4, (size.x * size.y) / 160);
+				auto const max_tries = max_rooms * 8;
+
+				auto rooms = std::vector<room>();
+
+				for (auto t = 0; t != max_tries && std::ssize(rooms) != max_rooms; ++t)
+				{
+					auto const room_size = random::rand_range(rng, min_room_size, max_room_size);
+					auto const origin = random::rand_range(rng, glm::ivec2(1), size - room_size - glm::ivec2(1));
+					auto const r = room{ origin, room_size };
+
+					if (std::any_of(rooms.begin(), rooms.end(), [&] (room const& other) { return rooms_touch(r, other); }))
+						continue;
+
+					carve_room(open, r);
+
+					// joining each room to the previous one keeps everything connected
+					if (!rooms.empty())
+						carve_corridor(open, rooms.back().center(), r.center(), random::rand_range(rng, 0, 1) == 0);
+
+					rooms.push_back(r);
+				}
+
+				bump::die_if(rooms.empty());
+			}
+
+			void generate_caves(bit_grid& open, random::rng_t& rng)
+			{
+				auto constexpr OPEN_CHANCE = 0.55f;
+				auto constexpr SMOOTHING_STEPS = 5;
+				auto constexpr WALL_THRESHOLD = 5; // a floor tile with at least this many wall neighbours becomes a wall (and a wall with one less stays one)
+
+				auto const size = open.extents();
+
+				// the edges are always walls
+				for (auto y : bump::range(1, size.y - 1))
+					for (auto x : bump::range(1, size.x - 1))
+						open.set({ x, y }, random::rand_01<float>(rng) < OPEN_CHANCE);
+
+				auto next = bit_grid(size, false);
+
+				for (auto i = 0; i != SMOOTHING_STEPS; ++i)
+				{
+					for (auto y : bump::range(1, size.y - 1))
+					{
+						for (auto x : bump::range(1, size.x - 1))
+						{
+							auto const walls = 8 - std::popcount(open.neighbours({ x, y }));
+							auto const threshold = (open.test({ x, y }) ? WALL_THRESHOLD : WALL_THRESHOLD - 1);
+							next.set({ x, y }, walls < threshold);
+						}
+					}
+
+					std::swap(open, next);
+				}
+			}
+
+			/* keep_largest_area()
+			 *
+			 * Fills in everything except the largest connected area of `open`.
+			 * Returns the number of tiles left.
+			 *
+			 */
+			std::size_t keep_largest_area(bit_grid& open)
+			{
+				auto const size = open.extents();
+				auto const words = open.words_per_row();
+
+				auto remaining = open;
+				auto area = bit_grid();
+				auto largest = bit_grid(size, false);
+				auto largest_count = std::size_t{ 0 };
+
+				for (auto y : bump::range(0, size.y))
+				{
+					for (auto w : bump::range(0, words))
+					{
+						while (remaining.row(y)[w] != 0)
+						{
+							auto const x = w * bit_grid::WORD_BITS + std::countr_zero(remaining.row(y)[w]);
+
+							flood_fill(open, { x, y }, area);
+
+							// remove the area from what's left to search
+							for (auto ay : bump::range(y, size.y))
+								for (auto aw : bump::range(0, words))
+									remaining.row(ay)[aw] &= ~area.row(ay)[aw];
+
+							auto const count = area.count();
+
+							if (count > largest_count)
+							{
+								largest_count = count;
+								std::swap(largest, area);
+							}
+						}
+					}
+				}
+
+				open = std::move(largest);
+
+				return largest_count;
+			}
+
+			glm::ivec2 pick_open_tile(std::vector<glm::ivec2> const& tiles, random::rng_t& rng)
+			{
+				bump::die_if(tiles.empty());
+				return tiles[random::rand_range(rng, std::size_t{ 0 }, tiles.size() - 1)];
+			}
+
+		} // unnamed
+
+		terrain_grid generate_terrain(glm::ivec2 size, std::int32_t depth, random::rng_t& rng)
+		{
+			bump::die_if(depth < 1);
+			bump::die_if(size.x < MIN_LEVEL_SIZE.x || size.y < MIN_LEVEL_SIZE.y);
+
+			auto constexpr CAVE_CHANCE = 0.3f;
+			auto constexpr MIN_CAVE_AREA_FRACTION = 0.2f;
+
+			auto open = bit_grid(size, false);
+
+			auto const caves = random::rand_01<float>(rng) < CAVE_CHANCE;
+
+			if (caves)
+			{
+				generate_caves(open, rng);
+
+				// if the caves are too small, try rooms instead
+				if (keep_largest_area(open) < std::size_t(MIN_CAVE_AREA_FRACTION * float(size.x * size.y)))
+				{
+					open.fill(false);
+					generate_rooms(open, rng);
+				}
+			}
+			else
+			{
+				generate_rooms(open, rng);
+			}
+
+			auto tiles = std::vector<glm::ivec2>();
+			tiles.reserve(open.count());
+			open.for_each_set([&] (glm::ivec2 p) { tiles.push_back(p); });
+
+			auto terrain = terrain_grid(size, feature_ids::wall);
+
+			for (auto const& p : tiles)
+				terrain.set(p, feature_ids::floor);
+
+			// stairs
+			{
+				auto const up = pick_open_tile(tiles, rng);
+				terrain.set(up, feature_ids::stairs_up);
+
+				if (depth > 1)
+				{
+					// put the down stairs as far from the up stairs as possible (out of a few tries)
+					auto constexpr STAIRS_TRIES = 8;
+
+					auto down = up;
+					auto down_distance = 0;
+
+					for (auto t = 0; t != STAIRS_TRIES; ++t)
+					{
+						auto const p = pick_open_tile(tiles, rng);
+						auto const delta = glm::abs(p - up);
+						auto const d = std::max(delta.x, delta.y);
+
+						if (d > down_distance)
+						{
+							down = p;
+							down_distance = d;
+						}
+					}
+
+					if (down != up)
+						terrain.set(down, feature_ids::stairs_down);
+				}
+			}
+
+			terrain.compact(); // (open areas filling whole chunks)
+
+			return terrain;
+		}
 
 		bool place_player(level& level)
 		{
-			auto const level_size = level.m_grid.extents();
+			auto const level_size = level.size();
 
 			auto const pos = [&] ()
 			{
@@ -95,7 +339,7 @@ namespace rog
 
 			level.m_registry.get<c_position>(level.m_player).m_pos = pos.value();
 
-			level.m_actors.at(pos.value()) = level.m_player;
+			level.m_actors.set(pos.value(), level.m_player);
 
 			return true;
 		}
@@ -125,27 +369,28 @@ namespace rog
 
 			monster_handle.get<c_position>().m_pos = pos.value();
 
-			level.m_actors.at(pos.value()) = monster_handle.entity();
+			level.m_actors.set(pos.value(), monster_handle.entity());
 
 			return true;
 		}
 
-		level generate_level(std::int32_t depth, random::rng_t& rng)
+		level generate_level(std::uint64_t dungeon_seed, std::int32_t depth, glm::ivec2 size)
 		{
-			bump::die_if(depth < 1);
-			bump::die_if(depth > 3);
+			auto constexpr TILES_PER_MONSTER = std::size_t{ 250 };
 
-			auto const& map = (depth == 1 ? level_1 : depth == 2 ? level_2 : level_3);
+			auto rng = make_level_rng(dungeon_seed, depth);
 
 			auto level = rog::level
-			{ 
+			{
 				.m_depth = depth,
-				.m_grid = map,
+				.m_grid = { },
 				.m_registry = {},
 				.m_player = entt::null,
-				.m_actors = bump::grid2<entt::entity, glm::ivec2>(map.extents(), entt::null),
+				.m_actors = bump::chunked_grid2<entt::entity>(size, entt::null),
 			};
 
+			level.set_terrain(generate_terrain(size, depth, rng));
+
 			// add player
 			level.m_player = player_create_entity(level.m_registry); // todo: do this above (put registry before player)
 			if (!place_player(level))
@@ -153,17 +398,32 @@ namespace rog
 				bump::log_info("Failed to place player!");
 				bump::die();
 			}
-			
-			auto monster = monster_create_entity(level.m_registry);
-			if (!place_monster(level, { level.m_registry, monster }, rng))
+
+			// check the player can get to some stairs
 			{
-				bump::log_info("Failed to place monster!");
-				bump::die();
+				auto reachable = bit_grid();
+				flood_fill(level.m_layers.m_walkable, level.m_registry.get<c_position>(level.m_player).m_pos, reachable);
+
+				if (!intersects(reachable, level.m_layers.m_stairs_down) && !intersects(reachable, level.m_layers.m_stairs_up))
+					bump::log_info("No stairs are reachable from the player's position!");
+			}
+
+			// add monsters
+			auto const monster_count = 1 + level.m_layers.m_walkable.count() / TILES_PER_MONSTER;
+
+			for (auto i = std::size_t{ 0 }; i != monster_count; ++i)
+			{
+				auto monster = monster_create_entity(level.m_registry);
+				if (!place_monster(level, { level.m_registry, monster }, rng))
+				{
+					bump::log_info("Failed to place monster!");
+					bump::die();
+				}
 			}
 
 			return level;
 		}
-		
+
 	} // level_gen
-	
+
 } // rog
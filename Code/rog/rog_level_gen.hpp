@@ -2,18 +2,50 @@
 
 #include "rog_level.hpp"
 #include "rog_random.hpp"
+#include "rog_terrain_grid.hpp"
 
-#include <bump_grid.hpp>
 #include <bump_math.hpp>
 
+#include <cstdint>
+#include <string>
+
 namespace rog
 {
 
 	namespace level_gen
 	{
-		
-		level generate_level(std::int32_t depth, random::rng_t& rng);
-		
+
+		auto constexpr DEFAULT_LEVEL_SIZE = glm::ivec2{ 80, 40 };
+		auto constexpr MIN_LEVEL_SIZE = glm::ivec2{ 16, 12 };
+		auto constexpr MAX_LEVEL_SIZE = glm::ivec2{ 4096, 4096 };
+
+		// for checking depths and sizes from outside the game (command line arguments, journals, etc.) before generating anything
+		bool is_valid_depth(std::int64_t depth);
+		bool is_valid_level_size(glm::ivec2 size);
+
+		/* make_level_rng()
+		 *
+		 * Each depth gets its own rng, seeded from the dungeon seed and the
+		 * depth, so levels can be generated in any order (or on any thread)
+		 * and still come out the same.
+		 *
+		 */
+		random::rng_t make_level_rng(std::uint64_t dungeon_seed, std::int32_t depth);
+
+		terrain_grid level_from_string(glm::ivec2 size, std::string const& in);
+
+		/* generate_terrain()
+		 *
+		 * Either rooms joined by corridors, or caves (cellular automata,
+		 * keeping only the largest connected area). All the floor is
+		 * connected. There are always upward stairs, and downward stairs
+		 * below depth 1.
+		 *
+		 */
+		terrain_grid generate_terrain(glm::ivec2 size, std::int32_t depth, random::rng_t& rng);
+
+		level generate_level(std::uint64_t dungeon_seed, std::int32_t depth, glm::ivec2 size = DEFAULT_LEVEL_SIZE);
+
 	} // level_gen
-	
+
 } // rog
@@ -0,0 +1,352 @@
+#include "rog_level_io.hpp"
+
+#include "rog_feature_palette.hpp"
+#include "rog_terrain_grid.hpp"
+
+#include <bump_die.hpp>
+#include <bump_log.hpp>
+
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		auto constexpr LEVEL_MAGIC = std::uint32_t{ 0x524F474C }; // "ROGL"
+		auto constexpr LEVEL_VERSION = std::uint32_t{ 3 };
+
+		// more than this many entities (or components of one type) can't be valid
+		auto constexpr MAX_ENTITY_COUNT = std::uint64_t{ entt::entt_traits<entt::entity>::entity_mask } + 1;
+
+		/* output_archive, input_archive
+		 *
+		 * entt snapshot archives that read / write with bump::io. The snapshot
+		 * passes entities and components to the archive one at a time, so
+		 * they're collected here, and each array is written with a single
+		 * write_array() call once it's complete (and read the same way).
+		 *
+		 * The same list of components is used for saving and loading.
+		 *
+		 */
+		template<class... Components>
+		class output_archive
+		{
+		public:
+
+			explicit output_archive(std::ostream& os):
+				m_os(os),
+				m_remaining(0) { }
+
+			template<class SnapshotT>
+			void write(SnapshotT const& snapshot)
+			{
+				snapshot.entities(*this);
+				snapshot.template component<Components...>(*this);
+			}
+
+			void operator()(entt::id_type count)
+			{
+				bump::io::write(m_os, count);
+				m_remaining = count;
+			}
+
+			void operator()(entt::entity entity)
+			{
+				m_entities.push_back(entity);
+
+				if (--m_remaining == 0)
+					write_entities();
+			}
+
+			template<class T>
+			void operator()(entt::entity entity, T const& component)
+			{
+				auto& components = std::get<std::vector<T>>(m_components);
+
+				m_entities.push_back(entity);
+				components.push_back(component);
+
+				if (--m_remaining == 0)
+				{
+					write_entities();
+
+					bump::io::write_array(m_os, components.data(), components.size());
+					components.clear();
+				}
+			}
+
+		private:
+
+			void write_entities()
+			{
+				bump::io::write_array(m_os, m_entities.data(), m_entities.size());
+				m_entities.clear();
+			}
+
+			std::ostream& m_os;
+			entt::id_type m_remaining;
+			std::vector<entt::entity> m_entities;
+			std::tuple<std::vector<Components>...> m_components;
+		};
+
+		template<class... Components>
+		class input_archive
+		{
+		public:
+
+			explicit input_archive(std::istream& is):
+				m_is(is),
+				m_next(0) { }
+
+			template<class LoaderT>
+			void read(LoaderT const& loader)
+			{
+				loader.entities(*this);
+				loader.template component<Components...>(*this);
+			}
+
+			void operator()(entt::id_type& count)
+			{
+				count = bump::io::read<entt::id_type>(m_is);
+
+				if (!m_is || count > MAX_ENTITY_COUNT)
+				{
+					m_is.setstate(std::ios::failbit);
+					count = 0; // so the loader stops asking for data
+				}
+
+				m_entities.resize(count);
+				m_next = 0;
+			}
+
+			void operator()(entt::entity& entity)
+			{
+				if (m_next == 0)
+					bump::io::read_array(m_is, m_entities.data(), m_entities.size());
+
+				entity = m_entities[m_next++];
+			}
+
+			template<class T>
+			void operator()(entt::entity& entity, T& component)
+			{
+				auto& components = std::get<std::vector<T>>(m_components);
+
+				if (m_next == 0)
+				{
+					bump::io::read_array(m_is, m_entities.data(), m_entities.size());
+
+					components.resize(m_entities.size());
+					bump::io::read_array(m_is, components.data(), components.size());
+				}
+
+				entity = m_entities[m_next];
+				component = std::move(components[m_next]);
+
+				if (++m_next == m_entities.size())
+					components.clear();
+			}
+
+		private:
+
+			std::istream& m_is;
+			std::size_t m_next;
+			std::vector<entt::entity> m_entities;
+			std::tuple<std::vector<Components>...> m_components;
+		};
+
+		template<template<class...> class ArchiveT>
+		using with_level_components = ArchiveT<
+			c_player_char_info,
+			c_xp,
+			c_stats,
+			c_hp,
+			c_mp,
+			c_position,
+			c_visual,
+			c_actor,
+			c_player_tag,
+			c_monster_tag,
+			c_object_tag>;
+
+		using level_output_archive = with_level_components<output_archive>;
+		using level_input_archive = with_level_components<input_archive>;
+
+		rog::level read_error(std::istream& is, std::string const& message)
+		{
+			bump::log_error("read_impl<rog::level>::read() failed: " + message);
+			is.setstate(std::ios::failbit);
+			return rog::level();
+		}
+
+	} // unnamed
+
+	void write_level(std::ostream& os, level const& level)
+	{
+		bump::io::set_endian(os, std::endian::little);
+		bump::io::write(os, level);
+	}
+
+	std::optional<level> read_level(std::istream& is)
+	{
+		bump::io::set_endian(is, std::endian::little);
+		auto level = bump::io::read<rog::level>(is);
+
+		if (!is)
+			return { };
+
+		return level;
+	}
+
+} // rog
+
+namespace bump
+{
+
+	namespace io
+	{
+
+		void write_impl<rog::level>::write(std::ostream& os, rog::level const& value)
+		{
+			die_if(&value.m_grid.palette() != &rog::get_default_palette());
+
+			io::write(os, rog::LEVEL_MAGIC);
+			io::write(os, rog::LEVEL_VERSION);
+
+			io::write(os, value.m_depth);
+
+			// terrain (the ids in row order, then any overridden features)
+			{
+				auto const size = value.size();
+				io::write(os, size);
+
+				auto ids = std::vector<rog::feature_id>(std::size_t(size.x) * std::size_t(size.y));
+				auto overrides = std::vector<std::pair<glm::ivec2, rog::feature>>();
+
+				value.m_grid.for_each([&] (glm::ivec2 pos, rog::feature const& f)
+				{
+					auto const id = value.m_grid.id_at(pos);
+					ids[std::size_t(pos.y) * std::size_t(size.x) + std::size_t(pos.x)] = id;
+
+					if (id == rog::terrain_grid::OVERRIDDEN)
+						overrides.push_back({ pos, f });
+				});
+
+				io::write_array(os, ids.data(), ids.size());
+				io::write(os, overrides);
+			}
+
+			// entities
+			{
+				auto archive = rog::level_output_archive(os);
+				archive.write(entt::snapshot{ value.m_registry });
+
+				io::write(os, value.m_player);
+			}
+
+			// queued path (the replanner's search isn't kept)
+			io::write(os, value.m_queued_path);
+			io::write(os, value.m_queued_waypoints);
+		}
+
+		rog::level read_impl<rog::level>::read(std::istream& is)
+		{
+			if (io::read<std::uint32_t>(is) != rog::LEVEL_MAGIC || io::read<std::uint32_t>(is) != rog::LEVEL_VERSION)
+				return rog::read_error(is, "not a level, or an unsupported version!");
+
+			auto const depth = io::read<std::int32_t>(is);
+			auto const size = io::read<glm::ivec2>(is);
+
+			if (!is || size.x < 0 || size.y < 0 || std::uint64_t(size.x) * std::uint64_t(size.y) > std::uint64_t{ 1 } << 32)
+				return rog::read_error(is, "invalid level size!");
+
+			// terrain
+			auto terrain = rog::terrain_grid(size, rog::feature_ids::empty);
+			{
+				auto ids = std::vector<rog::feature_id>(std::size_t(size.x) * std::size_t(size.y));
+				io::read_array(is, ids.data(), ids.size());
+
+				if (!is)
+					return rog::read_error(is, "error reading terrain!");
+
+				auto const palette_size = terrain.palette().size();
+
+				for (auto& id : ids)
+				{
+					if (id == rog::terrain_grid::OVERRIDDEN)
+						id = rog::feature_ids::empty; // set below
+					else if (id >= palette_size)
+						return rog::read_error(is, "invalid feature id!");
+				}
+
+				terrain.assign(ids.data());
+
+				auto const overrides = io::read<std::vector<std::pair<glm::ivec2, rog::feature>>>(is);
+
+				for (auto const& [pos, f] : overrides)
+				{
+					if (pos.x < 0 || pos.y < 0 || pos.x >= size.x || pos.y >= size.y)
+						return rog::read_error(is, "invalid override position!");
+
+					terrain.set(pos, f);
+				}
+			}
+
+			if (!is)
+				return rog::read_error(is, "error reading terrain!");
+
+			auto level = rog::level
+			{
+				.m_depth = depth,
+				.m_grid = { },
+				.m_registry = {},
+				.m_player = entt::null,
+				.m_actors = bump::chunked_grid2<entt::entity>(size, entt::null),
+			};
+
+			level.set_terrain(std::move(terrain));
+
+			// entities
+			{
+				auto archive = rog::level_input_archive(is);
+				archive.read(entt::snapshot_loader{ level.m_registry });
+
+				level.m_player = io::read<entt::entity>(is);
+			}
+
+			if (!is || !level.m_registry.valid(level.m_player))
+				return rog::read_error(is, "error reading entities!");
+
+			// the actor grid is just an index of actor positions
+			{
+				auto view = level.m_registry.view<rog::c_actor const, rog::c_position const>();
+
+				for (auto const a : view)
+				{
+					auto const& pos = view.get<rog::c_position const>(a);
+
+					if (!level.in_bounds(pos.m_pos))
+						return rog::read_error(is, "actor out of bounds!");
+
+					level.m_actors.set(pos.m_pos, a);
+				}
+			}
+
+			// queued path
+			level.m_queued_path = io::read<std::vector<glm::ivec2>>(is);
+			level.m_queued_waypoints = io::read<std::vector<glm::ivec2>>(is);
+
+			if (!is)
+				return rog::read_error(is, "error reading queued path!");
+
+			return level;
+		}
+
+	} // io
+
+} // bump
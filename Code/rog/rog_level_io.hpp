@@ -0,0 +1,367 @@
+#pragma once
+
+#include "rog_ecs.hpp"
+#include "rog_feature.hpp"
+#include "rog_level.hpp"
+#include "rog_screen.hpp"
+
+#include <bump_io.hpp>
+
+#include <entt.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+
+namespace bump
+{
+
+	namespace io
+	{
+
+#pragma region entt
+
+		template<>
+		struct write_impl<entt::entity>
+		{
+			static void write(std::ostream& os, entt::entity value)
+			{
+				io::write<entt::id_type>(os, entt::to_integral(value));
+			}
+		};
+
+		template<>
+		struct read_impl<entt::entity>
+		{
+			static entt::entity read(std::istream& is)
+			{
+				return entt::entity{ io::read<entt::id_type>(is) };
+			}
+		};
+
+#pragma endregion
+
+#pragma region rog::screen_cell, rog::feature
+
+		template<>
+		struct write_impl<rog::screen_cell>
+		{
+			static void write(std::ostream& os, rog::screen_cell const& value)
+			{
+				io::write(os, value.m_value);
+				io::write(os, value.m_fg.m_rgba);
+				io::write(os, value.m_bg.m_rgba);
+				io::write(os, value.m_border.m_rgba);
+				io::write(os, value.m_border_width);
+			}
+		};
+
+		template<>
+		struct read_impl<rog::screen_cell>
+		{
+			static rog::screen_cell read(std::istream& is)
+			{
+				auto value = rog::screen_cell();
+				value.m_value = io::read<std::uint8_t>(is);
+				value.m_fg.m_rgba = io::read<std::uint32_t>(is);
+				value.m_bg.m_rgba = io::read<std::uint32_t>(is);
+				value.m_border.m_rgba = io::read<std::uint32_t>(is);
+				value.m_border_width = io::read<std::uint32_t>(is);
+				return value;
+			}
+		};
+
+		template<>
+		struct write_impl<rog::feature>
+		{
+			static void write(std::ostream& os, rog::feature const& value)
+			{
+				io::write(os, value.m_cell);
+				io::write<std::uint64_t>(os, value.m_flags);
+			}
+		};
+
+		template<>
+		struct read_impl<rog::feature>
+		{
+			static rog::feature read(std::istream& is)
+			{
+				auto value = rog::feature();
+				value.m_cell = io::read<rog::screen_cell>(is);
+				value.m_flags = rog::feature::flags(io::read<std::uint64_t>(is));
+				return value;
+			}
+		};
+
+#pragma endregion
+
+#pragma region components
+
+		template<>
+		struct write_impl<rog::c_player_char_info>
+		{
+			static void write(std::ostream& os, rog::c_player_char_info const& value)
+			{
+				io::write(os, value.m_name);
+				io::write(os, value.m_title);
+			}
+		};
+
+		template<>
+		struct read_impl<rog::c_player_char_info>
+		{
+			static rog::c_player_char_info read(std::istream& is)
+			{
+				auto value = rog::c_player_char_info();
+				value.m_name = io::read<std::string>(is);
+				value.m_title = io::read<std::string>(is);
+				return value;
+			}
+		};
+
+		template<>
+		struct write_impl<rog::c_xp>
+		{
+			static void write(std::ostream& os, rog::c_xp const& value)
+			{
+				io::write(os, value.m_xp);
+				io::write(os, value.m_level);
+			}
+		};
+
+		template<>
+		struct read_impl<rog::c_xp>
+		{
+			static rog::c_xp read(std::istream& is)
+			{
+				auto value = rog::c_xp();
+				value.m_xp = io::read<std::uint32_t>(is);
+				value.m_level = io::read<std::uint32_t>(is);
+				return value;
+			}
+		};
+
+		template<>
+		struct bulk_impl<rog::c_xp>
+		{
+			static constexpr bool enabled = true;
+			using value_type = std::uint32_t;
+			static constexpr std::size_t size = 2;
+		};
+
+		template<>
+		struct write_impl<rog::c_stats>
+		{
+			static void write(std::ostream& os, rog::c_stats const& value)
+			{
+				io::write(os, value.m_str);
+				io::write(os, value.m_dex);
+				io::write(os, value.m_con);
+				io::write(os, value.m_int);
+				io::write(os, value.m_wis);
+				io::write(os, value.m_cha);
+			}
+		};
+
+		template<>
+		struct read_impl<rog::c_stats>
+		{
+			static rog::c_stats read(std::istream& is)
+			{
+				auto value = rog::c_stats();
+				value.m_str = io::read<std::int32_t>(is);
+				value.m_dex = io::read<std::int32_t>(is);
+				value.m_con = io::read<std::int32_t>(is);
+				value.m_int = io::read<std::int32_t>(is);
+				value.m_wis = io::read<std::int32_t>(is);
+				value.m_cha = io::read<std::int32_t>(is);
+				return value;
+			}
+		};
+
+		template<>
+		struct bulk_impl<rog::c_stats>
+		{
+			static constexpr bool enabled = true;
+			using value_type = std::int32_t;
+			static constexpr std::size_t size = 6;
+		};
+
+		template<>
+		struct write_impl<rog::c_hp>
+		{
+			static void write(std::ostream& os, rog::c_hp const& value)
+			{
+				io::write(os, value.m_current);
+				io::write(os, value.m_max);
+			}
+		};
+
+		template<>
+		struct read_impl<rog::c_hp>
+		{
+			static rog::c_hp read(std::istream& is)
+			{
+				auto value = rog::c_hp();
+				value.m_current = io::read<std::int32_t>(is);
+				value.m_max = io::read<std::int32_t>(is);
+				return value;
+			}
+		};
+
+		template<>
+		struct bulk_impl<rog::c_hp>
+		{
+			static constexpr bool enabled = true;
+			using value_type = std::int32_t;
+			static constexpr std::size_t size = 2;
+		};
+
+		template<>
+		struct write_impl<rog::c_mp>
+		{
+			static void write(std::ostream& os, rog::c_mp const& value)
+			{
+				io::write(os, value.m_current);
+				io::write(os, value.m_max);
+			}
+		};
+
+		template<>
+		struct read_impl<rog::c_mp>
+		{
+			static rog::c_mp read(std::istream& is)
+			{
+				auto value = rog::c_mp();
+				value.m_current = io::read<std::int32_t>(is);
+				value.m_max = io::read<std::int32_t>(is);
+				return value;
+			}
+		};
+
+		template<>
+		struct bulk_impl<rog::c_mp>
+		{
+			static constexpr bool enabled = true;
+			using value_type = std::int32_t;
+			static constexpr std::size_t size = 2;
+		};
+
+		template<>
+		struct write_impl<rog::c_position>
+		{
+			static void write(std::ostream& os, rog::c_position const& value)
+			{
+				io::write(os, value.m_pos);
+			}
+		};
+
+		template<>
+		struct read_impl<rog::c_position>
+		{
+			static rog::c_position read(std::istream& is)
+			{
+				return { io::read<glm::ivec2>(is) };
+			}
+		};
+
+		template<>
+		struct bulk_impl<rog::c_position>
+		{
+			static constexpr bool enabled = true;
+			using value_type = std::int32_t;
+			static constexpr std::size_t size = 2;
+		};
+
+		template<>
+		struct write_impl<rog::c_visual>
+		{
+			static void write(std::ostream& os, rog::c_visual const& value)
+			{
+				io::write(os, value.m_cell);
+			}
+		};
+
+		template<>
+		struct read_impl<rog::c_visual>
+		{
+			static rog::c_visual read(std::istream& is)
+			{
+				return { io::read<rog::screen_cell>(is) };
+			}
+		};
+
+		template<>
+		struct write_impl<rog::c_actor>
+		{
+			static void write(std::ostream& os, rog::c_actor const& value)
+			{
+				io::write(os, value.m_energy);
+			}
+		};
+
+		template<>
+		struct read_impl<rog::c_actor>
+		{
+			static rog::c_actor read(std::istream& is)
+			{
+				auto value = rog::c_actor();
+				value.m_energy = io::read<std::int32_t>(is);
+				return value;
+			}
+		};
+
+		template<>
+		struct bulk_impl<rog::c_actor>
+		{
+			static constexpr bool enabled = true;
+			using value_type = std::int32_t;
+			static constexpr std::size_t size = 1;
+		};
+
+#pragma endregion
+
+#pragma region rog::level
+
+		template<>
+		struct write_impl<rog::level>
+		{
+			static void write(std::ostream& os, rog::level const& value);
+		};
+
+		template<>
+		struct read_impl<rog::level>
+		{
+			static rog::level read(std::istream& is);
+		};
+
+#pragma endregion
+
+	} // io
+
+} // bump
+
+namespace rog
+{
+
+	/* write_level(), read_level()
+	 *
+	 * Saves / restores a level (with write_impl<level> / read_impl<level>):
+	 * the terrain, the queued path, and every entity in the registry with
+	 * its components. The registry is saved with an entt snapshot (so entity
+	 * ids are kept), with each array of entities and components written in
+	 * one go. Everything else (the feature layers, pathfinding data, actor
+	 * grid, etc.) is rebuilt when the level is read.
+	 *
+	 * Only levels using the default feature palette can be saved. Levels
+	 * are written little endian, so the arrays can be copied straight to
+	 * the stream on most platforms.
+	 *
+	 * read_level() returns nothing if the data is invalid.
+	 *
+	 */
+	void write_level(std::ostream& os, level const& level);
+	std::optional<level> read_level(std::istream& is);
+
+} // rog
@@ -0,0 +1,156 @@
+#include "rog_level_io.hpp"
+
+#include "rog_level_gen.hpp"
+#include "rog_random.hpp"
+
+#include <bump_range.hpp>
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		level make_crowded_level(glm::ivec2 size, std::int32_t monster_count)
+		{
+			auto level = level_gen::generate_level(0x5eed, 3, size);
+			auto rng = random::rng_t(54321);
+
+			// some destroyed entities, so the entity versions and free list matter
+			for (auto i : bump::range(0, 16))
+				level.m_registry.destroy(level.m_registry.create(), entt::entt_traits<entt::entity>::version_type(i));
+
+			auto count = std::int32_t{ 0 };
+
+			while (count != monster_count)
+			{
+				auto const pos = random::rand_range(rng, glm::ivec2(0), size - 1);
+
+				if (!level.is_walkable(pos) || level.is_occupied(pos))
+					continue;
+
+				auto const monster = monster_create_entity(level.m_registry);
+				level.m_registry.get<c_position>(monster).m_pos = pos;
+				level.m_registry.get<c_actor>(monster).m_energy = random::rand_range(rng, 0, 99);
+				level.m_registry.emplace<c_hp>(monster, random::rand_range(rng, 1, 20), 20);
+				level.m_actors.set(pos, monster);
+
+				++count;
+			}
+
+			// a feature that isn't in the palette
+			auto f = level.m_grid.at({ 1, 1 });
+			f.m_cell.m_fg = colors::violet;
+			level.set_feature({ 1, 1 }, f);
+
+			auto const& player_pos = level.m_registry.get<c_position>(level.m_player).m_pos;
+			level.m_queued_path = { player_pos + glm::ivec2(1, 0), player_pos + glm::ivec2(2, 1) };
+			level.m_queued_waypoints = { player_pos + glm::ivec2(10, 4) };
+
+			return level;
+		}
+
+		std::string to_bytes(level const& level)
+		{
+			auto os = std::ostringstream();
+			write_level(os, level);
+			return os.str();
+		}
+
+	} // unnamed
+
+	TEST(Test_rog_level_io, round_trip)
+	{
+		auto const size = glm::ivec2(512, 512);
+		auto level = make_crowded_level(size, 10'000);
+
+		auto const bytes = to_bytes(level);
+
+		auto is = std::istringstream(bytes);
+		auto result = read_level(is);
+
+		ASSERT_TRUE(result.has_value());
+
+		auto& loaded = result.value();
+
+		EXPECT_EQ(loaded.m_depth, level.m_depth);
+		EXPECT_EQ(loaded.size(), size);
+		EXPECT_EQ(loaded.m_player, level.m_player);
+		EXPECT_EQ(loaded.m_grid.override_count(), 1);
+		EXPECT_EQ(loaded.m_queued_path, level.m_queued_path);
+		EXPECT_EQ(loaded.m_queued_waypoints, level.m_queued_waypoints);
+
+		auto terrain_differences = 0;
+		auto actor_differences = 0;
+
+		for (auto y : bump::range(0, size.y))
+		{
+			for (auto x : bump::range(0, size.x))
+			{
+				terrain_differences += (loaded.m_grid.at({ x, y }) != level.m_grid.at({ x, y }));
+				actor_differences += (loaded.m_actors.at({ x, y }) != level.m_actors.at({ x, y }));
+			}
+		}
+
+		EXPECT_EQ(terrain_differences, 0);
+		EXPECT_EQ(actor_differences, 0);
+
+		EXPECT_GE(loaded.m_registry.size<c_monster_tag>(), 10'000);
+		EXPECT_EQ(loaded.m_registry.size<c_monster_tag>(), level.m_registry.size<c_monster_tag>());
+		EXPECT_EQ(loaded.m_registry.size<c_hp>(), level.m_registry.size<c_hp>());
+
+		level.m_registry.view<c_monster_tag>().each([&] (entt::entity m)
+		{
+			ASSERT_TRUE(loaded.m_registry.valid(m));
+			EXPECT_EQ(loaded.m_registry.get<c_position>(m).m_pos, level.m_registry.get<c_position>(m).m_pos);
+			EXPECT_EQ(loaded.m_registry.get<c_actor>(m).m_energy, level.m_registry.get<c_actor>(m).m_energy);
+			EXPECT_EQ(loaded.m_registry.has<c_hp>(m), level.m_registry.has<c_hp>(m));
+			EXPECT_EQ(loaded.m_registry.get<c_visual>(m).m_cell, level.m_registry.get<c_visual>(m).m_cell);
+		});
+
+		level.m_registry.view<c_hp>().each([&] (entt::entity e, c_hp const& hp)
+		{
+			EXPECT_EQ(loaded.m_registry.get<c_hp>(e).m_current, hp.m_current);
+		});
+
+		EXPECT_EQ(loaded.m_registry.get<c_player_char_info>(loaded.m_player).m_name, level.m_registry.get<c_player_char_info>(level.m_player).m_name);
+
+		// destroyed entities are recycled in the same order
+		EXPECT_EQ(loaded.m_registry.create(), level.m_registry.create());
+
+		// and everything else that's saved matches too
+		loaded.m_registry.destroy(loaded.m_registry.create());
+		level.m_registry.destroy(level.m_registry.create());
+
+		EXPECT_EQ(to_bytes(loaded), to_bytes(level));
+	}
+
+	TEST(Test_rog_level_io, invalid_data)
+	{
+		auto const bytes = to_bytes(make_crowded_level({ 64, 48 }, 100));
+
+		{
+			auto is = std::istringstream(std::string());
+			EXPECT_FALSE(read_level(is).has_value());
+		}
+
+		{
+			auto is = std::istringstream(bytes.substr(0, bytes.size() / 2));
+			EXPECT_FALSE(read_level(is).has_value());
+		}
+
+		{
+			auto corrupt = bytes;
+			corrupt[4] = '\x7F'; // version
+			auto is = std::istringstream(corrupt);
+			EXPECT_FALSE(read_level(is).has_value());
+		}
+	}
+
+} // rog
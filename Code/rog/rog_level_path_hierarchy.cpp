@@ -0,0 +1,555 @@
+#include "rog_level_path_hierarchy.hpp"
+
+#include <bump_die.hpp>
+#include <bump_range.hpp>
+#include <bump_trace.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		auto constexpr UNREACHABLE = std::numeric_limits<std::int32_t>::max();
+
+		// runs of crossable border tiles at least this long get a transition
+		// at each end, rather than one in the middle
+		auto constexpr LONG_RUN_LENGTH = std::int32_t{ 6 };
+
+		bool is_walkable(bit_grid const& walkable, glm::ivec2 pos)
+		{
+			return walkable.in_bounds(pos) && walkable.test(pos);
+		}
+
+		std::int32_t chebyshev_distance(glm::ivec2 a, glm::ivec2 b)
+		{
+			auto const d = glm::abs(a - b);
+			return glm::max(d.x, d.y);
+		}
+
+	} // unnamed
+
+	void path_hierarchy::build(bit_grid const& walkable, std::int32_t cluster_size)
+	{
+		bump::die_if(cluster_size <= 0);
+
+		m_extents = walkable.extents();
+		m_cluster_size = cluster_size;
+		m_cluster_count = (m_extents + (cluster_size - 1)) / cluster_size;
+
+		m_nodes.clear();
+		m_free_nodes.clear();
+
+		auto const cluster_total = std::size_t(m_cluster_count.x) * std::size_t(m_cluster_count.y);
+		m_east_borders.assign(cluster_total, { });
+		m_south_borders.assign(cluster_total, { });
+		m_corners.assign(cluster_total, { });
+
+		for (auto y : bump::range(0, m_cluster_count.y))
+		{
+			for (auto x : bump::range(0, m_cluster_count.x))
+			{
+				build_border(walkable, border_type::EAST, { x, y });
+				build_border(walkable, border_type::SOUTH, { x, y });
+				build_border(walkable, border_type::CORNER, { x, y });
+			}
+		}
+
+		for (auto y : bump::range(0, m_cluster_count.y))
+			for (auto x : bump::range(0, m_cluster_count.x))
+				build_cluster_edges(walkable, { x, y });
+	}
+
+	void path_hierarchy::clear()
+	{
+		m_extents = glm::ivec2(0);
+		m_cluster_size = 0;
+		m_cluster_count = glm::ivec2(0);
+
+		m_nodes.clear();
+		m_free_nodes.clear();
+		m_east_borders.clear();
+		m_south_borders.clear();
+		m_corners.clear();
+	}
+
+	void path_hierarchy::update_tile(bit_grid const& walkable, glm::ivec2 pos)
+	{
+		if (!is_built_for(walkable))
+			return;
+
+		auto const cluster = cluster_coords(pos);
+		auto const local = pos - cluster_origin(cluster);
+		auto const extents = cluster_extents(cluster);
+
+		// clusters with an edge to a node on a rebuilt border must be rebuilt too
+		auto affected = std::vector<glm::ivec2>{ cluster };
+
+		auto const rebuild = [&] (border_type type, glm::ivec2 border_cluster, std::initializer_list<glm::ivec2> clusters)
+		{
+			build_border(walkable, type, border_cluster);
+
+			for (auto c : clusters)
+				if (std::find(affected.begin(), affected.end(), c) == affected.end())
+					affected.push_back(c);
+		};
+
+		if (local.x == extents.x - 1 && cluster.x + 1 < m_cluster_count.x)
+			rebuild(border_type::EAST, cluster, { cluster + glm::ivec2{ 1, 0 } });
+
+		if (local.x == 0 && cluster.x > 0)
+			rebuild(border_type::EAST, cluster - glm::ivec2{ 1, 0 }, { cluster - glm::ivec2{ 1, 0 } });
+
+		if (local.y == extents.y - 1 && cluster.y + 1 < m_cluster_count.y)
+			rebuild(border_type::SOUTH, cluster, { cluster + glm::ivec2{ 0, 1 } });
+
+		if (local.y == 0 && cluster.y > 0)
+			rebuild(border_type::SOUTH, cluster - glm::ivec2{ 0, 1 }, { cluster - glm::ivec2{ 0, 1 } });
+
+		// the corner of four clusters depends on all four corner tiles
+		for (auto offset : { glm::ivec2{ 0, 0 }, glm::ivec2{ 1, 0 }, glm::ivec2{ 0, 1 }, glm::ivec2{ 1, 1 } })
+		{
+			auto const corner = cluster - offset;
+
+			if (corner.x < 0 || corner.y < 0 || corner.x + 1 >= m_cluster_count.x || corner.y + 1 >= m_cluster_count.y)
+				continue;
+
+			auto const corner_pos = cluster_origin(corner) + cluster_extents(corner) - 1;
+
+			if (pos != corner_pos + offset)
+				continue;
+
+			rebuild(border_type::CORNER, corner, { corner, corner + glm::ivec2{ 1, 0 }, corner + glm::ivec2{ 0, 1 }, corner + glm::ivec2{ 1, 1 } });
+		}
+
+		for (auto c : affected)
+			build_cluster_edges(walkable, c);
+	}
+
+	std::vector<path_hierarchy::node_id>& path_hierarchy::get_border(border_type type, glm::ivec2 cluster)
+	{
+		auto const index = cluster_index(cluster);
+
+		switch (type)
+		{
+		case border_type::EAST:   return m_east_borders[index];
+		case border_type::SOUTH:  return m_south_borders[index];
+		case border_type::CORNER: return m_corners[index];
+		}
+
+		bump::die();
+	}
+
+	void path_hierarchy::build_border(bit_grid const& walkable, border_type type, glm::ivec2 cluster)
+	{
+		auto& border = get_border(type, cluster);
+
+		for (auto id : border)
+		{
+			m_nodes[id].m_live = false;
+			m_nodes[id].m_edges.clear();
+			m_free_nodes.push_back(id);
+		}
+
+		border.clear();
+
+		auto const has_east = (cluster.x + 1 < m_cluster_count.x);
+		auto const has_south = (cluster.y + 1 < m_cluster_count.y);
+		auto const origin = cluster_origin(cluster);
+		auto const extents = cluster_extents(cluster);
+
+		if (type == border_type::CORNER)
+		{
+			if (!has_east || !has_south)
+				return;
+
+			// a diagonal step is the only way across the corner if neither of
+			// the other two tiles can be walked through
+			auto const a = origin + extents - 1;
+			auto const b = a + glm::ivec2{ 1, 0 };
+			auto const c = a + glm::ivec2{ 0, 1 };
+			auto const d = a + glm::ivec2{ 1, 1 };
+
+			auto const walk_a = is_walkable(walkable, a);
+			auto const walk_b = is_walkable(walkable, b);
+			auto const walk_c = is_walkable(walkable, c);
+			auto const walk_d = is_walkable(walkable, d);
+
+			if (walk_a && walk_d && !walk_b && !walk_c)
+				add_transition(border, a, d);
+
+			if (walk_b && walk_c && !walk_a && !walk_d)
+				add_transition(border, b, c);
+
+			return;
+		}
+
+		if ((type == border_type::EAST && !has_east) || (type == border_type::SOUTH && !has_south))
+			return;
+
+		// tile pairs a[i] (in this cluster) and b[i] (in the next) straddle the border
+		auto const step = (type == border_type::EAST ? glm::ivec2{ 0, 1 } : glm::ivec2{ 1, 0 });
+		auto const a0 = (type == border_type::EAST ? glm::ivec2{ origin.x + extents.x - 1, origin.y } : glm::ivec2{ origin.x, origin.y + extents.y - 1 });
+		auto const b0 = a0 + glm::ivec2{ step.y, step.x };
+		auto const length = (type == border_type::EAST ? extents.y : extents.x);
+
+		auto const a = [&] (std::int32_t i) { return a0 + step * i; };
+		auto const b = [&] (std::int32_t i) { return b0 + step * i; };
+		auto const crossable = [&] (std::int32_t i) { return is_walkable(walkable, a(i)) && is_walkable(walkable, b(i)); };
+
+		// runs of straight crossings
+		auto run_start = std::int32_t{ -1 };
+
+		for (auto i : bump::range(0, length + 1))
+		{
+			auto const open = (i != length && crossable(i));
+
+			if (open && run_start == -1)
+				run_start = i;
+
+			if (open || run_start == -1)
+				continue;
+
+			auto const run_length = i - run_start;
+
+			if (run_length < LONG_RUN_LENGTH)
+			{
+				auto const mid = run_start + run_length / 2;
+				add_transition(border, a(mid), b(mid));
+			}
+			else
+			{
+				add_transition(border, a(run_start), b(run_start));
+				add_transition(border, a(i - 1), b(i - 1));
+			}
+
+			run_start = -1;
+		}
+
+		// diagonal crossings that aren't next to a straight crossing
+		for (auto i : bump::range(0, length - 1))
+		{
+			auto const walk_a0 = is_walkable(walkable, a(i));
+			auto const walk_a1 = is_walkable(walkable, a(i + 1));
+			auto const walk_b0 = is_walkable(walkable, b(i));
+			auto const walk_b1 = is_walkable(walkable, b(i + 1));
+
+			if (walk_a0 && walk_b1 && !walk_b0 && !walk_a1)
+				add_transition(border, a(i), b(i + 1));
+
+			if (walk_a1 && walk_b0 && !walk_a0 && !walk_b1)
+				add_transition(border, a(i + 1), b(i));
+		}
+	}
+
+	void path_hierarchy::add_transition(std::vector<node_id>& border, glm::ivec2 a, glm::ivec2 b)
+	{
+		auto const a_id = add_node(a, -1);
+		auto const b_id = add_node(b, a_id);
+		m_nodes[a_id].m_partner = b_id;
+
+		border.push_back(a_id);
+		border.push_back(b_id);
+	}
+
+	path_hierarchy::node_id path_hierarchy::add_node(glm::ivec2 pos, node_id partner)
+	{
+		auto n = node{ pos, cluster_index(cluster_coords(pos)), partner, { }, true };
+
+		if (m_free_nodes.empty())
+		{
+			m_nodes.push_back(std::move(n));
+			return node_id(m_nodes.size() - 1);
+		}
+
+		auto const id = m_free_nodes.back();
+		m_free_nodes.pop_back();
+		m_nodes[id] = std::move(n);
+
+		return id;
+	}
+
+	void path_hierarchy::gather_cluster_nodes(glm::ivec2 cluster, std::vector<node_id>& nodes) const
+	{
+		nodes.clear();
+
+		auto const index = cluster_index(cluster);
+
+		auto const gather = [&] (std::vector<std::vector<node_id>> const& borders, glm::ivec2 border_cluster)
+		{
+			if (border_cluster.x < 0 || border_cluster.y < 0)
+				return;
+
+			for (auto id : borders[cluster_index(border_cluster)])
+				if (m_nodes[id].m_cluster == index)
+					nodes.push_back(id);
+		};
+
+		gather(m_east_borders, cluster);
+		gather(m_east_borders, cluster - glm::ivec2{ 1, 0 });
+		gather(m_south_borders, cluster);
+		gather(m_south_borders, cluster - glm::ivec2{ 0, 1 });
+		gather(m_corners, cluster);
+		gather(m_corners, cluster - glm::ivec2{ 1, 0 });
+		gather(m_corners, cluster - glm::ivec2{ 0, 1 });
+		gather(m_corners, cluster - glm::ivec2{ 1, 1 });
+	}
+
+	void path_hierarchy::build_cluster_edges(bit_grid const& walkable, glm::ivec2 cluster)
+	{
+		gather_cluster_nodes(cluster, m_cluster_nodes);
+
+		for (auto id : m_cluster_nodes)
+		{
+			auto& n = m_nodes[id];
+			n.m_edges.clear();
+
+			flood_cluster(walkable, cluster, n.m_pos);
+
+			for (auto other : m_cluster_nodes)
+			{
+				if (other == id)
+					continue;
+
+				auto const distance = cluster_distance(cluster, m_nodes[other].m_pos);
+
+				if (distance != UNREACHABLE)
+					n.m_edges.push_back({ other, distance });
+			}
+		}
+	}
+
+	void path_hierarchy::flood_cluster(bit_grid const& walkable, glm::ivec2 cluster, glm::ivec2 src)
+	{
+		auto const origin = cluster_origin(cluster);
+		auto const extents = cluster_extents(cluster);
+
+		auto const to_local = [&] (glm::ivec2 pos) { auto const l = pos - origin; return l.y * extents.x + l.x; };
+
+		m_cluster_distances.assign(std::size_t(extents.x) * std::size_t(extents.y), UNREACHABLE);
+		m_cluster_parents.assign(m_cluster_distances.size(), -1);
+		m_cluster_queue.clear();
+
+		m_cluster_distances[to_local(src)] = 0;
+		m_cluster_queue.push_back(to_local(src));
+
+		for (auto front = std::size_t{ 0 }; front != m_cluster_queue.size(); ++front)
+		{
+			auto const current = m_cluster_queue[front];
+			auto const current_pos = origin + glm::ivec2{ current % extents.x, current / extents.x };
+			auto const next_distance = m_cluster_distances[current] + 1;
+
+			for (auto y : { -1, 0, 1 })
+			{
+				for (auto x : { -1, 0, 1 })
+				{
+					auto const next_local = current_pos - origin + glm::ivec2{ x, y };
+
+					if (next_local.x < 0 || next_local.y < 0 || next_local.x >= extents.x || next_local.y >= extents.y)
+						continue;
+
+					auto const next = next_local.y * extents.x + next_local.x;
+
+					if (m_cluster_distances[next] != UNREACHABLE || !is_walkable(walkable, origin + next_local))
+						continue;
+
+					m_cluster_distances[next] = next_distance;
+					m_cluster_parents[next] = current;
+					m_cluster_queue.push_back(next);
+				}
+			}
+		}
+	}
+
+	path_hierarchy::cost_t path_hierarchy::cluster_distance(glm::ivec2 cluster, glm::ivec2 pos) const
+	{
+		auto const local = pos - cluster_origin(cluster);
+		return m_cluster_distances[local.y * cluster_extents(cluster).x + local.x];
+	}
+
+	bool path_hierarchy::find_abstract_path(bit_grid const& walkable, glm::ivec2 src, glm::ivec2 dst, std::vector<glm::ivec2>& waypoints)
+	{
+		bump::die_if(!is_built_for(walkable));
+		bump::die_if(!glm::all(glm::greaterThanEqual(src, glm::ivec2(0))) || !glm::all(glm::lessThan(src, m_extents)));
+		bump::die_if(!glm::all(glm::greaterThanEqual(dst, glm::ivec2(0))) || !glm::all(glm::lessThan(dst, m_extents)));
+
+		waypoints.clear();
+
+		if (src == dst)
+			return true;
+
+		if (!is_walkable(walkable, dst))
+			return false;
+
+		auto const src_cluster = cluster_coords(src);
+		auto const dst_cluster = cluster_coords(dst);
+
+		m_src_distances.assign(m_nodes.size(), UNREACHABLE);
+		m_dst_distances.assign(m_nodes.size(), UNREACHABLE);
+
+		// connect the start and end points to the nodes in their clusters
+		flood_cluster(walkable, src_cluster, src);
+
+		if (src_cluster == dst_cluster && cluster_distance(src_cluster, dst) != UNREACHABLE)
+		{
+			waypoints.push_back(dst);
+			return true;
+		}
+
+		gather_cluster_nodes(src_cluster, m_cluster_nodes);
+
+		for (auto id : m_cluster_nodes)
+			m_src_distances[id] = cluster_distance(src_cluster, m_nodes[id].m_pos);
+
+		flood_cluster(walkable, dst_cluster, dst);
+		gather_cluster_nodes(dst_cluster, m_cluster_nodes);
+
+		for (auto id : m_cluster_nodes)
+			m_dst_distances[id] = cluster_distance(dst_cluster, m_nodes[id].m_pos);
+
+		// a* over the abstract graph, with a virtual node for dst
+		auto const dst_id = node_id(m_nodes.size());
+
+		m_search_costs.assign(m_nodes.size() + 1, UNREACHABLE);
+		m_search_parents.assign(m_nodes.size() + 1, -1);
+		m_search_frontier.clear();
+
+		auto const heuristic = [&] (node_id id) { return id == dst_id ? 0 : chebyshev_distance(m_nodes[id].m_pos, dst); };
+		auto constexpr frontier_order = std::greater<std::pair<cost_t, node_id>>();
+
+		auto const relax = [&] (node_id id, cost_t cost, node_id parent)
+		{
+			if (cost >= m_search_costs[id])
+				return;
+
+			m_search_costs[id] = cost;
+			m_search_parents[id] = parent;
+
+			m_search_frontier.push_back({ cost + heuristic(id), id });
+			std::push_heap(m_search_frontier.begin(), m_search_frontier.end(), frontier_order);
+		};
+
+		for (auto id : bump::indices(m_src_distances))
+			if (m_src_distances[id] != UNREACHABLE)
+				relax(node_id(id), m_src_distances[id], -1);
+
+		auto found = false;
+
+		while (!m_search_frontier.empty())
+		{
+			std::pop_heap(m_search_frontier.begin(), m_search_frontier.end(), frontier_order);
+			auto const [f, current] = m_search_frontier.back();
+			m_search_frontier.pop_back();
+
+			if (f != m_search_costs[current] + heuristic(current))
+				continue; // stale
+
+			if (current == dst_id)
+			{
+				found = true;
+				break;
+			}
+
+			auto const& n = m_nodes[current];
+			auto const cost = m_search_costs[current];
+
+			for (auto const& e : n.m_edges)
+				relax(e.m_node, cost + e.m_cost, current);
+
+			relax(n.m_partner, cost + 1, current);
+
+			if (m_dst_distances[current] != UNREACHABLE)
+				relax(dst_id, cost + m_dst_distances[current], current);
+		}
+
+		if (!found)
+			return false;
+
+		waypoints.push_back(dst);
+
+		for (auto id = m_search_parents[dst_id]; id != -1; id = m_search_parents[id])
+			if (m_nodes[id].m_pos != waypoints.back())
+				waypoints.push_back(m_nodes[id].m_pos);
+
+		if (waypoints.back() == src)
+			waypoints.pop_back();
+
+		return true;
+	}
+
+	bool path_hierarchy::refine_segment(bit_grid const& walkable, glm::ivec2 from, glm::ivec2 to, std::vector<glm::ivec2>& path)
+	{
+		bump::die_if(!is_built_for(walkable));
+
+		path.clear();
+
+		if (from == to)
+			return true;
+
+		if (!is_walkable(walkable, to))
+			return false;
+
+		if (chebyshev_distance(from, to) == 1)
+		{
+			path.push_back(to);
+			return true;
+		}
+
+		auto const cluster = cluster_coords(from);
+		bump::die_if(cluster_coords(to) != cluster); // not consecutive waypoints
+
+		flood_cluster(walkable, cluster, from);
+
+		if (cluster_distance(cluster, to) == UNREACHABLE)
+			return false;
+
+		auto const origin = cluster_origin(cluster);
+		auto const extents = cluster_extents(cluster);
+		auto const to_local = [&] (glm::ivec2 pos) { auto const l = pos - origin; return l.y * extents.x + l.x; };
+
+		for (auto current = to_local(to); current != to_local(from); current = m_cluster_parents[current])
+			path.push_back(origin + glm::ivec2{ current % extents.x, current / extents.x });
+
+		return true;
+	}
+
+	bool path_hierarchy::find_path(bit_grid const& walkable, glm::ivec2 src, glm::ivec2 dst, std::vector<glm::ivec2>& path)
+	{
+		auto const zone = bump::trace::zone("path_hierarchy::find_path");
+
+		path.clear();
+
+		auto waypoints = std::vector<glm::ivec2>();
+
+		if (!find_abstract_path(walkable, src, dst, waypoints))
+			return false;
+
+		// waypoints (and refined segments) are in reverse order, so build the
+		// path forwards and reverse it at the end
+		auto from = src;
+
+		while (!waypoints.empty())
+		{
+			auto const to = waypoints.back();
+			waypoints.pop_back();
+
+			if (!refine_segment(walkable, from, to, m_segment))
+			{
+				path.clear();
+				return false;
+			}
+
+			path.insert(path.end(), m_segment.rbegin(), m_segment.rend());
+			from = to;
+		}
+
+		std::reverse(path.begin(), path.end());
+
+		return true;
+	}
+
+} // rog
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "rog_bit_grid.hpp"
+
+#include <bump_math.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace rog
+{
+
+	/* path_hierarchy
+	 *
+	 * Hierarchical pathfinding (HPA*) for large levels.
+	 *
+	 * The grid is divided into square clusters. Where a walkable run of
+	 * tiles crosses the border between two clusters, a transition is placed
+	 * (one in the middle of a short run, one at each end of a long one). A
+	 * transition is a pair of nodes, one on each side of the border, joined
+	 * by a single step. Nodes in the same cluster are joined by edges
+	 * weighted with their walking distance inside that cluster.
+	 *
+	 * Queries search this much smaller abstract graph, giving a list of
+	 * waypoints. Each pair of consecutive waypoints is either a single step,
+	 * or lies inside one cluster, so it can be refined into steps with a
+	 * small local search when (and if) it is actually needed.
+	 *
+	 * When a tile changes, only the transitions on the borders it touches,
+	 * and the intra-cluster edges of the clusters on either side of those
+	 * borders, are rebuilt.
+	 *
+	 * Paths found this way are not always optimal, but are usually close.
+	 *
+	 */
+	class path_hierarchy
+	{
+	public:
+
+		static constexpr std::int32_t DEFAULT_CLUSTER_SIZE = 16;
+
+		void build(bit_grid const& walkable, std::int32_t cluster_size = DEFAULT_CLUSTER_SIZE);
+		bool is_built_for(bit_grid const& walkable) const { return m_cluster_size != 0 && walkable.extents() == m_extents; }
+		void clear(); // until it's built again
+
+		/* update_tile()
+		 *
+		 * Repairs the hierarchy after the walkability of the tile at `pos`
+		 * has changed in `walkable`.
+		 *
+		 */
+		void update_tile(bit_grid const& walkable, glm::ivec2 pos);
+
+		/* find_abstract_path()
+		 *
+		 * Finds a list of waypoints from `src` to `dst`, in reverse order
+		 * (`dst` first, `src` excluded). Returns false if there is no path.
+		 * `src` is assumed to be walkable (i.e. an actor's position).
+		 *
+		 */
+		bool find_abstract_path(bit_grid const& walkable, glm::ivec2 src, glm::ivec2 dst, std::vector<glm::ivec2>& waypoints);
+
+		/* refine_segment()
+		 *
+		 * Finds the steps between two consecutive waypoints, in reverse
+		 * order (`to` first, `from` excluded), in the same format as
+		 * find_path(). Returns false if there is no path (i.e. the level has
+		 * changed since the waypoints were found).
+		 *
+		 */
+		bool refine_segment(bit_grid const& walkable, glm::ivec2 from, glm::ivec2 to, std::vector<glm::ivec2>& path);
+
+		// finds the abstract path and refines all of it
+		bool find_path(bit_grid const& walkable, glm::ivec2 src, glm::ivec2 dst, std::vector<glm::ivec2>& path);
+
+		std::int32_t cluster_size() const { return m_cluster_size; }
+		glm::ivec2 cluster_count() const { return m_cluster_count; }
+		std::size_t node_count() const { return m_nodes.size() - m_free_nodes.size(); }
+
+	private:
+
+		using node_id = std::int32_t;
+		using cost_t = std::int32_t;
+
+		struct edge
+		{
+			node_id m_node;
+			cost_t m_cost;
+		};
+
+		struct node
+		{
+			glm::ivec2 m_pos;
+			std::int32_t m_cluster;
+			node_id m_partner; // the node on the other side of the border
+			std::vector<edge> m_edges; // to the other nodes in the same cluster
+			bool m_live;
+		};
+
+		// transitions between clusters are stored per border (and per corner,
+		// for the rare diagonal-only crossings) so a border can be rebuilt on
+		// its own. borders and corners are indexed by the cluster to their
+		// left / above.
+		enum class border_type { EAST, SOUTH, CORNER };
+
+		std::int32_t cluster_index(glm::ivec2 cluster) const { return cluster.y * m_cluster_count.x + cluster.x; }
+		glm::ivec2 cluster_coords(glm::ivec2 pos) const { return pos / m_cluster_size; }
+		glm::ivec2 cluster_origin(glm::ivec2 cluster) const { return cluster * m_cluster_size; }
+		glm::ivec2 cluster_extents(glm::ivec2 cluster) const { return glm::min(glm::ivec2(m_cluster_size), m_extents - cluster_origin(cluster)); }
+
+		std::vector<node_id>& get_border(border_type type, glm::ivec2 cluster);
+		void build_border(bit_grid const& walkable, border_type type, glm::ivec2 cluster);
+		void add_transition(std::vector<node_id>& border, glm::ivec2 a, glm::ivec2 b);
+		node_id add_node(glm::ivec2 pos, node_id partner);
+
+		void gather_cluster_nodes(glm::ivec2 cluster, std::vector<node_id>& nodes) const;
+		void build_cluster_edges(bit_grid const& walkable, glm::ivec2 cluster);
+
+		// breadth-first search limited to one cluster (distances stored in m_cluster_distances)
+		void flood_cluster(bit_grid const& walkable, glm::ivec2 cluster, glm::ivec2 src);
+		cost_t cluster_distance(glm::ivec2 cluster, glm::ivec2 pos) const;
+
+		glm::ivec2 m_extents = glm::ivec2(0);
+		std::int32_t m_cluster_size = 0;
+		glm::ivec2 m_cluster_count = glm::ivec2(0);
+
+		std::vector<node> m_nodes;
+		std::vector<node_id> m_free_nodes;
+		std::vector<std::vector<node_id>> m_east_borders;
+		std::vector<std::vector<node_id>> m_south_borders;
+		std::vector<std::vector<node_id>> m_corners;
+
+		// reusable search state
+		std::vector<cost_t> m_cluster_distances;
+		std::vector<std::int32_t> m_cluster_parents;
+		std::vector<std::int32_t> m_cluster_queue;
+		std::vector<node_id> m_cluster_nodes;
+		std::vector<cost_t> m_src_distances;
+		std::vector<cost_t> m_dst_distances;
+		std::vector<cost_t> m_search_costs;
+		std::vector<node_id> m_search_parents;
+		std::vector<std::pair<cost_t, node_id>> m_search_frontier;
+		std::vector<glm::ivec2> m_segment;
+	};
+
+} // rog
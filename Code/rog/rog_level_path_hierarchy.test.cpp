@@ -0,0 +1,216 @@
+#include "rog_level_path_hierarchy.hpp"
+
+#include "rog_bit_grid.hpp"
+#include "rog_random.hpp"
+
+#include <bump_range.hpp>
+
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <queue>
+#include <vector>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		bit_grid make_random_map(random::rng_t& rng, glm::ivec2 size, float wall_chance)
+		{
+			auto walkable = bit_grid(size, true);
+
+			for (auto y : bump::range(0, size.y))
+				for (auto x : bump::range(0, size.x))
+					if (random::rand_01<float>(rng) < wall_chance)
+						walkable.set({ x, y }, false);
+
+			return walkable;
+		}
+
+		glm::ivec2 random_walkable_tile(random::rng_t& rng, bit_grid const& walkable)
+		{
+			while (true)
+			{
+				auto const p = random::rand_range(rng, glm::ivec2(0), walkable.extents() - 1);
+
+				if (walkable.test(p))
+					return p;
+			}
+		}
+
+		// the path is stored destination first, so check it from the back
+		bool is_valid_path(bit_grid const& walkable, glm::ivec2 src, glm::ivec2 dst, std::vector<glm::ivec2> const& path)
+		{
+			if (src == dst)
+				return path.empty();
+
+			if (path.empty() || path.front() != dst)
+				return false;
+
+			auto current = src;
+
+			for (auto i = path.rbegin(); i != path.rend(); ++i)
+			{
+				auto const d = glm::abs(*i - current);
+
+				if (glm::max(d.x, d.y) != 1)
+					return false;
+
+				if (!walkable.test(*i))
+					return false;
+
+				current = *i;
+			}
+
+			return true;
+		}
+
+		// a breadth first search (every step costs 1)
+		std::optional<std::size_t> shortest_path_length(bit_grid const& walkable, glm::ivec2 src, glm::ivec2 dst)
+		{
+			auto const size = walkable.extents();
+			auto const to_index = [&] (glm::ivec2 p) { return std::size_t(p.y) * std::size_t(size.x) + std::size_t(p.x); };
+
+			auto distances = std::vector<std::optional<std::size_t>>(std::size_t(size.x) * std::size_t(size.y));
+			auto open = std::queue<glm::ivec2>();
+
+			distances[to_index(src)] = 0;
+			open.push(src);
+
+			while (!open.empty())
+			{
+				auto const current = open.front();
+				open.pop();
+
+				if (current == dst)
+					return distances[to_index(current)];
+
+				for (auto const& offset : bit_grid::neighbour_offsets)
+				{
+					auto const next = current + offset;
+
+					if (!walkable.in_bounds(next) || !walkable.test(next) || distances[to_index(next)].has_value())
+						continue;
+
+					distances[to_index(next)] = distances[to_index(current)].value() + 1;
+					open.push(next);
+				}
+			}
+
+			return std::nullopt;
+		}
+
+		void check_queries(random::rng_t& rng, bit_grid const& walkable, path_hierarchy& hierarchy, std::int32_t queries)
+		{
+			auto path = std::vector<glm::ivec2>();
+
+			for (auto query : bump::range(0, queries))
+			{
+				auto const src = random_walkable_tile(rng, walkable);
+				auto const dst = random::rand_range(rng, glm::ivec2(0), walkable.extents() - 1);
+
+				SCOPED_TRACE(testing::Message() << "query " << query << ": " << src.x << ", " << src.y << " to " << dst.x << ", " << dst.y);
+
+				auto const found = hierarchy.find_path(walkable, src, dst, path);
+				auto const shortest = shortest_path_length(walkable, src, dst);
+
+				// a path is found exactly when one exists
+				EXPECT_EQ(found, shortest.has_value());
+
+				if (!found || !shortest.has_value())
+					continue;
+
+				// every step is to an adjacent, walkable tile (the path isn't always optimal, but can't be shorter)
+				EXPECT_TRUE(is_valid_path(walkable, src, dst, path));
+				EXPECT_GE(path.size(), shortest.value());
+			}
+		}
+
+	} // unnamed
+
+	TEST(Test_rog_level_path_hierarchy, finds_paths_on_random_maps)
+	{
+		auto rng = random::rng_t(23456);
+		auto hierarchy = path_hierarchy();
+
+		for (auto cluster_size : { 3, 4, 7, 8, 16 })
+		{
+			for (auto map : bump::range(0, 20))
+			{
+				auto const size = random::rand_range(rng, glm::ivec2(2), glm::ivec2(40));
+				auto const walkable = make_random_map(rng, size, random::rand_range(rng, 0.f, 0.45f));
+
+				SCOPED_TRACE(testing::Message() << "cluster size " << cluster_size << ", map " << map);
+
+				hierarchy.build(walkable, cluster_size);
+				check_queries(rng, walkable, hierarchy, 10);
+			}
+		}
+	}
+
+	TEST(Test_rog_level_path_hierarchy, update_tile_matches_rebuild)
+	{
+		auto rng = random::rng_t(34567);
+		auto updated = path_hierarchy();
+		auto rebuilt = path_hierarchy();
+
+		auto updated_path = std::vector<glm::ivec2>();
+		auto rebuilt_path = std::vector<glm::ivec2>();
+
+		for (auto cluster_size : { 4, 5, 8 })
+		{
+			for (auto map : bump::range(0, 10))
+			{
+				auto const size = random::rand_range(rng, glm::ivec2(4), glm::ivec2(40));
+				auto walkable = make_random_map(rng, size, random::rand_range(rng, 0.1f, 0.4f));
+
+				updated.build(walkable, cluster_size);
+
+				for (auto change : bump::range(0, 30))
+				{
+					auto const p = random::rand_range(rng, glm::ivec2(0), size - 1);
+					walkable.set(p, !walkable.test(p));
+					updated.update_tile(walkable, p);
+
+					if (walkable.count() == 0)
+						continue;
+
+					SCOPED_TRACE(testing::Message() << "cluster size " << cluster_size << ", map " << map << ", change " << change);
+
+					rebuilt.build(walkable, cluster_size);
+					EXPECT_EQ(updated.node_count(), rebuilt.node_count());
+
+					check_queries(rng, walkable, updated, 3);
+
+					// the repaired hierarchy finds a path whenever a fresh one does
+					for (auto query : bump::range(0, 3))
+					{
+						auto const src = random_walkable_tile(rng, walkable);
+						auto const dst = random::rand_range(rng, glm::ivec2(0), size - 1);
+
+						SCOPED_TRACE(testing::Message() << "comparison " << query);
+
+						auto const updated_found = updated.find_path(walkable, src, dst, updated_path);
+						auto const rebuilt_found = rebuilt.find_path(walkable, src, dst, rebuilt_path);
+
+						if (!shortest_path_length(walkable, src, dst).has_value())
+						{
+							EXPECT_FALSE(updated_found);
+							EXPECT_FALSE(rebuilt_found);
+							continue;
+						}
+
+						ASSERT_TRUE(updated_found);
+						ASSERT_TRUE(rebuilt_found);
+
+						EXPECT_TRUE(is_valid_path(walkable, src, dst, updated_path));
+						EXPECT_TRUE(is_valid_path(walkable, src, dst, rebuilt_path));
+					}
+				}
+			}
+		}
+	}
+
+} // rog
@@ -0,0 +1,290 @@
+#include "rog_level_path_replanner.hpp"
+
+#include "rog_level.hpp"
+
+#include <bump_die.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		auto constexpr neighbour_offsets = std::array<glm::ivec2, 8>
+		{
+			glm::ivec2{ -1, -1 }, glm::ivec2{  0, -1 }, glm::ivec2{ +1, -1 },
+			glm::ivec2{ -1,  0 },                       glm::ivec2{ +1,  0 },
+			glm::ivec2{ -1, +1 }, glm::ivec2{  0, +1 }, glm::ivec2{ +1, +1 },
+		};
+
+		bool in_bounds(glm::ivec2 coords, glm::ivec2 extents)
+		{
+			return coords.x >= 0 && coords.x < extents.x && coords.y >= 0 && coords.y < extents.y;
+		}
+
+		std::int32_t chebyshev_distance(glm::ivec2 a, glm::ivec2 b)
+		{
+			auto const d = glm::abs(a - b);
+			return glm::max(d.x, d.y);
+		}
+
+		auto constexpr frontier_order = [] (auto const& a, auto const& b) { return a.m_key > b.m_key; };
+
+	} // unnamed
+
+	bool path_replanner::plan(level const& level, glm::ivec2 src, glm::ivec2 dst)
+	{
+		bump::die_if(!level.in_bounds(src));
+		bump::die_if(!level.in_bounds(dst));
+
+		if (level.size() != m_extents)
+		{
+			m_extents = level.size();
+			m_generation = 0;
+			m_nodes.assign(std::size_t(m_extents.x) * std::size_t(m_extents.y), node());
+		}
+
+		next_generation();
+		m_frontier.clear();
+		m_changed.clear();
+
+		m_start = src;
+		m_last_start = src;
+		m_goal = dst;
+		m_key_modifier = 0;
+
+		auto& goal = get_node(to_index(dst));
+		goal.m_rhs = 0;
+		goal.m_key = calculate_key(goal, dst);
+		goal.m_queued = true;
+		frontier_push({ goal.m_key, to_index(dst) });
+
+		compute_shortest_path(level);
+
+		m_active = (get_node(to_index(src)).m_rhs != INFINITE_COST);
+
+		return m_active;
+	}
+
+	void path_replanner::tile_changed(glm::ivec2 pos)
+	{
+		if (!m_active)
+			return;
+
+		m_changed.push_back(pos);
+	}
+
+	std::optional<glm::ivec2> path_replanner::next_step(level const& level, glm::ivec2 current)
+	{
+		if (!m_active)
+			return { };
+
+		bump::die_if(level.size() != m_extents);
+
+		m_start = current;
+
+		if (m_start == m_goal)
+		{
+			reset();
+			return { };
+		}
+
+		if (!m_changed.empty())
+		{
+			// the start has moved since the keys in the frontier were
+			// calculated, so they are adjusted by the distance moved
+			m_key_modifier += chebyshev_distance(m_last_start, m_start);
+			m_last_start = m_start;
+
+			for (auto pos : m_changed)
+			{
+				update_node(level, pos);
+
+				for (auto offset : neighbour_offsets)
+					if (in_bounds(pos + offset, m_extents))
+						update_node(level, pos + offset);
+			}
+
+			m_changed.clear();
+
+			compute_shortest_path(level);
+		}
+
+		auto best = INFINITE_COST;
+		auto best_pos = m_start;
+
+		for (auto offset : neighbour_offsets)
+		{
+			auto const next = m_start + offset;
+
+			if (!in_bounds(next, m_extents))
+				continue;
+
+			auto const cost = step_cost(level, m_start, next) + get_node(to_index(next)).m_g;
+
+			if (cost < best)
+			{
+				best = cost;
+				best_pos = next;
+			}
+		}
+
+		if (best >= INFINITE_COST)
+		{
+			reset();
+			return { };
+		}
+
+		return best_pos;
+	}
+
+	void path_replanner::next_generation()
+	{
+		if (++m_generation != 0)
+			return;
+
+		// generation counter wrapped: reset the stamps so stale nodes aren't
+		// mistaken for visited ones
+		for (auto& n : m_nodes)
+			n.m_generation = 0;
+
+		m_generation = 1;
+	}
+
+	path_replanner::node& path_replanner::get_node(index_t index)
+	{
+		auto& n = m_nodes[index];
+
+		if (n.m_generation != m_generation)
+			n = { m_generation, INFINITE_COST, INFINITE_COST, { }, false };
+
+		return n;
+	}
+
+	bool path_replanner::is_blocked(level const& level, glm::ivec2 pos) const
+	{
+		if (!level.is_walkable(pos))
+			return true;
+
+		auto const actor = level.m_actors.at(pos);
+
+		return (actor != entt::null && actor != level.m_player);
+	}
+
+	path_replanner::cost_t path_replanner::step_cost(level const& level, glm::ivec2 from, glm::ivec2 to) const
+	{
+		return (is_blocked(level, from) || is_blocked(level, to)) ? INFINITE_COST : 1;
+	}
+
+	path_replanner::key path_replanner::calculate_key(node const& n, glm::ivec2 pos) const
+	{
+		auto const cost = std::min(n.m_g, n.m_rhs);
+
+		if (cost >= INFINITE_COST)
+			return { INFINITE_COST, INFINITE_COST };
+
+		return { cost + chebyshev_distance(m_start, pos) + m_key_modifier, cost };
+	}
+
+	void path_replanner::update_node(level const& level, glm::ivec2 pos)
+	{
+		auto& n = get_node(to_index(pos));
+
+		if (pos != m_goal)
+		{
+			n.m_rhs = INFINITE_COST;
+
+			for (auto offset : neighbour_offsets)
+			{
+				auto const next = pos + offset;
+
+				if (!in_bounds(next, m_extents))
+					continue;
+
+				auto const cost = step_cost(level, pos, next);
+				auto const g = get_node(to_index(next)).m_g;
+
+				if (cost < INFINITE_COST && g < INFINITE_COST)
+					n.m_rhs = std::min(n.m_rhs, cost + g);
+			}
+		}
+
+		// any previous frontier entry for this node is now stale
+		n.m_queued = (n.m_g != n.m_rhs);
+
+		if (n.m_queued)
+		{
+			n.m_key = calculate_key(n, pos);
+			frontier_push({ n.m_key, to_index(pos) });
+		}
+	}
+
+	void path_replanner::compute_shortest_path(level const& level)
+	{
+		auto const start_index = to_index(m_start);
+
+		while (!m_frontier.empty())
+		{
+			auto const top = m_frontier.front();
+			auto& u = get_node(top.m_index);
+
+			if (!u.m_queued || u.m_key != top.m_key)
+			{
+				frontier_pop(); // stale
+				continue;
+			}
+
+			auto const& start = get_node(start_index);
+
+			if (!(top.m_key < calculate_key(start, m_start) || start.m_rhs > start.m_g))
+				break;
+
+			frontier_pop();
+
+			auto const pos = to_coords(top.m_index);
+			auto const new_key = calculate_key(u, pos);
+
+			if (top.m_key < new_key)
+			{
+				u.m_key = new_key;
+				frontier_push({ new_key, top.m_index });
+			}
+			else if (u.m_g > u.m_rhs)
+			{
+				u.m_g = u.m_rhs;
+				u.m_queued = false;
+
+				for (auto offset : neighbour_offsets)
+					if (in_bounds(pos + offset, m_extents))
+						update_node(level, pos + offset);
+			}
+			else
+			{
+				u.m_g = INFINITE_COST;
+				update_node(level, pos);
+
+				for (auto offset : neighbour_offsets)
+					if (in_bounds(pos + offset, m_extents))
+						update_node(level, pos + offset);
+			}
+		}
+	}
+
+	void path_replanner::frontier_push(frontier_entry entry)
+	{
+		m_frontier.push_back(entry);
+		std::push_heap(m_frontier.begin(), m_frontier.end(), frontier_order);
+	}
+
+	path_replanner::frontier_entry path_replanner::frontier_pop()
+	{
+		std::pop_heap(m_frontier.begin(), m_frontier.end(), frontier_order);
+		auto const entry = m_frontier.back();
+		m_frontier.pop_back();
+		return entry;
+	}
+
+} // rog
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <bump_math.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace rog
+{
+
+	struct level;
+
+	/* path_replanner
+	 *
+	 * An incremental path search (D* Lite) that is kept alive while an actor
+	 * follows its path. When tiles change between steps, only the part of
+	 * the search affected by the change is repaired, rather than searching
+	 * again from scratch.
+	 *
+	 * The search runs backwards from the goal, so that the actor's position
+	 * can change without invalidating it. A tile is blocked if it can't be
+	 * walked through, or if another actor is standing in it (the player is
+	 * ignored, since it's the one following the path).
+	 *
+	 * Search state is stored in flat arrays with generation stamps, as in
+	 * pathfinding_workspace, so starting a new plan doesn't clear anything.
+	 *
+	 */
+	class path_replanner
+	{
+	public:
+
+		/* plan()
+		 *
+		 * Starts a new search from `src` to `dst`. Returns false if there is
+		 * no path (in which case the replanner is inactive).
+		 *
+		 */
+		bool plan(level const& level, glm::ivec2 src, glm::ivec2 dst);
+
+		/* tile_changed()
+		 *
+		 * Records that the tile at `pos` may have become blocked or unblocked.
+		 * The search is repaired the next time next_step() is called.
+		 *
+		 */
+		void tile_changed(glm::ivec2 pos);
+
+		/* next_step()
+		 *
+		 * Returns the next step from `current` towards the goal, after
+		 * repairing the search for any changed tiles. Returns nothing (and
+		 * becomes inactive) if the goal has been reached or can't be reached
+		 * any more.
+		 *
+		 */
+		std::optional<glm::ivec2> next_step(level const& level, glm::ivec2 current);
+
+		bool is_active() const { return m_active; }
+		glm::ivec2 goal() const { return m_goal; }
+		void reset() { m_active = false; m_changed.clear(); }
+
+	private:
+
+		using cost_t = std::int32_t;
+		using index_t = std::int32_t;
+
+		static constexpr cost_t INFINITE_COST = std::numeric_limits<cost_t>::max() / 2;
+
+		struct key
+		{
+			cost_t m_k1;
+			cost_t m_k2;
+
+			bool operator==(key const&) const = default;
+			auto operator<=>(key const&) const = default;
+		};
+
+		struct node
+		{
+			std::uint32_t m_generation = 0;
+			cost_t m_g = INFINITE_COST;
+			cost_t m_rhs = INFINITE_COST;
+			key m_key = { }; // the key this node was last queued with
+			bool m_queued = false;
+		};
+
+		struct frontier_entry
+		{
+			key m_key;
+			index_t m_index;
+		};
+
+		void next_generation();
+
+		node& get_node(index_t index);
+
+		index_t to_index(glm::ivec2 coords) const { return coords.y * m_extents.x + coords.x; }
+		glm::ivec2 to_coords(index_t index) const { return { index % m_extents.x, index / m_extents.x }; }
+
+		bool is_blocked(level const& level, glm::ivec2 pos) const;
+		cost_t step_cost(level const& level, glm::ivec2 from, glm::ivec2 to) const;
+
+		key calculate_key(node const& n, glm::ivec2 pos) const;
+		void update_node(level const& level, glm::ivec2 pos);
+		void compute_shortest_path(level const& level);
+
+		void frontier_push(frontier_entry entry);
+		frontier_entry frontier_pop();
+
+		glm::ivec2 m_extents = glm::ivec2(0);
+		std::uint32_t m_generation = 0;
+		std::vector<node> m_nodes;
+		std::vector<frontier_entry> m_frontier;
+
+		bool m_active = false;
+		glm::ivec2 m_start = glm::ivec2(0);
+		glm::ivec2 m_last_start = glm::ivec2(0);
+		glm::ivec2 m_goal = glm::ivec2(0);
+		cost_t m_key_modifier = 0; // "km" - accumulated as the start moves
+		std::vector<glm::ivec2> m_changed;
+	};
+
+} // rog
@@ -0,0 +1,159 @@
+#include "rog_level_path_replanner.hpp"
+
+#include "rog_ecs.hpp"
+#include "rog_level.hpp"
+#include "rog_level_gen.hpp"
+#include "rog_random.hpp"
+
+#include <bump_range.hpp>
+
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <queue>
+#include <vector>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		auto constexpr NO_PATH = std::int32_t{ -1 };
+
+		// the same rule as the replanner: monsters block, but the player doesn't
+		bool is_blocked(level const& level, glm::ivec2 pos)
+		{
+			auto const actor = level.m_actors.at(pos);
+			return !level.is_walkable(pos) || (actor != entt::null && actor != level.m_player);
+		}
+
+		// breadth first search from `goal` (every step costs 1)
+		std::vector<std::int32_t> distances_to(level const& level, glm::ivec2 goal)
+		{
+			auto const size = level.size();
+			auto const to_index = [&] (glm::ivec2 p) { return std::size_t(p.y) * std::size_t(size.x) + std::size_t(p.x); };
+
+			auto distances = std::vector<std::int32_t>(std::size_t(size.x) * std::size_t(size.y), NO_PATH);
+			auto open = std::queue<glm::ivec2>();
+
+			if (is_blocked(level, goal))
+				return distances;
+
+			distances[to_index(goal)] = 0;
+			open.push(goal);
+
+			while (!open.empty())
+			{
+				auto const current = open.front();
+				open.pop();
+
+				for (auto y : bump::range(-1, 2))
+				{
+					for (auto x : bump::range(-1, 2))
+					{
+						auto const next = current + glm::ivec2{ x, y };
+
+						if (!level.in_bounds(next) || is_blocked(level, next) || distances[to_index(next)] != NO_PATH)
+							continue;
+
+						distances[to_index(next)] = distances[to_index(current)] + 1;
+						open.push(next);
+					}
+				}
+			}
+
+			return distances;
+		}
+
+		glm::ivec2 random_open_tile(random::rng_t& rng, level const& level)
+		{
+			while (true)
+			{
+				auto const pos = random::rand_range(rng, glm::ivec2(0), level.size() - 1);
+
+				if (!is_blocked(level, pos) && !level.is_occupied(pos))
+					return pos;
+			}
+		}
+
+		void add_monsters(random::rng_t& rng, level& level, std::int32_t count)
+		{
+			for (auto i : bump::range(0, count))
+			{
+				(void)i;
+
+				auto const pos = random_open_tile(rng, level);
+				auto const monster = monster_create_entity(level.m_registry);
+				level.m_registry.get<c_position>(monster).m_pos = pos;
+				level.m_actors.set(pos, monster);
+			}
+		}
+
+	} // unnamed
+
+	TEST(Test_rog_level_path_replanner, follows_shortest_path_as_walls_appear)
+	{
+		auto rng = random::rng_t(45678);
+
+		for (auto trial : bump::range(0, 20))
+		{
+			auto level = level_gen::generate_level(0x5eed + trial, 2, { 48, 32 });
+			add_monsters(rng, level, 20);
+
+			auto current = random_open_tile(rng, level);
+			auto const goal = random_open_tile(rng, level);
+
+			auto const size = level.size();
+			auto const to_index = [&] (glm::ivec2 p) { return std::size_t(p.y) * std::size_t(size.x) + std::size_t(p.x); };
+
+			auto& replanner = level.m_path_replanner;
+			auto distances = distances_to(level, goal);
+
+			SCOPED_TRACE(testing::Message() << "trial " << trial);
+
+			EXPECT_EQ(replanner.plan(level, current, goal), distances[to_index(current)] != NO_PATH);
+
+			if (!replanner.is_active())
+				continue;
+
+			for (auto step : bump::range(0, 200))
+			{
+				SCOPED_TRACE(testing::Message() << "step " << step);
+
+				// wall off some tiles near the follower (set_feature() tells the replanner)
+				for (auto w : bump::range(0, 2))
+				{
+					(void)w;
+
+					auto const pos = glm::clamp(current + random::rand_range(rng, glm::ivec2(-3), glm::ivec2(3)), glm::ivec2(0), size - 1);
+
+					if (pos != current && pos != goal && level.is_walkable(pos))
+						level.set_feature(pos, features::wall);
+				}
+
+				distances = distances_to(level, goal);
+
+				auto const next = replanner.next_step(level, current);
+
+				// nothing once the goal is reached, or when it's been walled off
+				if (current == goal || distances[to_index(current)] == NO_PATH)
+				{
+					EXPECT_FALSE(next.has_value());
+					EXPECT_FALSE(replanner.is_active());
+					break;
+				}
+
+				ASSERT_TRUE(next.has_value());
+
+				auto const d = glm::abs(next.value() - current);
+				EXPECT_EQ(glm::max(d.x, d.y), 1);
+				EXPECT_FALSE(is_blocked(level, next.value()));
+				EXPECT_EQ(distances[to_index(next.value())], distances[to_index(current)] - 1);
+
+				current = next.value();
+			}
+		}
+	}
+
+} // rog
@@ -1,121 +1,378 @@
-#include "rog_level.hpp"
+#include "rog_level_pathfinding.hpp"
 
-#include "rog_feature.hpp"
+#include "rog_level.hpp"
 
+#include <bump_die.hpp>
 #include <bump_math.hpp>
+#include <bump_metrics.hpp>
+#include <bump_trace.hpp>
 
-#include <queue>
-#include <unordered_map>
+#include <algorithm>
+#include <bit>
 #include <vector>
 
 namespace rog
 {
 
-	bool is_walkable(bump::grid2<feature, glm::ivec2> const& grid, glm::ivec2 pos)
+	pathfinding_workspace::pathfinding_workspace(glm::ivec2 extents)
 	{
-		return !(grid.at(pos).m_flags & feature::flags::NO_WALK);
+		resize(extents);
 	}
 
-	bool in_bounds(glm::ivec2 coords, glm::ivec2 extents)
+	void pathfinding_workspace::resize(glm::ivec2 extents)
 	{
-		return (coords.x < extents.x && coords.y < extents.y);
+		bump::die_if(extents.x < 0 || extents.y < 0);
+
+		if (extents == m_extents)
+			return;
+
+		m_extents = extents;
+		m_generation = 0;
+		m_nodes.assign(std::size_t(extents.x) * std::size_t(extents.y), node());
 	}
 
-	bool in_bounds(glm::ivec2 coords, glm::ivec2 min, glm::ivec2 max)
+	void pathfinding_workspace::next_generation()
 	{
-		return coords.x >= min.x && coords.x < max.x && coords.y >= min.y && coords.y < max.y;
+		if (++m_generation != 0)
+			return;
+
+		// generation counter wrapped: reset the stamps so stale nodes aren't
+		// mistaken for visited ones
+		for (auto& n : m_nodes)
+			n.m_generation = 0;
+
+		m_generation = 1;
 	}
 
-	std::vector<glm::ivec2> reconstruct_path(std::unordered_map<glm::ivec2, glm::ivec2> const& parents, glm::ivec2 src, glm::ivec2 dst)
+	// note: the frontier is a binary heap with the same ordering and the
+	// same sequence of pushes and pops as a std::priority_queue, so ties are
+	// broken exactly as they were before the workspace existed.
+	namespace
 	{
-		auto path = std::vector<glm::ivec2>();
-		auto current = dst;
 
-		while (current != src)
-		{
-			path.push_back(current);
-			current = parents.at(current);
-		}
+		auto constexpr frontier_order = [] (auto const& a, auto const& b) { return a.m_cost > b.m_cost; };
 
-		//std::reverse(path.begin(), path.end());
+	} // unnamed
 
-		return path;
+	void pathfinding_workspace::frontier_push(frontier_entry entry)
+	{
+		m_frontier.push_back(entry);
+		std::push_heap(m_frontier.begin(), m_frontier.end(), frontier_order);
 	}
 
-	std::vector<glm::ivec2> find_path(bump::grid2<feature, glm::ivec2> const& grid, glm::ivec2 src, glm::ivec2 dst)
+	pathfinding_workspace::frontier_entry pathfinding_workspace::frontier_pop()
 	{
-		bump::die_if(src.x >= grid.extents().x);
-		bump::die_if(src.y >= grid.extents().y);
-		bump::die_if(dst.x >= grid.extents().x);
-		bump::die_if(dst.y >= grid.extents().y);
-
-		if (src == dst) return { };
-
-		using cost_t = float;
-		using coords_t = glm::ivec2;
-		struct cost_coords { cost_t m_cost; coords_t m_coords; };
-		auto constexpr frontier_order = [] (cost_coords const& a, cost_coords const& b) { return a.m_cost > b.m_cost; };
-
-		using frontier_t = std::priority_queue<cost_coords, std::vector<cost_coords>, decltype(frontier_order)>;
-		using parents_t = std::unordered_map<coords_t, coords_t>;
-		using costs_t = std::unordered_map<coords_t, cost_t>;
-
-		auto frontier = frontier_t();
-		auto parents = parents_t();
-		auto costs = costs_t();
-		
-		frontier.push({ 0.f, coords_t(src) });
-		parents.emplace(coords_t(src), coords_t(src));
-		costs.emplace(coords_t(src), 0.f);
-
-		auto constexpr offsets =
-		{ 
-			glm::ivec2{ -1, -1 }, glm::ivec2{  0, -1 }, glm::ivec2{ +1, -1 },
-			glm::ivec2{ -1,  0 },                       glm::ivec2{ +1,  0 },
-			glm::ivec2{ -1, +1 }, glm::ivec2{  0, +1 }, glm::ivec2{ +1, +1 },
-		};
+		std::pop_heap(m_frontier.begin(), m_frontier.end(), frontier_order);
+		auto const entry = m_frontier.back();
+		m_frontier.pop_back();
+		return entry;
+	}
 
-		auto constexpr heuristic_fn = [] (coords_t const& a, coords_t const& b)
+	namespace
+	{
+
+		bool in_bounds(glm::ivec2 coords, glm::ivec2 min, glm::ivec2 max)
+		{
+			return coords.x >= min.x && coords.x < max.x && coords.y >= min.y && coords.y < max.y;
+		}
+
+		void count_nodes_expanded(std::uint64_t count)
+		{
+			static auto& nodes_expanded = bump::metrics::get_counter("find_path.nodes_expanded");
+			nodes_expanded.add(count);
+		}
+
+	} // unnamed
+
+	void pathfinding_workspace::a_star(bit_grid const& walkable, glm::ivec2 src, glm::ivec2 dst, std::vector<glm::ivec2>& path)
+	{
+		auto constexpr heuristic_fn = [] (glm::ivec2 const& a, glm::ivec2 const& b)
 		{
 			auto const d = glm::vec2(glm::abs(a - b));
 			return glm::length(d);
 		};
 
-		while (!frontier.empty())
+		auto const src_index = to_index(src);
+		auto const dst_index = to_index(dst);
+
+		frontier_push({ 0.f, src_index });
+		m_nodes[src_index] = { m_generation, src_index, 0.f, false };
+
+		auto nodes_expanded = std::uint64_t{ 0 };
+
+		while (!m_frontier.empty())
 		{
-			auto const current = frontier.top().m_coords;
-			frontier.pop();
+			auto const current = frontier_pop().m_index;
 
-			if (current == coords_t{ dst })
+			if (current == dst_index)
 				break;
-			
-			for (auto offset : offsets)
-			{
-				auto const next = current + offset;
 
-				if (!in_bounds(next, { 0, 0 }, coords_t(grid.extents())))
-					continue;
-				
-				if (!is_walkable(grid, next))
-					continue;
+			// a node that was already expanded at its current cost has nothing
+			// new to offer its neighbours (this is a stale frontier entry)
+			auto& current_node = m_nodes[current];
 
-				auto const cost = costs.at(current) + 1;
+			if (current_node.m_closed)
+				continue;
+
+			current_node.m_closed = true;
+			++nodes_expanded;
+
+			auto const current_coords = to_coords(current);
+			auto const cost = current_node.m_cost + 1;
+
+			// walkable neighbours (all in bounds) in the order of neighbour_offsets
+			for (auto neighbours = walkable.neighbours(current_coords); neighbours != 0; neighbours &= neighbours - 1)
+			{
+				auto const next_coords = current_coords + bit_grid::neighbour_offsets[std::countr_zero(neighbours)];
+				auto const next = to_index(next_coords);
 
-				if (!parents.count(next) || cost < costs.at(next))
+				auto& next_node = m_nodes[next];
+
+				if (!visited(next) || cost < next_node.m_cost)
 				{
-					auto const h = heuristic_fn(next, coords_t{ dst });
+					auto const h = heuristic_fn(next_coords, dst);
 
-					frontier.push({ cost + h, next });
-					parents[next] = current;
-					costs[next] = cost;
+					frontier_push({ cost + h, next });
+					next_node = { m_generation, current, cost, false };
 				}
 			}
 		}
 
-		if (!parents.count(coords_t{ dst }))
-			return { }; // failed to find a path
-		
-		return reconstruct_path(parents, src, dst);
+		count_nodes_expanded(nodes_expanded);
+
+		if (!visited(dst_index))
+			return; // failed to find a path
+
+		for (auto current = dst_index; current != src_index; current = m_nodes[current].m_parent)
+			path.push_back(to_coords(current));
+	}
+
+	/* jump_point()
+	 *
+	 * Jump point search (Harabor & Grastien, 2011), with diagonal moves
+	 * allowed past corners to match a_star().
+	 *
+	 * Instead of pushing every neighbour, the search "jumps" in a straight
+	 * line until it hits a tile with a forced neighbour (one that can only
+	 * be reached optimally through that tile), or the destination. Only
+	 * these jump points are stored in the workspace, with the jump point
+	 * they were reached from as their parent.
+	 *
+	 * Every step costs 1, so the cost between two jump points (which always
+	 * lie on a straight or diagonal line) is the chebyshev distance, which
+	 * is also used as the heuristic.
+	 *
+	 */
+	void pathfinding_workspace::jump_point(bit_grid const& walkable, glm::ivec2 src, glm::ivec2 dst, std::vector<glm::ivec2>& path)
+	{
+		auto const is_open = [&] (glm::ivec2 coords)
+		{
+			return in_bounds(coords, { 0, 0 }, m_extents) && walkable.test(coords);
+		};
+
+		auto constexpr distance_fn = [] (glm::ivec2 const& a, glm::ivec2 const& b)
+		{
+			auto const d = glm::abs(a - b);
+			return static_cast<cost_t>(glm::max(d.x, d.y));
+		};
+
+		auto const has_forced_neighbour = [&] (glm::ivec2 p, glm::ivec2 dir)
+		{
+			if (dir.x != 0 && dir.y != 0)
+			{
+				return
+					(!is_open(p + glm::ivec2{ -dir.x, 0 }) && is_open(p + glm::ivec2{ -dir.x, dir.y })) ||
+					(!is_open(p + glm::ivec2{ 0, -dir.y }) && is_open(p + glm::ivec2{ dir.x, -dir.y }));
+			}
+
+			auto const side = glm::ivec2{ dir.y, dir.x }; // perpendicular to dir
+
+			return
+				(!is_open(p + side) && is_open(p + side + dir)) ||
+				(!is_open(p - side) && is_open(p - side + dir));
+		};
+
+		// returns the next jump point from `p` in direction `dir` (or `p` if there isn't one)
+		auto const jump = [&] (glm::ivec2 p, glm::ivec2 dir)
+		{
+			auto const diagonal = (dir.x != 0 && dir.y != 0);
+			auto const start = p;
+
+			while (true)
+			{
+				auto const next = p + dir;
+
+				if (!is_open(next))
+					return start;
+
+				p = next;
+
+				if (p == dst || has_forced_neighbour(p, dir))
+					return p;
+
+				if (!diagonal)
+					continue;
+
+				// check for straight jump points reachable from this diagonal
+				auto const straight_jump = [&] (glm::ivec2 q, glm::ivec2 d)
+				{
+					while (true)
+					{
+						q += d;
+
+						if (!is_open(q))
+							return false;
+
+						if (q == dst || has_forced_neighbour(q, d))
+							return true;
+					}
+				};
+
+				if (straight_jump(p, { dir.x, 0 }) || straight_jump(p, { 0, dir.y }))
+					return p;
+			}
+		};
+
+		auto const push_directions = [&] (glm::ivec2 p, glm::ivec2 parent, auto&& fn)
+		{
+			if (p == parent)
+			{
+				for (auto offset : bit_grid::neighbour_offsets)
+					fn(offset);
+
+				return;
+			}
+
+			auto const dir = glm::sign(p - parent);
+
+			if (dir.x != 0 && dir.y != 0)
+			{
+				// natural neighbours
+				fn(glm::ivec2{ dir.x, 0 });
+				fn(glm::ivec2{ 0, dir.y });
+				fn(dir);
+
+				// forced neighbours
+				if (!is_open(p + glm::ivec2{ -dir.x, 0 })) fn(glm::ivec2{ -dir.x, dir.y });
+				if (!is_open(p + glm::ivec2{ 0, -dir.y })) fn(glm::ivec2{ dir.x, -dir.y });
+			}
+			else
+			{
+				auto const side = glm::ivec2{ dir.y, dir.x };
+
+				// natural neighbour
+				fn(dir);
+
+				// forced neighbours
+				if (!is_open(p + side)) fn(side + dir);
+				if (!is_open(p - side)) fn(-side + dir);
+			}
+		};
+
+		auto const src_index = to_index(src);
+		auto const dst_index = to_index(dst);
+
+		frontier_push({ 0.f, src_index });
+		m_nodes[src_index] = { m_generation, src_index, 0.f, false };
+
+		auto nodes_expanded = std::uint64_t{ 0 };
+
+		while (!m_frontier.empty())
+		{
+			auto const current = frontier_pop().m_index;
+
+			if (current == dst_index)
+				break;
+
+			auto& current_node = m_nodes[current];
+
+			if (current_node.m_closed)
+				continue;
+
+			current_node.m_closed = true;
+			++nodes_expanded;
+
+			auto const current_coords = to_coords(current);
+			auto const parent_coords = to_coords(current_node.m_parent);
+			auto const current_cost = current_node.m_cost;
+
+			push_directions(current_coords, parent_coords, [&] (glm::ivec2 dir)
+			{
+				auto const jump_coords = jump(current_coords, dir);
+
+				if (jump_coords == current_coords)
+					return;
+
+				auto const next = to_index(jump_coords);
+				auto const cost = current_cost + distance_fn(current_coords, jump_coords);
+				auto& next_node = m_nodes[next];
+
+				if (!visited(next) || cost < next_node.m_cost)
+				{
+					frontier_push({ cost + distance_fn(jump_coords, dst), next });
+					next_node = { m_generation, current, cost, false };
+				}
+			});
+		}
+
+		count_nodes_expanded(nodes_expanded);
+
+		if (!visited(dst_index))
+			return; // failed to find a path
+
+		// expand the jump points into single steps
+		for (auto current = dst_index; current != src_index; current = m_nodes[current].m_parent)
+		{
+			auto const parent_coords = to_coords(m_nodes[current].m_parent);
+			auto const dir = glm::sign(parent_coords - to_coords(current));
+
+			for (auto p = to_coords(current); p != parent_coords; p += dir)
+				path.push_back(p);
+		}
+	}
+
+	void find_path(pathfinding_workspace& workspace, bit_grid const& walkable, glm::ivec2 src, glm::ivec2 dst, std::vector<glm::ivec2>& path, pathfinding_mode mode)
+	{
+		auto const zone = bump::trace::zone("find_path");
+
+		static auto& searches = bump::metrics::get_counter("find_path.searches");
+		searches.add();
+
+		bump::die_if(src.x >= walkable.extents().x);
+		bump::die_if(src.y >= walkable.extents().y);
+		bump::die_if(dst.x >= walkable.extents().x);
+		bump::die_if(dst.y >= walkable.extents().y);
+
+		path.clear();
+
+		if (src == dst) return;
+
+		workspace.resize(walkable.extents());
+		workspace.next_generation();
+		workspace.m_frontier.clear();
+
+		switch (mode)
+		{
+		case pathfinding_mode::A_STAR:     workspace.a_star(walkable, src, dst, path); return;
+		case pathfinding_mode::JUMP_POINT: workspace.jump_point(walkable, src, dst, path); return;
+		}
+
+		bump::die();
+	}
+
+	std::vector<glm::ivec2> find_path(bit_grid const& walkable, glm::ivec2 src, glm::ivec2 dst)
+	{
+		auto workspace = pathfinding_workspace(walkable.extents());
+		auto path = std::vector<glm::ivec2>();
+
+		find_path(workspace, walkable, src, dst, path);
+
+		return path;
+	}
+
+	std::vector<glm::ivec2> find_path(level const& level, glm::ivec2 src, glm::ivec2 dst)
+	{
+		return find_path(level.m_layers.m_walkable, src, dst);
 	}
-	
+
 } // rog
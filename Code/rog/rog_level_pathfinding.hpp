@@ -0,0 +1,99 @@
+#pragma once
+
+#include "rog_bit_grid.hpp"
+
+#include <bump_math.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace rog
+{
+
+	struct level;
+
+	enum class pathfinding_mode
+	{
+		A_STAR,
+		JUMP_POINT, // jump point search - uniform cost grids only
+	};
+
+	/* pathfinding_workspace
+	 *
+	 * Search state for find_path(), stored in flat arrays indexed by grid
+	 * cell (y * width + x) rather than in hash maps.
+	 *
+	 * Each node is stamped with the generation of the search that last
+	 * touched it. Starting a new search just increments the generation, so
+	 * the arrays never need clearing and repeated queries on a level of the
+	 * same size allocate nothing.
+	 *
+	 */
+	class pathfinding_workspace
+	{
+	public:
+
+		pathfinding_workspace() = default;
+		explicit pathfinding_workspace(glm::ivec2 extents);
+
+		glm::ivec2 extents() const { return m_extents; }
+		void resize(glm::ivec2 extents);
+
+	private:
+
+		friend void find_path(pathfinding_workspace& workspace, bit_grid const& walkable, glm::ivec2 src, glm::ivec2 dst, std::vector<glm::ivec2>& path, pathfinding_mode mode);
+
+		using cost_t = float;
+		using index_t = std::int32_t;
+
+		struct node
+		{
+			std::uint32_t m_generation = 0;
+			index_t m_parent = 0;
+			cost_t m_cost = 0.f;
+			bool m_closed = false;
+		};
+
+		struct frontier_entry
+		{
+			cost_t m_cost;
+			index_t m_index;
+		};
+
+		void next_generation();
+
+		bool visited(index_t index) const { return m_nodes[index].m_generation == m_generation; }
+
+		index_t to_index(glm::ivec2 coords) const { return coords.y * m_extents.x + coords.x; }
+		glm::ivec2 to_coords(index_t index) const { return { index % m_extents.x, index / m_extents.x }; }
+
+		void frontier_push(frontier_entry entry);
+		frontier_entry frontier_pop();
+
+		void a_star(bit_grid const& walkable, glm::ivec2 src, glm::ivec2 dst, std::vector<glm::ivec2>& path);
+		void jump_point(bit_grid const& walkable, glm::ivec2 src, glm::ivec2 dst, std::vector<glm::ivec2>& path);
+
+		glm::ivec2 m_extents = glm::ivec2(0);
+		std::uint32_t m_generation = 0;
+		std::vector<node> m_nodes;
+		std::vector<frontier_entry> m_frontier;
+	};
+
+	/* find_path()
+	 *
+	 * Search from `src` to `dst` over 8-connected tiles set in `walkable`,
+	 * where every step (including diagonals) costs 1.
+	 *
+	 * The path is returned in reverse order (`dst` first, `src` excluded),
+	 * so the next step can be taken from the back. An empty path means
+	 * `src == dst`, or that no path exists.
+	 *
+	 * JUMP_POINT search skips over runs of open floor and only stores the
+	 * turning points, but the returned path is expanded to single steps.
+	 *
+	 */
+	void find_path(pathfinding_workspace& workspace, bit_grid const& walkable, glm::ivec2 src, glm::ivec2 dst, std::vector<glm::ivec2>& path, pathfinding_mode mode = pathfinding_mode::A_STAR);
+	std::vector<glm::ivec2> find_path(bit_grid const& walkable, glm::ivec2 src, glm::ivec2 dst);
+	std::vector<glm::ivec2> find_path(level const& level, glm::ivec2 src, glm::ivec2 dst); // (over the level's walkable layer)
+
+} // rog
@@ -0,0 +1,150 @@
+#include "rog_level_pathfinding.hpp"
+
+#include "rog_bit_grid.hpp"
+#include "rog_random.hpp"
+
+#include <bump_range.hpp>
+
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <queue>
+#include <vector>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		bit_grid make_random_map(random::rng_t& rng, glm::ivec2 size, float wall_chance)
+		{
+			auto walkable = bit_grid(size, true);
+
+			for (auto y : bump::range(0, size.y))
+				for (auto x : bump::range(0, size.x))
+					if (random::rand_01<float>(rng) < wall_chance)
+						walkable.set({ x, y }, false);
+
+			return walkable;
+		}
+
+		bool is_valid_path(bit_grid const& walkable, glm::ivec2 src, glm::ivec2 dst, std::vector<glm::ivec2> const& path)
+		{
+			if (path.empty() || path.front() != dst)
+				return false;
+
+			auto current = src;
+
+			for (auto i = path.rbegin(); i != path.rend(); ++i)
+			{
+				auto const d = glm::abs(*i - current);
+
+				if (glm::max(d.x, d.y) != 1)
+					return false;
+
+				if (!walkable.test(*i))
+					return false;
+
+				current = *i;
+			}
+
+			return true;
+		}
+
+		// the number of steps on the shortest path (a breadth first search, as every step costs 1), or nullopt if there's no path
+		std::optional<std::size_t> shortest_path_length(bit_grid const& walkable, glm::ivec2 size, glm::ivec2 src, glm::ivec2 dst)
+		{
+			auto const to_index = [&] (glm::ivec2 p) { return std::size_t(p.y) * std::size_t(size.x) + std::size_t(p.x); };
+
+			auto distances = std::vector<std::optional<std::size_t>>(std::size_t(size.x) * std::size_t(size.y));
+			auto open = std::queue<glm::ivec2>();
+
+			distances[to_index(src)] = 0;
+			open.push(src);
+
+			while (!open.empty())
+			{
+				auto const current = open.front();
+				open.pop();
+
+				if (current == dst)
+					return distances[to_index(current)];
+
+				for (auto y : bump::range(-1, 2))
+				{
+					for (auto x : bump::range(-1, 2))
+					{
+						auto const next = current + glm::ivec2{ x, y };
+
+						if (glm::any(glm::lessThan(next, glm::ivec2(0))) || glm::any(glm::greaterThanEqual(next, size)))
+							continue;
+
+						if (!walkable.test(next) || distances[to_index(next)].has_value())
+							continue;
+
+						distances[to_index(next)] = distances[to_index(current)].value() + 1;
+						open.push(next);
+					}
+				}
+			}
+
+			return std::nullopt;
+		}
+
+	} // unnamed
+
+	TEST(Test_rog_level_pathfinding, jump_point_is_optimal_on_random_maps)
+	{
+		auto rng = random::rng_t(12345);
+		auto workspace = pathfinding_workspace();
+		auto a_star_path = std::vector<glm::ivec2>();
+		auto jump_point_path = std::vector<glm::ivec2>();
+
+		for (auto map : bump::range(0, 200))
+		{
+			auto const size = random::rand_range(rng, glm::ivec2(2), glm::ivec2(48));
+			auto const walkable = make_random_map(rng, size, random::rand_range(rng, 0.f, 0.45f));
+
+			for (auto query : bump::range(0, 10))
+			{
+				auto const src = random::rand_range(rng, glm::ivec2(0), size - 1);
+				auto const dst = random::rand_range(rng, glm::ivec2(0), size - 1);
+
+				find_path(workspace, walkable, src, dst, a_star_path, pathfinding_mode::A_STAR);
+				find_path(workspace, walkable, src, dst, jump_point_path, pathfinding_mode::JUMP_POINT);
+
+				SCOPED_TRACE(testing::Message() << "map " << map << ", query " << query);
+
+				// both find a path, or neither does
+				EXPECT_EQ(a_star_path.empty(), jump_point_path.empty());
+
+				// jump point search is optimal (unlike a_star, whose euclidean
+				// heuristic overestimates diagonal moves), so it must match the
+				// shortest path found by a breadth first search
+				auto const shortest = shortest_path_length(walkable, size, src, dst);
+				EXPECT_EQ(jump_point_path.size(), shortest.value_or(0));
+
+				if (jump_point_path.empty())
+					continue;
+
+				// every step is to an adjacent, walkable tile
+				EXPECT_TRUE(is_valid_path(walkable, src, dst, jump_point_path));
+			}
+		}
+	}
+
+	TEST(Test_rog_level_pathfinding, jump_point_open_room)
+	{
+		auto const walkable = bit_grid({ 32, 32 }, true);
+
+		auto workspace = pathfinding_workspace();
+		auto path = std::vector<glm::ivec2>();
+
+		find_path(workspace, walkable, { 1, 2 }, { 30, 20 }, path, pathfinding_mode::JUMP_POINT);
+
+		EXPECT_EQ(path.size(), 29);
+		EXPECT_TRUE(is_valid_path(walkable, { 1, 2 }, { 30, 20 }, path));
+	}
+
+} // rog
@@ -0,0 +1,117 @@
+#include "rog_level_pregen.hpp"
+
+#include "rog_level_gen.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace rog
+{
+
+	level_pregenerator::level_pregenerator(std::uint64_t dungeon_seed, glm::ivec2 level_size):
+		m_dungeon_seed(dungeon_seed),
+		m_level_size(level_size),
+		m_keep_min(std::numeric_limits<std::int32_t>::min()),
+		m_keep_max(std::numeric_limits<std::int32_t>::max()),
+		m_stop(false),
+		m_worker([this] () { run(); }) { }
+
+	level_pregenerator::~level_pregenerator()
+	{
+		{
+			auto lock = std::lock_guard(m_mutex);
+			m_stop = true;
+		}
+
+		m_condition.notify_all();
+		m_worker.join();
+	}
+
+	void level_pregenerator::request(std::int32_t depth)
+	{
+		{
+			auto lock = std::lock_guard(m_mutex);
+
+			m_keep_min = std::min(m_keep_min, depth);
+			m_keep_max = std::max(m_keep_max, depth);
+
+			if (m_ready.contains(depth) || m_in_progress == depth || std::find(m_queue.begin(), m_queue.end(), depth) != m_queue.end())
+				return;
+
+			m_queue.push_back(depth);
+		}
+
+		m_condition.notify_all();
+	}
+
+	level level_pregenerator::take(std::int32_t depth)
+	{
+		{
+			auto lock = std::unique_lock(m_mutex);
+
+			m_queue.erase(std::remove(m_queue.begin(), m_queue.end(), depth), m_queue.end());
+
+			m_condition.wait(lock, [&] () { return m_in_progress != depth; });
+
+			if (auto const r = m_ready.find(depth); r != m_ready.end())
+				return std::move(m_ready.extract(r).mapped());
+		}
+
+		return level_gen::generate_level(m_dungeon_seed, depth, m_level_size);
+	}
+
+	void level_pregenerator::discard_outside(std::int32_t min_depth, std::int32_t max_depth)
+	{
+		auto const outside = [&] (std::int32_t depth) { return depth < min_depth || depth > max_depth; };
+
+		auto lock = std::lock_guard(m_mutex);
+
+		m_keep_min = min_depth;
+		m_keep_max = max_depth;
+
+		m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(), outside), m_queue.end());
+		std::erase_if(m_ready, [&] (auto const& r) { return outside(r.first); });
+	}
+
+	bool level_pregenerator::is_ready(std::int32_t depth) const
+	{
+		auto lock = std::lock_guard(m_mutex);
+		return m_ready.contains(depth);
+	}
+
+	void level_pregenerator::run()
+	{
+		while (true)
+		{
+			auto depth = std::int32_t{ 0 };
+
+			{
+				auto lock = std::unique_lock(m_mutex);
+
+				m_condition.wait(lock, [&] () { return m_stop || !m_queue.empty(); });
+
+				if (m_stop)
+					return;
+
+				depth = m_queue.front();
+				m_queue.pop_front();
+				m_in_progress = depth;
+			}
+
+			auto l = level_gen::generate_level(m_dungeon_seed, depth, m_level_size);
+
+			{
+				auto lock = std::lock_guard(m_mutex);
+
+				// (it may have been discarded while it was being generated)
+				if (depth >= m_keep_min && depth <= m_keep_max)
+					m_ready.insert_or_assign(depth, std::move(l));
+
+				m_in_progress.reset();
+			}
+
+			m_condition.notify_all();
+		}
+	}
+
+} // rog
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "rog_level.hpp"
+
+#include <bump_math.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace rog
+{
+
+	/* level_pregenerator
+	 *
+	 * Generates levels on a worker thread, so that the levels next to the
+	 * current depth are ready before the player takes the stairs.
+	 *
+	 * Since levels are generated from the dungeon seed and their depth, a
+	 * level is the same whether it comes from here or from calling
+	 * level_gen::generate_level() directly.
+	 *
+	 */
+	class level_pregenerator
+	{
+	public:
+
+		level_pregenerator(std::uint64_t dungeon_seed, glm::ivec2 level_size);
+		~level_pregenerator();
+
+		level_pregenerator(level_pregenerator const&) = delete;
+		level_pregenerator& operator=(level_pregenerator const&) = delete;
+		level_pregenerator(level_pregenerator&&) = delete;
+		level_pregenerator& operator=(level_pregenerator&&) = delete;
+
+		// queues `depth` for generation (if it isn't already ready or queued), and keeps it from being discarded
+		void request(std::int32_t depth);
+
+		/* take()
+		 *
+		 * Returns the level at `depth`, removing it from the ready levels.
+		 * If it's being generated, this waits for it. If it hasn't been
+		 * requested, it's generated on this thread.
+		 *
+		 */
+		level take(std::int32_t depth);
+
+		// drops any ready or queued levels outside [min_depth, max_depth] (and the one being generated, when it's done)
+		void discard_outside(std::int32_t min_depth, std::int32_t max_depth);
+
+		bool is_ready(std::int32_t depth) const;
+
+	private:
+
+		void run();
+
+		std::uint64_t m_dungeon_seed;
+		glm::ivec2 m_level_size;
+
+		mutable std::mutex m_mutex;
+		std::condition_variable m_condition;
+		std::deque<std::int32_t> m_queue;
+		std::optional<std::int32_t> m_in_progress;
+		std::map<std::int32_t, level> m_ready;
+		std::int32_t m_keep_min; // generated levels outside [m_keep_min, m_keep_max] are dropped
+		std::int32_t m_keep_max;
+		bool m_stop;
+
+		std::thread m_worker; // last, so it starts after everything else is initialized
+	};
+
+} // rog
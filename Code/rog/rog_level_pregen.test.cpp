@@ -0,0 +1,105 @@
+#include "rog_level_pregen.hpp"
+
+#include "rog_level_gen.hpp"
+#include "rog_level_io.hpp"
+
+#include <bump_range.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		auto constexpr SEED = std::uint64_t{ 0x5eed };
+		auto constexpr LEVEL_SIZE = glm::ivec2{ 400, 300 }; // (big enough to take a while)
+
+		std::string to_bytes(level const& level)
+		{
+			auto os = std::ostringstream();
+			write_level(os, level);
+			return os.str();
+		}
+
+		bool wait_until_ready(level_pregenerator const& pregen, std::int32_t depth)
+		{
+			for (auto i : bump::range(0, 10'000))
+			{
+				(void)i;
+
+				if (pregen.is_ready(depth))
+					return true;
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+
+			return false;
+		}
+
+	} // unnamed
+
+	TEST(Test_rog_level_pregen, takes_pregenerated_level)
+	{
+		auto pregen = level_pregenerator(SEED, LEVEL_SIZE);
+
+		pregen.request(3);
+		ASSERT_TRUE(wait_until_ready(pregen, 3));
+
+		// the same level as generating it directly
+		EXPECT_EQ(to_bytes(pregen.take(3)), to_bytes(level_gen::generate_level(SEED, 3, LEVEL_SIZE)));
+		EXPECT_FALSE(pregen.is_ready(3));
+
+		// and one that wasn't requested is generated on the spot
+		EXPECT_EQ(to_bytes(pregen.take(4)), to_bytes(level_gen::generate_level(SEED, 4, LEVEL_SIZE)));
+	}
+
+	TEST(Test_rog_level_pregen, discards_ready_levels)
+	{
+		auto pregen = level_pregenerator(SEED, LEVEL_SIZE);
+
+		pregen.request(2);
+		pregen.request(3);
+		ASSERT_TRUE(wait_until_ready(pregen, 2));
+		ASSERT_TRUE(wait_until_ready(pregen, 3));
+
+		pregen.discard_outside(3, 5);
+
+		EXPECT_FALSE(pregen.is_ready(2));
+		EXPECT_TRUE(pregen.is_ready(3));
+	}
+
+	TEST(Test_rog_level_pregen, discards_levels_being_generated)
+	{
+		auto pregen = level_pregenerator(SEED, LEVEL_SIZE);
+
+		for (auto depth : bump::range(1, 11))
+		{
+			SCOPED_TRACE(testing::Message() << "depth " << depth);
+
+			// (discarding while it's queued, or while it's being generated)
+			pregen.request(depth);
+			std::this_thread::sleep_for(std::chrono::milliseconds(1 + depth % 3));
+			pregen.discard_outside(depth + 1, depth + 1);
+
+			// the worker generates levels in order, so once this is ready, the discarded one is done
+			pregen.request(depth + 1);
+			ASSERT_TRUE(wait_until_ready(pregen, depth + 1));
+
+			EXPECT_FALSE(pregen.is_ready(depth));
+		}
+
+		// requesting a level again keeps it
+		pregen.request(5);
+		pregen.discard_outside(6, 8);
+		pregen.request(5);
+		EXPECT_TRUE(wait_until_ready(pregen, 5));
+	}
+
+} // rog
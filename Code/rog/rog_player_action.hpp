@@ -2,6 +2,8 @@
 
 #include "rog_direction.hpp"
 
+#include <bump_math.hpp>
+
 #include <variant>
 
 namespace rog
@@ -12,13 +14,15 @@ namespace rog
 
 		struct move { direction m_dir; };
 		struct use_stairs { stairs_direction m_dir; };
+		struct travel { glm::ivec2 m_dst; }; // (queues a path, rather than being a single turn)
 
 	} // actions
 
 	using player_action = std::variant
 	<
 		player_actions::move,
-		player_actions::use_stairs
+		player_actions::use_stairs,
+		player_actions::travel
 	>;
 	
 } // rog
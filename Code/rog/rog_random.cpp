@@ -1,26 +1,113 @@
 #include "rog_random.hpp"
 
-#include <algorithm>
-#include <array>
+#include <random>
 
 namespace rog
 {
-	
+
 	namespace random
 	{
-		
+
+		namespace
+		{
+
+			std::uint64_t splitmix64(std::uint64_t& x)
+			{
+				auto z = (x += 0x9e3779b97f4a7c15);
+				z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+				z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+				return z ^ (z >> 31);
+			}
+
+			auto constexpr PHILOX_M0 = std::uint32_t{ 0xD2511F53 };
+			auto constexpr PHILOX_M1 = std::uint32_t{ 0xCD9E8D57 };
+			auto constexpr PHILOX_W0 = std::uint32_t{ 0x9E3779B9 };
+			auto constexpr PHILOX_W1 = std::uint32_t{ 0xBB67AE85 };
+
+			auto constexpr PHILOX_ROUNDS = 10;
+
+		} // unnamed
+
+		xoshiro256_rng::xoshiro256_rng(std::uint64_t seed)
+		{
+			for (auto& s : m_state)
+				s = splitmix64(seed);
+		}
+
+		philox_rng::philox_rng(std::uint64_t key, std::uint32_t stream_id, std::uint64_t stream_step):
+			m_counter{ 0, stream_id, std::uint32_t(stream_step), std::uint32_t(stream_step >> 32) },
+			m_key{ std::uint32_t(key), std::uint32_t(key >> 32) },
+			m_buffer{ },
+			m_next(m_buffer.size()) { }
+
+		void philox_rng::fill(std::span<std::uint64_t> out)
+		{
+			auto i = std::size_t{ 0 };
+
+			// use up what's buffered first
+			for (; i != out.size() && m_next != m_buffer.size(); ++i)
+				out[i] = m_buffer[m_next++];
+
+			for (; i + 2 <= out.size(); i += 2)
+			{
+				auto const block = generate_block(m_counter, m_key);
+				++m_counter[0];
+
+				out[i + 0] = (std::uint64_t(block[1]) << 32) | block[0];
+				out[i + 1] = (std::uint64_t(block[3]) << 32) | block[2];
+			}
+
+			for (; i != out.size(); ++i)
+				out[i] = (*this)();
+		}
+
+		philox_rng::block_t philox_rng::generate_block(block_t counter, std::array<std::uint32_t, 2> key)
+		{
+			auto [c0, c1, c2, c3] = counter;
+			auto [k0, k1] = key;
+
+			for (auto round = 0; round != PHILOX_ROUNDS; ++round)
+			{
+				auto const p0 = std::uint64_t(PHILOX_M0) * c0;
+				auto const p1 = std::uint64_t(PHILOX_M1) * c2;
+
+				c0 = std::uint32_t(p1 >> 32) ^ c1 ^ k0;
+				c1 = std::uint32_t(p1);
+				c2 = std::uint32_t(p0 >> 32) ^ c3 ^ k1;
+				c3 = std::uint32_t(p0);
+
+				k0 += PHILOX_W0;
+				k1 += PHILOX_W1;
+			}
+
+			return { c0, c1, c2, c3 };
+		}
+
+		void philox_rng::refill()
+		{
+			auto const block = generate_block(m_counter, m_key);
+			++m_counter[0];
+
+			m_buffer[0] = (std::uint64_t(block[1]) << 32) | block[0];
+			m_buffer[1] = (std::uint64_t(block[3]) << 32) | block[2];
+			m_next = 0;
+		}
+
 		rng_t seed_rng()
 		{
 			auto rd = std::random_device();
-			auto seq = std::array<std::seed_seq::result_type, rng_t::state_size>();
-			std::generate_n(seq.begin(), rng_t::state_size, std::ref(rd));
+			auto state = std::array<std::uint64_t, 4>();
+
+			for (auto& s : state)
+				s = (std::uint64_t(rd()) << 32) | rd();
 
-			auto seed = std::seed_seq(seq.begin(), seq.end());
-			auto rng = rng_t(seed);
+			// (an all zero state would only ever give zeros)
+			if (state == std::array<std::uint64_t, 4>{ })
+				state[0] = 1;
 
-			return rng;
+			return rng_t(state);
 		}
-		
+
 	} // random
-	
+
 } // rog
@@ -2,52 +2,239 @@
 
 #include <bump_math.hpp>
 
-#include <random>
+#include <entt.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
 #include <type_traits>
 
 namespace rog
 {
-	
+
 	namespace random
 	{
-		
-		using rng_t = std::mt19937_64;
+
+		/* xoshiro256_rng
+		 *
+		 * xoshiro256** (Blackman & Vigna): a small (32 byte) and fast
+		 * generator, for everything that only needs one sequence of numbers
+		 * (e.g. level generation). Seeded from a single 64 bit number with
+		 * splitmix64, as its authors suggest.
+		 *
+		 * Unlike the std:: distributions, the functions below give the same
+		 * numbers on every platform.
+		 *
+		 */
+		class xoshiro256_rng
+		{
+		public:
+
+			using result_type = std::uint64_t;
+
+			explicit xoshiro256_rng(std::uint64_t seed = 0);
+			explicit xoshiro256_rng(std::array<std::uint64_t, 4> const& state): m_state(state) { }
+
+			static constexpr result_type min() { return 0; }
+			static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+			result_type operator()()
+			{
+				auto& s = m_state;
+				auto const result = rotl(s[1] * 5, 7) * 9;
+				auto const t = s[1] << 17;
+
+				s[2] ^= s[0];
+				s[3] ^= s[1];
+				s[1] ^= s[2];
+				s[0] ^= s[3];
+				s[2] ^= t;
+				s[3] = rotl(s[3], 45);
+
+				return result;
+			}
+
+			std::array<std::uint64_t, 4> const& state() const { return m_state; }
+
+		private:
+
+			static constexpr std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+			std::array<std::uint64_t, 4> m_state;
+		};
+
+		/* philox_rng
+		 *
+		 * Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as
+		 * 1, 2, 3"): a counter-based generator. Each number is a hash of a
+		 * 128 bit counter with a 64 bit key, so there's no state to pass
+		 * around, and any number of independent streams can be made from
+		 * the same key (here, the counter holds the stream id and step, and
+		 * the position in the stream).
+		 *
+		 * This makes it possible to give every (entity, turn) its own stream
+		 * (see entity_rng()), so the numbers an entity gets don't depend on
+		 * what order (or which thread) entities are processed in.
+		 *
+		 */
+		class philox_rng
+		{
+		public:
+
+			using result_type = std::uint64_t;
+			using block_t = std::array<std::uint32_t, 4>;
+
+			philox_rng(std::uint64_t key, std::uint32_t stream_id, std::uint64_t stream_step);
+
+			static constexpr result_type min() { return 0; }
+			static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+			result_type operator()()
+			{
+				if (m_next == m_buffer.size())
+					refill();
+
+				return m_buffer[m_next++];
+			}
+
+			// fills `out` with the next numbers in the stream (a block at a time)
+			void fill(std::span<std::uint64_t> out);
+
+			static block_t generate_block(block_t counter, std::array<std::uint32_t, 2> key);
+
+		private:
+
+			void refill();
+
+			block_t m_counter; // (block index, stream id, stream step (low), stream step (high))
+			std::array<std::uint32_t, 2> m_key;
+			std::array<std::uint64_t, 2> m_buffer;
+			std::size_t m_next;
+		};
+
+		using rng_t = xoshiro256_rng;
 
 		rng_t seed_rng();
 
+		// the numbers for `entity` to use on `turn` (the same every time, for the same seed)
+		inline philox_rng entity_rng(std::uint64_t seed, entt::entity entity, std::uint64_t turn)
+		{
+			return philox_rng(seed, std::uint32_t(entt::to_integral(entity)), turn);
+		}
+
 		namespace impl
 		{
-			template<class T, class = void> struct rand_range_dist_t;
-			template<class T> struct rand_range_dist_t<T, std::enable_if_t<std::is_integral_v<T>>> { using type = std::uniform_int_distribution<T>; };
-			template<class T> struct rand_range_dist_t<T, std::enable_if_t<std::is_floating_point_v<T>>> { using type = std::uniform_real_distribution<T>; };
-			
+
+			// a uniformly distributed number in [0, bound), or any 64 bit number if bound is 0 (Lemire's method)
+			template<class RngT>
+			std::uint64_t rand_below(RngT& rng, std::uint64_t bound)
+			{
+				if (bound == 0)
+					return rng();
+
+				if (bound <= std::numeric_limits<std::uint32_t>::max())
+				{
+					auto const b = std::uint32_t(bound);
+					auto m = std::uint64_t(std::uint32_t(rng() >> 32)) * b;
+
+					if (std::uint32_t(m) < b)
+					{
+						auto const threshold = std::uint32_t(0u - b) % b;
+
+						while (std::uint32_t(m) < threshold)
+							m = std::uint64_t(std::uint32_t(rng() >> 32)) * b;
+					}
+
+					return m >> 32;
+				}
+
+				// (rejects the numbers past the last whole multiple of bound)
+				auto const threshold = (std::uint64_t{ 0 } - bound) % bound;
+
+				while (true)
+					if (auto const x = rng(); x >= threshold)
+						return x % bound;
+			}
+
+			template<class T, class RngT>
+			T rand_unit(RngT& rng)
+			{
+				// the top bits, as [0, 1) with the full precision of T
+				auto constexpr digits = std::numeric_limits<T>::digits;
+				return T(rng() >> (64 - digits)) * (T{ 1 } / T(std::uint64_t{ 1 } << digits));
+			}
+
 		} // impl
 
-		template<class T, class = std::enable_if_t<std::is_arithmetic_v<T>>>
-		T rand_range(rng_t& rng, T min, T max)
+		/* rand_range()
+		 *
+		 * A uniformly distributed number in [min, max] for integers, or
+		 * [min, max) for floating point types.
+		 *
+		 */
+		template<class RngT, class T, class = std::enable_if_t<std::is_arithmetic_v<T>>>
+		T rand_range(RngT& rng, T min, T max)
 		{
-			using dist_t = impl::rand_range_dist_t<T>::type;
-
-			return dist_t(min, max)(rng);
+			if constexpr (std::is_integral_v<T>)
+			{
+				// (unsigned arithmetic wraps, so this works for signed types too)
+				auto const span = std::uint64_t(max) - std::uint64_t(min) + 1;
+				return T(std::uint64_t(min) + impl::rand_below(rng, span));
+			}
+			else
+			{
+				// (the result can round up to max, e.g. for [0.25, 0.5), so that's clamped to the value before it)
+				auto const result = min + (max - min) * impl::rand_unit<T>(rng);
+				return result < max ? result : std::nextafter(max, min);
+			}
 		}
 
-		template<glm::length_t S, class T, glm::qualifier Q, class = std::enable_if_t<std::is_arithmetic_v<T>> >
-		glm::vec<S, T, Q> rand_range(rng_t& rng, glm::vec<S, T, Q> min, glm::vec<S, T, Q> max)
+		template<class RngT, glm::length_t S, class T, glm::qualifier Q, class = std::enable_if_t<std::is_arithmetic_v<T>> >
+		glm::vec<S, T, Q> rand_range(RngT& rng, glm::vec<S, T, Q> min, glm::vec<S, T, Q> max)
 		{
 			auto out = glm::vec<S, T, Q>();
 
 			for (auto i = glm::length_t{ 0 }; i != S; ++i)
 				out[i] = rand_range(rng, min[i], max[i]);
-			
+
 			return out;
 		}
-		
-		template<class T>
-		T rand_01(rng_t& rng)
+
+		template<class T, class RngT>
+		T rand_01(RngT& rng)
 		{
 			return rand_range(rng, T{ 0 }, T{ 1 });
 		}
 
+		/* fill(), fill_range()
+		 *
+		 * Batch versions of the above, for rolling lots of numbers at once.
+		 *
+		 */
+		template<class RngT>
+		void fill(RngT& rng, std::span<std::uint64_t> out)
+		{
+			if constexpr (requires { rng.fill(out); })
+			{
+				rng.fill(out);
+			}
+			else
+			{
+				for (auto& x : out)
+					x = rng();
+			}
+		}
+
+		template<class RngT, class T, class = std::enable_if_t<std::is_arithmetic_v<T>>>
+		void fill_range(RngT& rng, std::span<T> out, T min, T max)
+		{
+			for (auto& x : out)
+				x = rand_range(rng, min, max);
+		}
+
 	} // random
-	
+
 } // rog
@@ -0,0 +1,141 @@
+#include "rog_random.hpp"
+
+#include <bump_range.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace rog
+{
+
+	TEST(Test_rog_random, xoshiro256_reference_values)
+	{
+		// from the reference implementation, with the state set directly
+		auto rng = random::xoshiro256_rng({ 1, 2, 3, 4 });
+
+		EXPECT_EQ(rng(), 11520);
+		EXPECT_EQ(rng(), 0);
+		EXPECT_EQ(rng(), 1509978240);
+		EXPECT_EQ(rng(), 1215971899390074240);
+	}
+
+	TEST(Test_rog_random, philox_known_answers)
+	{
+		// from the Random123 known answer tests (philox4x32, 10 rounds)
+		{
+			auto const block = random::philox_rng::generate_block({ 0, 0, 0, 0 }, { 0, 0 });
+			EXPECT_EQ(block, (random::philox_rng::block_t{ 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 }));
+		}
+
+		{
+			auto const block = random::philox_rng::generate_block({ 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, { 0xffffffff, 0xffffffff });
+			EXPECT_EQ(block, (random::philox_rng::block_t{ 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd }));
+		}
+
+		{
+			auto const block = random::philox_rng::generate_block({ 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, { 0xa4093822, 0x299f31d0 });
+			EXPECT_EQ(block, (random::philox_rng::block_t{ 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 }));
+		}
+	}
+
+	TEST(Test_rog_random, entity_streams)
+	{
+		auto const first_numbers = [] (random::philox_rng rng)
+		{
+			auto out = std::array<std::uint64_t, 4>();
+			random::fill(rng, out);
+			return out;
+		};
+
+		auto const e1 = entt::entity{ 1 };
+		auto const e2 = entt::entity{ 2 };
+
+		// the same every time, and different for every seed, entity and turn
+		EXPECT_EQ(first_numbers(random::entity_rng(7, e1, 100)), first_numbers(random::entity_rng(7, e1, 100)));
+		EXPECT_NE(first_numbers(random::entity_rng(7, e1, 100)), first_numbers(random::entity_rng(8, e1, 100)));
+		EXPECT_NE(first_numbers(random::entity_rng(7, e1, 100)), first_numbers(random::entity_rng(7, e2, 100)));
+		EXPECT_NE(first_numbers(random::entity_rng(7, e1, 100)), first_numbers(random::entity_rng(7, e1, 101)));
+
+		// filling in bulk gives the same numbers as one at a time, however it's split up
+		auto one_at_a_time = random::entity_rng(7, e2, 5);
+		auto bulk = random::entity_rng(7, e2, 5);
+
+		auto expected = std::vector<std::uint64_t>(37);
+		for (auto& x : expected)
+			x = one_at_a_time();
+
+		auto actual = std::vector<std::uint64_t>(37);
+		actual[0] = bulk();
+		random::fill(bulk, std::span(actual).subspan(1, 20));
+		random::fill(bulk, std::span(actual).subspan(21));
+
+		EXPECT_EQ(actual, expected);
+	}
+
+	TEST(Test_rog_random, rand_range_bounds)
+	{
+		auto rng = random::rng_t(42);
+
+		auto seen = std::set<std::int32_t>();
+
+		for ([[maybe_unused]] auto _ : bump::range(0, 10'000))
+		{
+			auto const x = random::rand_range(rng, -3, 5);
+			ASSERT_GE(x, -3);
+			ASSERT_LE(x, 5);
+			seen.insert(x);
+
+			auto const f = random::rand_range(rng, 0.25f, 0.5f);
+			ASSERT_GE(f, 0.25f);
+			ASSERT_LT(f, 0.5f);
+
+			auto const u = random::rand_range(rng, std::uint64_t{ 0 }, std::numeric_limits<std::uint64_t>::max() - 1);
+			ASSERT_LT(u, std::numeric_limits<std::uint64_t>::max());
+		}
+
+		EXPECT_EQ(seen.size(), 9);
+
+		// the full range of a type
+		(void)random::rand_range(rng, std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max());
+		EXPECT_EQ(random::rand_range(rng, 17, 17), 17);
+	}
+
+	TEST(Test_rog_random, rand_range_float_upper_bound)
+	{
+		// (gives the largest unit value, just below 1)
+		struct max_rng
+		{
+			std::uint64_t operator()() { return std::numeric_limits<std::uint64_t>::max(); }
+		};
+
+		auto rng = max_rng();
+
+		EXPECT_LT(random::rand_range(rng, 0.25f, 0.5f), 0.5f);
+		EXPECT_LT(random::rand_range(rng, -1.f, 1.f), 1.f);
+		EXPECT_LT(random::rand_range(rng, 0.25, 0.5), 0.5);
+		EXPECT_EQ(random::rand_range(rng, 0.5f, 0.5f), 0.5f);
+	}
+
+	TEST(Test_rog_random, rand_range_is_uniform)
+	{
+		auto constexpr BUCKETS = 6;
+		auto constexpr ROLLS = 600'000;
+
+		auto rng = random::rng_t(1);
+		auto counts = std::array<std::int32_t, BUCKETS>();
+
+		auto rolls = std::vector<std::int32_t>(ROLLS);
+		random::fill_range(rng, std::span(rolls), 0, BUCKETS - 1);
+
+		for (auto r : rolls)
+			++counts[std::size_t(r)];
+
+		for (auto c : counts)
+			EXPECT_NEAR(c, ROLLS / BUCKETS, ROLLS / BUCKETS / 50); // (within 2%)
+	}
+
+} // rog
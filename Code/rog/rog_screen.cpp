@@ -6,10 +6,14 @@
 #include "rog_level.hpp"
 
 #include <bump_aabb.hpp>
+#include <bump_metrics.hpp>
+#include <bump_trace.hpp>
 #include <bump_transform.hpp>
 
 #include <glm/common.hpp>
 
+#include <algorithm>
+
 namespace rog
 {
 
@@ -18,6 +22,45 @@ namespace rog
 		fill_rect(glm::ivec2(0), glm::ivec2(m_data.extents()), cell);
 	}
 
+	void screen_layer::resize(glm::ivec2 size)
+	{
+		m_size = size;
+		m_cells.assign(std::size_t(size.x) * std::size_t(size.y), screen_cell());
+		m_types.assign(m_cells.size(), cell_type::EMPTY);
+	}
+
+	void screen_layer::clear()
+	{
+		std::fill(m_types.begin(), m_types.end(), cell_type::EMPTY);
+	}
+
+	void screen_layer::set(glm::ivec2 pos, screen_cell const& cell)
+	{
+		auto const index = to_index(pos);
+		m_cells[index] = cell;
+		m_types[index] = cell_type::CELL;
+	}
+
+	void screen_layer::set_bg(glm::ivec2 pos, packed_color bg)
+	{
+		auto const index = to_index(pos);
+		m_cells[index].m_bg = bg;
+
+		// (setting the background of a whole cell keeps the rest of the cell)
+		if (m_types[index] == cell_type::EMPTY)
+			m_types[index] = cell_type::BG;
+	}
+
+	bool screen_layer::apply(std::size_t index, screen_cell& cell) const
+	{
+		switch (m_types[index])
+		{
+		case cell_type::CELL: cell = m_cells[index]; return true;
+		case cell_type::BG: cell.m_bg = m_cells[index].m_bg; return true;
+		default: return false;
+		}
+	}
+
 	void screen_buffer::fill_rect(glm::ivec2 origin, glm::ivec2 size, screen_cell const& cell)
 	{
 		auto const extents = glm::ivec2(m_data.extents());
@@ -25,78 +68,215 @@ namespace rog
 		auto const end = glm::clamp(origin + size, begin, extents);
 
 		for (auto y : bump::range(begin.y, end.y))
-			for (auto x : bump::range(begin.x, end.x))
-				m_data.at({ x, y }) = cell;
+			write_row(y, begin.x, end.x, [&] (std::int32_t, screen_cell const&) { return cell; });
+	}
+
+	void screen_buffer::set_span(glm::ivec2 origin, screen_cell const* cells, std::int32_t count)
+	{
+		if (origin.y < 0 || origin.y >= size().y)
+			return;
+
+		auto const begin = std::max(origin.x, 0);
+		auto const end = std::min(origin.x + count, size().x);
+
+		write_row(origin.y, begin, end, [&] (std::int32_t x, screen_cell const&) { return cells[x - origin.x]; });
+	}
+
+	void screen_buffer::composite(bump::iaabb2 const& area, screen_cell const& base)
+	{
+		auto const extents = size();
+		auto const begin = glm::clamp(area.m_origin, glm::ivec2(0), extents);
+		auto const end = glm::clamp(area.m_origin + area.m_size, begin, extents);
+
+		for (auto y : bump::range(begin.y, end.y))
+		{
+			auto const row = std::size_t(y) * std::size_t(extents.x);
+
+			write_row(y, begin.x, end.x, [&] (std::int32_t x, screen_cell const&)
+			{
+				auto cell = base;
+
+				for (auto const& l : m_layers)
+					(void)l.apply(row + std::size_t(x), cell);
+
+				return cell;
+			});
+		}
+
+		for (auto& l : m_layers)
+			l.clear();
+	}
+
+	void screen_buffer::set(glm::ivec2 pos, screen_cell const& cell)
+	{
+		auto& current = m_data.at(pos);
+
+		if (current == cell)
+			return;
+
+		current = cell;
+		mark_dirty(pos.y, pos.x, pos.x + 1);
 	}
 
 	void screen_buffer::resize(glm::ivec2 size, screen_cell const& cell)
 	{
 		bump::die_if(size.x <= 0 || size.y <= 0);
 		m_data.resize(size, cell);
+
+		m_dirty_spans.assign(std::size_t(size.y), dirty_span());
+		mark_all_dirty();
+
+		for (auto& l : m_layers)
+			l.resize(size);
+	}
+
+	void screen_buffer::mark_dirty(std::int32_t row, std::int32_t begin, std::int32_t end)
+	{
+		auto& span = m_dirty_spans[std::size_t(row)];
+		span = span.empty() ? dirty_span{ begin, end } : dirty_span{ std::min(span.m_begin, begin), std::max(span.m_end, end) };
+
+		m_dirty_rows_begin = is_dirty() ? std::min(m_dirty_rows_begin, row) : row;
+		m_dirty_rows_end = std::max(m_dirty_rows_end, row + 1);
+	}
+
+	void screen_buffer::mark_all_dirty()
+	{
+		auto const extents = glm::ivec2(m_data.extents());
+
+		for (auto& span : m_dirty_spans)
+			span = { 0, extents.x };
+
+		m_dirty_rows_begin = 0;
+		m_dirty_rows_end = extents.y;
+	}
+
+	void screen_buffer::clear_dirty()
+	{
+		for (auto y : bump::range(m_dirty_rows_begin, m_dirty_rows_end))
+			m_dirty_spans[std::size_t(y)] = dirty_span();
+
+		m_dirty_rows_begin = 0;
+		m_dirty_rows_end = 0;
 	}
 
 	tile_renderable::tile_renderable(bump::gl::shader_program const& shader, bump::gl::texture_2d_array const& texture):
 		m_shader(&shader),
 		m_texture(&texture),
 		m_in_VertexPosition(shader.get_attribute_location("in_VertexPosition")),
-		m_in_TilePosition(shader.get_attribute_location("in_TilePosition")),
-		m_in_TileLayer(shader.get_attribute_location("in_TileLayer")),
-		m_in_TileFGColor(shader.get_attribute_location("in_TileFGColor")),
-		m_in_TileBGColor(shader.get_attribute_location("in_TileBGColor")),
+		m_in_TileInstance(shader.get_attribute_location("in_TileInstance")),
 		m_u_TileSize(shader.get_uniform_location("u_TileSize")),
+		m_u_BufferOrigin(shader.get_uniform_location("u_BufferOrigin")),
+		m_u_BufferSize(shader.get_uniform_location("u_BufferSize")),
 		m_u_TileTexture(shader.get_uniform_location("u_TileTexture")),
-		m_u_MVP(shader.get_uniform_location("u_MVP"))
+		m_u_MVP(shader.get_uniform_location("u_MVP")),
+		m_instance_count(0)
 	{
 		auto const vertices = { 0.f, 0.f,  1.f, 0.f,  1.f, 1.f,  0.f, 0.f,  1.f, 1.f,  0.f, 1.f, };
 		m_vertex_buffer.set_data(GL_ARRAY_BUFFER, vertices.begin(), 2, 6, GL_STATIC_DRAW);
 		m_vertex_array.set_array_buffer(m_in_VertexPosition, m_vertex_buffer);
 
-		m_tile_positions_buffer.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 2, 0, GL_STREAM_DRAW);
-		m_vertex_array.set_array_buffer(m_in_TilePosition, m_tile_positions_buffer, 1);
-
-		m_tile_layers_buffer.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 1, 0, GL_STREAM_DRAW);
-		m_vertex_array.set_array_buffer(m_in_TileLayer, m_tile_layers_buffer, 1);
-		
-		m_tile_fg_colors_buffer.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 3, 0, GL_STREAM_DRAW);
-		m_vertex_array.set_array_buffer(m_in_TileFGColor, m_tile_fg_colors_buffer, 1);
-		
-		m_tile_bg_colors_buffer.set_data(GL_ARRAY_BUFFER, (float*)nullptr, 3, 0, GL_STREAM_DRAW);
-		m_vertex_array.set_array_buffer(m_in_TileBGColor, m_tile_bg_colors_buffer, 1);
+		// (one interleaved buffer, read as a uvec3 per instance - see tile_instance)
+		m_tile_instances_buffer.set_data(GL_ARRAY_BUFFER, (std::uint32_t*)nullptr, 3, 0, GL_DYNAMIC_DRAW);
+		m_vertex_array.set_array_buffer(m_in_TileInstance, m_tile_instances_buffer, 1);
 	}
 	
-	void tile_renderable::render(
-		bump::gl::renderer& renderer,
-		bump::camera_matrices const& matrices,
-		tile_instance_data const& instances,
-		glm::vec2 tile_size_px)
+	void tile_renderable::set_instances(tile_instance_data const& instances)
 	{
-		auto const instance_count = instances.positions.size();
+		auto const instance_count = instances.size();
 
-		bump::die_if(instances.layers.size() != instance_count);
-		bump::die_if(instances.fg_colors.size() != instance_count);
-		bump::die_if(instances.bg_colors.size() != instance_count);
+		m_instance_count = instance_count;
 
 		if (instance_count == 0)
 			return;
 
-		m_tile_positions_buffer.set_data(GL_ARRAY_BUFFER, glm::value_ptr(instances.positions.front()), 2, instance_count, GL_STREAM_DRAW);
-		m_tile_layers_buffer.set_data(GL_ARRAY_BUFFER, instances.layers.data(), 1, instance_count, GL_STREAM_DRAW);
-		m_tile_fg_colors_buffer.set_data(GL_ARRAY_BUFFER, glm::value_ptr(instances.fg_colors.front()), 3, instance_count, GL_STREAM_DRAW);
-		m_tile_bg_colors_buffer.set_data(GL_ARRAY_BUFFER, glm::value_ptr(instances.bg_colors.front()), 3, instance_count, GL_STREAM_DRAW);
+		m_tile_instances_buffer.set_data(GL_ARRAY_BUFFER, &instances.instances.front().m_index_glyph, 3, instance_count, GL_DYNAMIC_DRAW);
+	}
+
+	void tile_renderable::update_instances(tile_instance_data const& instances, std::size_t first, std::size_t count)
+	{
+		bump::die_if(instances.size() != m_instance_count);
+		bump::die_if(first + count > m_instance_count);
+
+		if (count == 0)
+			return;
+
+		m_tile_instances_buffer.set_sub_data(GL_ARRAY_BUFFER, &instances.instances[first].m_index_glyph, first, count);
+	}
+
+	void tile_renderable::render(
+		bump::gl::renderer& renderer,
+		bump::camera_matrices const& matrices,
+		glm::vec2 tile_size_px,
+		glm::vec2 sb_origin_px,
+		glm::ivec2 sb_size_sb)
+	{
+		if (m_instance_count == 0)
+			return;
 
 		renderer.set_program(*m_shader);
 		renderer.set_texture_2d_array(0, *m_texture);
 		renderer.set_uniform_1i(m_u_TileTexture, 0);
 		renderer.set_uniform_2f(m_u_TileSize, tile_size_px);
+		renderer.set_uniform_2f(m_u_BufferOrigin, sb_origin_px);
+		renderer.set_uniform_2i(m_u_BufferSize, sb_size_sb);
 		renderer.set_uniform_4x4f(m_u_MVP, matrices.model_view_projection_matrix(glm::identity<glm::mat4>()));
 		renderer.set_vertex_array(m_vertex_array);
 
-		renderer.draw_arrays(GL_TRIANGLES, m_vertex_buffer.get_element_count(), instance_count);
+		renderer.draw_arrays(GL_TRIANGLES, m_vertex_buffer.get_element_count(), m_instance_count);
 
 		renderer.clear_vertex_array();
 		renderer.clear_program();
 	}
 
+	bool tile_border_instance_data::set(std::size_t cell, glm::vec2 position, float width, glm::vec3 color)
+	{
+		auto& instance = cell_instances[cell];
+
+		if (instance == NO_INSTANCE)
+		{
+			instance = std::uint32_t(positions.size());
+			positions.push_back(position);
+			widths.push_back(width);
+			colors.push_back(color);
+			instance_cells.push_back(std::uint32_t(cell));
+			return true;
+		}
+
+		if (positions[instance] == position && widths[instance] == width && colors[instance] == color)
+			return false;
+
+		positions[instance] = position;
+		widths[instance] = width;
+		colors[instance] = color;
+		return true;
+	}
+
+	bool tile_border_instance_data::remove(std::size_t cell)
+	{
+		auto const instance = cell_instances[cell];
+
+		if (instance == NO_INSTANCE)
+			return false;
+
+		// move the last instance into the gap
+		auto const last = std::uint32_t(positions.size() - 1);
+		auto const last_cell = instance_cells[last];
+
+		positions[instance] = positions[last];
+		widths[instance] = widths[last];
+		colors[instance] = colors[last];
+		instance_cells[instance] = last_cell;
+		cell_instances[last_cell] = instance;
+
+		positions.pop_back();
+		widths.pop_back();
+		colors.pop_back();
+		instance_cells.pop_back();
+		cell_instances[cell] = NO_INSTANCE;
+
+		return true;
+	}
+
 	tile_border_renderable::tile_border_renderable(bump::gl::shader_program const& shader):
 		m_shader(&shader),
 		m_in_VertexPosition(shader.get_attribute_location("in_VertexPosition")),
@@ -105,7 +285,8 @@ namespace rog
 		m_in_BorderWidth(shader.get_attribute_location("in_BorderWidth")),
 		m_in_BorderColor(shader.get_attribute_location("in_BorderColor")),
 		m_u_TileSize(shader.get_uniform_location("u_TileSize")),
-		m_u_MVP(shader.get_uniform_location("u_MVP"))
+		m_u_MVP(shader.get_uniform_location("u_MVP")),
+		m_instance_count(0)
 	{
 		auto const vertices =
 		{
@@ -139,30 +320,37 @@ namespace rog
 		m_vertex_array.set_array_buffer(m_in_BorderColor, m_border_colors_buffer, 1);
 	}
 
-	void tile_border_renderable::render(
-		bump::gl::renderer& renderer,
-		bump::camera_matrices const& matrices,
-		tile_border_instance_data const& instances,
-		glm::vec2 tile_size_px)
+	void tile_border_renderable::set_instances(tile_border_instance_data const& instances)
 	{
 		auto const instance_count = instances.positions.size();
 
 		bump::die_if(instances.widths.size() != instance_count);
 		bump::die_if(instances.colors.size() != instance_count);
 
+		m_instance_count = instance_count;
+
 		if (instance_count == 0)
 			return;
 
 		m_border_positions_buffer.set_data(GL_ARRAY_BUFFER, glm::value_ptr(instances.positions.front()), 2, instance_count, GL_STREAM_DRAW);
 		m_border_widths_buffer.set_data(GL_ARRAY_BUFFER, &instances.widths.front(), 1, instance_count, GL_STREAM_DRAW);
 		m_border_colors_buffer.set_data(GL_ARRAY_BUFFER, glm::value_ptr(instances.colors.front()), 3, instance_count, GL_STREAM_DRAW);
+	}
+
+	void tile_border_renderable::render(
+		bump::gl::renderer& renderer,
+		bump::camera_matrices const& matrices,
+		glm::vec2 tile_size_px)
+	{
+		if (m_instance_count == 0)
+			return;
 
 		renderer.set_program(*m_shader);
 		renderer.set_uniform_2f(m_u_TileSize, tile_size_px);
 		renderer.set_uniform_4x4f(m_u_MVP, matrices.model_view_projection_matrix(glm::identity<glm::mat4>()));
 		renderer.set_vertex_array(m_vertex_array);
 
-		renderer.draw_arrays(GL_TRIANGLES, m_vertex_buffer.get_element_count(), instance_count);
+		renderer.draw_arrays(GL_TRIANGLES, m_vertex_buffer.get_element_count(), m_instance_count);
 
 		renderer.clear_vertex_array();
 		renderer.clear_program();
@@ -188,10 +376,16 @@ namespace rog
 		m_window_size_px = window_size_px;
 		m_tile_size_px = tile_size_px;
 
-		m_buffer.resize(window_size_px / tile_size_px, screen_cell_debug);
+		auto const sb_size_sb = window_size_px / tile_size_px;
+		bump::die_if(std::size_t(sb_size_sb.x) * std::size_t(sb_size_sb.y) > std::size_t{ tile_instance::MAX_CELL_INDEX } + 1);
 
-		auto const sb_size_px = tile_size_px * glm::ivec2(m_buffer.m_data.extents());
+		m_buffer.resize(sb_size_sb, screen_cell_debug);
+
+		auto const sb_size_px = tile_size_px * m_buffer.size();
 		m_sb_area_px = { (window_size_px - sb_size_px) / glm::ivec2(2), sb_size_px };
+
+		// (the number of cells may have changed, so all the instances are uploaded again on the next render)
+		m_tile_instances.clear();
 	}
 
 	namespace
@@ -209,80 +403,165 @@ namespace rog
 			return bump::camera_matrices(camera);
 		}
 		
-		void prepare_tile_instances(screen_buffer const& buffer, bump::iaabb2 const& sb_area_px, glm::ivec2 tile_size_px, glm::ivec2 sb_size_sb, tile_instance_data& instances)
+		void reset_instances(screen_buffer const& buffer, tile_instance_data& tile_instances, tile_border_instance_data& border_instances)
+		{
+			// (there is one tile instance per cell, in the same order as the cells in the buffer)
+			auto const cell_count = std::size_t(buffer.size().x) * std::size_t(buffer.size().y);
+
+			tile_instances.instances.resize(cell_count);
+
+			border_instances.clear();
+			border_instances.cell_instances.assign(cell_count, tile_border_instance_data::NO_INSTANCE);
+		}
+
+		// encodes the tile and border instances for the cells in [first, last) in one pass, returning true if the border instances changed
+		bool encode_cells(
+			screen_buffer const& buffer, std::size_t first, std::size_t last,
+			bump::iaabb2 const& sb_area_px, glm::ivec2 tile_size_px,
+			tile_instance_data& tile_instances, tile_border_instance_data& border_instances)
 		{
-			instances.clear();
-			instances.reserve(buffer.m_data.size());
+			auto const sb_size_sb = buffer.size();
+			auto const width = std::size_t(sb_size_sb.x);
+			auto borders_changed = false;
 
-			for (auto y : bump::range(0, buffer.m_data.extents().y))
+			for (auto i : bump::range(first, last))
 			{
-				for (auto x : bump::range(0, buffer.m_data.extents().x))
+				auto const& cell = buffer.at(i);
+
+				tile_instances.instances[i] = tile_instance::encode(i, cell);
+
+				if (cell.m_border_width == 0)
 				{
-					auto const& cell = buffer.m_data.at({ x, y });
-
-					auto const pos_sb = glm::ivec2{ x, y };
-					auto const pos_px = buffer_cell_to_screen_px(pos_sb, sb_area_px.m_origin, tile_size_px, sb_size_sb);
-					
-					instances.positions.push_back(glm::vec2(pos_px));
-					instances.layers.push_back(static_cast<float>(cell.m_value));
-					instances.fg_colors.push_back(cell.m_fg);
-					instances.bg_colors.push_back(cell.m_bg);
+					borders_changed |= border_instances.remove(i);
+					continue;
 				}
+
+				auto const pos_sb = glm::ivec2{ int(i % width), int(i / width) };
+				auto const pos_px = buffer_cell_to_screen_px(pos_sb, sb_area_px.m_origin, tile_size_px, sb_size_sb);
+
+				borders_changed |= border_instances.set(i, glm::vec2(pos_px), static_cast<float>(cell.m_border_width), cell.m_border.to_vec3());
 			}
+
+			return borders_changed;
 		}
 
-		void prepare_tile_border_instances(screen_buffer const& buffer, bump::iaabb2 const& sb_area_px, glm::ivec2 tile_size_px, glm::ivec2 sb_size_sb, tile_border_instance_data& instances)
+		// re-encodes the dirty cells and uploads their tile instances, returning the number of tile instances uploaded
+		std::size_t update_dirty_instances(
+			screen_buffer const& buffer, bump::iaabb2 const& sb_area_px, glm::ivec2 tile_size_px,
+			tile_instance_data& tile_instances, tile_renderable& tile_renderable,
+			tile_border_instance_data& border_instances, bool& borders_changed)
 		{
-			instances.clear();
-			instances.reserve(buffer.m_data.size());
+			auto const width = std::size_t(buffer.size().x);
+			auto uploaded = std::size_t{ 0 };
+
+			// dirty spans on nearby rows are merged into one upload (it's cheaper to upload a few clean cells than to make another call)
+			auto first = std::size_t{ 0 };
+			auto last = std::size_t{ 0 };
 
-			for (auto y : bump::range(0, buffer.m_data.extents().y))
+			auto const flush = [&] ()
 			{
-				for (auto x : bump::range(0, buffer.m_data.extents().x))
-				{
-					auto const& cell = buffer.m_data.at({ x, y });
+				if (first == last)
+					return;
 
-					auto const pos_sb = glm::ivec2{ x, y };
-					auto const pos_px = buffer_cell_to_screen_px(pos_sb, sb_area_px.m_origin, tile_size_px, sb_size_sb);
+				borders_changed |= encode_cells(buffer, first, last, sb_area_px, tile_size_px, tile_instances, border_instances);
+				tile_renderable.update_instances(tile_instances, first, last - first);
+				uploaded += last - first;
+			};
+
+			for (auto y : bump::range(buffer.dirty_rows_begin(), buffer.dirty_rows_end()))
+			{
+				auto const span = buffer.get_dirty_span(y);
 
-					if (cell.m_border_width > 0)
-					{
-						instances.positions.push_back(glm::vec2(pos_px));
-						instances.widths.push_back(static_cast<float>(cell.m_border_width));
-						instances.colors.push_back(cell.m_border);
-					}
+				if (span.empty())
+					continue;
+
+				auto const span_first = std::size_t(y) * width + std::size_t(span.m_begin);
+				auto const span_last = std::size_t(y) * width + std::size_t(span.m_end);
+
+				if (first != last && span_first - last < width)
+				{
+					last = span_last;
+					continue;
 				}
+
+				flush();
+
+				first = span_first;
+				last = span_last;
 			}
+
+			flush();
+
+			return uploaded;
 		}
 
 	} // unnamed
 
 	void screen::render(bump::gl::renderer& renderer)
 	{
+		auto const zone = bump::trace::zone("screen::render");
+
 		auto const matrices = prepare_camera(glm::vec2(m_window_size_px));
 
-		prepare_tile_instances(m_buffer, m_sb_area_px, m_tile_size_px, m_buffer.size(), m_tile_instances);
-		m_tile_renderable.render(renderer, matrices, m_tile_instances, glm::vec2(m_tile_size_px));
+		// only the cells that changed since the last render are encoded and uploaded (so an unchanged frame just draws)
+		auto uploaded = std::size_t{ 0 };
+		auto borders_changed = false;
+
+		if (m_tile_instances.empty())
+		{
+			reset_instances(m_buffer, m_tile_instances, m_tile_border_instances);
+			encode_cells(m_buffer, 0, m_tile_instances.size(), m_sb_area_px, m_tile_size_px, m_tile_instances, m_tile_border_instances);
+			m_tile_renderable.set_instances(m_tile_instances);
+			uploaded += m_tile_instances.size();
+			borders_changed = true;
+		}
+		else if (m_buffer.is_dirty())
+		{
+			uploaded += update_dirty_instances(m_buffer, m_sb_area_px, m_tile_size_px, m_tile_instances, m_tile_renderable, m_tile_border_instances, borders_changed);
+		}
+
+		// (the border instances are a short list of just the cells with borders, so it's uploaded whole when it changes)
+		if (borders_changed)
+		{
+			m_tile_border_renderable.set_instances(m_tile_border_instances);
+			uploaded += m_tile_border_instances.positions.size();
+		}
+
+		m_buffer.clear_dirty();
+
+		m_tile_renderable.render(renderer, matrices, glm::vec2(m_tile_size_px), glm::vec2(m_sb_area_px.m_origin), m_buffer.size());
+
+		// (nothing is drawn if no cell has a border)
+		if (!m_tile_border_instances.positions.empty())
+			m_tile_border_renderable.render(renderer, matrices, glm::vec2(m_tile_size_px));
 
-		prepare_tile_border_instances(m_buffer, m_sb_area_px, m_tile_size_px, m_buffer.size(), m_tile_border_instances);
-		m_tile_border_renderable.render(renderer, matrices, m_tile_border_instances, glm::vec2(m_tile_size_px));
+		static auto& instances_uploaded = bump::metrics::get_gauge("screen.instances_uploaded");
+		instances_uploaded.set(std::int64_t(uploaded));
 	}
 
 	
 	void draw_map(screen_buffer& sb, level const& level, bump::iaabb2 const& map_panel_sb, bump::iaabb2 const& map_panel_lv)
 	{
-		auto const min = map_panel_lv.m_origin;
-		auto const max = min + map_panel_lv.m_size;
+		auto min = map_panel_lv.m_origin;
+		auto max = min + map_panel_lv.m_size;
 
-		for (auto y : bump::range(min.y, max.y))
+		// only draw what the player can see
+		auto const fov = level.m_fov.find(level.m_player);
+
+		if (fov)
 		{
-			for (auto x : bump::range(min.x, max.x))
-			{
-				auto const pos_lv = glm::ivec2{ x, y };
-				auto const pos_sb = panel_cell_to_buffer_cell(map_coords_to_panel_cell(pos_lv, map_panel_lv.m_origin), map_panel_sb.m_origin);
-				sb.m_data.at(pos_sb) = level.m_grid.at(pos_lv).m_cell;
-			}
+			auto const fov_bounds = fov->bounds();
+			min = glm::max(min, fov_bounds.m_origin);
+			max = glm::min(max, fov_bounds.m_origin + fov_bounds.m_size);
 		}
+
+		// (the visible area is copied a row at a time, so the coordinates are only converted once)
+		auto const origin_sb = panel_cell_to_buffer_cell(map_coords_to_panel_cell(min, map_panel_lv.m_origin), map_panel_sb.m_origin);
+
+		sb.layer(screen_layer_id::TERRAIN).blit(level.m_grid, { min, max - min }, origin_sb, [&] (feature const& f, glm::ivec2 pos_lv)
+		{
+			return (!fov || fov->is_visible(pos_lv)) ? std::optional<screen_cell>(f.m_cell) : std::nullopt;
+		});
 	}
 
 	void draw_player(screen_buffer& sb, level const& level, bump::iaabb2 const& map_panel_sb, bump::iaabb2 const& map_panel_lv)
@@ -294,11 +573,12 @@ namespace rog
 
 		auto const player_pos_pn = map_coords_to_panel_cell(pp.m_pos, map_panel_lv.m_origin);
 		auto const player_pos_sb = panel_cell_to_buffer_cell(player_pos_pn, map_panel_sb.m_origin);
-		sb.m_data.at(player_pos_sb) = pv.m_cell;
+		sb.layer(screen_layer_id::ACTORS).set(player_pos_sb, pv.m_cell);
 	}
 
 	void draw_monsters(screen_buffer& sb, level const& level, bump::iaabb2 const& map_panel_sb, bump::iaabb2 const& map_panel_lv)
 	{
+		auto const fov = level.m_fov.find(level.m_player);
 		auto view = level.m_registry.view<c_position const, c_visual const, c_monster_tag const>();
 
 		for (auto const m : view)
@@ -310,9 +590,12 @@ namespace rog
 			if (!map_panel_lv.contains(pos_lv))
 				continue;
 
+			if (fov && !fov->is_visible(pos_lv))
+				continue;
+
 			auto const pos_pn = map_coords_to_panel_cell(pos.m_pos, map_panel_lv.m_origin);
 			auto const pos_sb = panel_cell_to_buffer_cell(pos_pn, map_panel_sb.m_origin);
-			sb.m_data.at(pos_sb) = vis.m_cell;
+			sb.layer(screen_layer_id::ACTORS).set(pos_sb, vis.m_cell);
 		}
 	}
 
@@ -325,7 +608,7 @@ namespace rog
 
 			auto const p_pn = map_coords_to_panel_cell(p, map_panel_lv.m_origin);
 			auto const p_sb = panel_cell_to_buffer_cell(p_pn, map_panel_sb.m_origin);
-			sb.m_data.at(p_sb).m_bg = colors::dark_red;
+			sb.layer(screen_layer_id::OVERLAYS).set_bg(p_sb, colors::dark_red);
 		}
 	}
 
@@ -341,7 +624,7 @@ namespace rog
 
 		auto const ht_pn = map_coords_to_panel_cell(ht, map_panel_lv.m_origin);
 		auto const ht_sb = panel_cell_to_buffer_cell(ht_pn, map_panel_sb.m_origin);
-		sb.m_data.at(ht_sb).m_bg = colors::orange;
+		sb.layer(screen_layer_id::OVERLAYS).set_bg(ht_sb, colors::orange);
 	}
 
 	void draw_level(screen_buffer& sb, level const& level, bump::iaabb2 const& map_panel_sb)
@@ -353,6 +636,8 @@ namespace rog
 		draw_monsters(sb, level, map_panel_sb, map_panel_lv);
 		draw_queued_path(sb, level, map_panel_sb, map_panel_lv);
 		draw_hovered_tile(sb, level, map_panel_sb, map_panel_lv);
+
+		sb.composite(map_panel_sb);
 	}
 
 } // rog
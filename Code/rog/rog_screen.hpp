@@ -7,8 +7,15 @@
 #include <bump_gl.hpp>
 #include <bump_grid.hpp>
 #include <bump_math.hpp>
+#include <bump_range.hpp>
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
 
 namespace bump { class app; }
 namespace rog { struct level; }
@@ -16,40 +23,284 @@ namespace rog { struct level; }
 namespace rog
 {
 
+	/* packed_color
+	 *
+	 * A color quantised to 8 bits per channel, packed as RGBA with red in
+	 * the low byte (as unpackUnorm4x8() expects in the shaders). Colors
+	 * are converted once, when they're written to a cell, so encoding the
+	 * cells for drawing is just a copy.
+	 *
+	 */
+	struct packed_color
+	{
+		constexpr packed_color() = default;
+		constexpr packed_color(glm::vec3 color):
+			m_rgba(pack_channel(color.x) | (pack_channel(color.y) << 8) | (pack_channel(color.z) << 16) | (0xffu << 24)) { }
+
+		glm::vec3 to_vec3() const { return glm::vec3(float(m_rgba & 0xffu), float((m_rgba >> 8) & 0xffu), float((m_rgba >> 16) & 0xffu)) / 255.f; }
+
+		std::uint32_t m_rgba = 0xff000000u;
+
+		bool operator==(packed_color const&) const = default;
+
+	private:
+
+		static constexpr std::uint32_t pack_channel(float c) { return std::uint32_t(std::clamp(c, 0.f, 1.f) * 255.f + 0.5f); }
+	};
+
 	struct screen_cell
 	{
 		std::uint8_t m_value = ' ';
-		glm::vec3 m_fg = glm::vec3(1.f);
-		glm::vec3 m_bg = glm::vec3(0.f);
-		glm::vec3 m_border = glm::vec3(0.f);
+		packed_color m_fg = glm::vec3(1.f);
+		packed_color m_bg = glm::vec3(0.f);
+		packed_color m_border = glm::vec3(0.f);
 		std::uint32_t m_border_width = 0;
+
+		bool operator==(screen_cell const&) const = default;
 	};
 
 	auto static constexpr screen_cell_blank = screen_cell{ ' ', colors::white, colors::black, colors::black, 0 };
 	auto static constexpr screen_cell_debug = screen_cell{ '#', colors::violet, colors::dark_red, colors::violet, 1 };
 
-	struct screen_buffer
+	namespace detail
 	{
+
+		// clips a blit of `src_area` to `dst_origin` to the extents of the source and the destination, returning the clipped source area and destination origin
+		inline std::pair<bump::iaabb2, glm::ivec2> clip_blit(glm::ivec2 src_extents, bump::iaabb2 const& src_area, glm::ivec2 dst_extents, glm::ivec2 dst_origin)
+		{
+			auto const offset = dst_origin - src_area.m_origin;
+			auto const src_min = glm::max(glm::max(src_area.m_origin, glm::ivec2(0)), -offset);
+			auto const src_max = glm::min(glm::min(src_area.m_origin + src_area.m_size, src_extents), dst_extents - offset);
+
+			return { { src_min, glm::max(src_max - src_min, glm::ivec2(0)) }, src_min + offset };
+		}
+
+	} // detail
+
+	enum class screen_layer_id { TERRAIN, ACTORS, OVERLAYS };
+
+	/* screen_layer
+	 *
+	 * One layer of cells, drawn over the layers below it when the layers
+	 * are composited (see screen_buffer::composite()). Each cell of the
+	 * layer is either empty (so the layers below show through), a whole
+	 * cell, or just a background color (e.g. to highlight a tile).
+	 *
+	 */
+	class screen_layer
+	{
+	public:
+
+		glm::ivec2 size() const { return m_size; }
+		void resize(glm::ivec2 size);
+		void clear();
+
+		void set(glm::ivec2 pos, screen_cell const& cell);
+		void set_bg(glm::ivec2 pos, packed_color bg);
+
+		// sets the cells of the layer from `src_area` of `src` (see screen_buffer::blit())
+		template<class GridT, class F>
+		void blit(GridT const& src, bump::iaabb2 const& src_area, glm::ivec2 dst_origin, F&& transform);
+
+		// draws the layer's cell at `index` (in row order) over `cell`, returning false if it's empty
+		bool apply(std::size_t index, screen_cell& cell) const;
+
+	private:
+
+		enum class cell_type : std::uint8_t { EMPTY, CELL, BG };
+
+		std::size_t to_index(glm::ivec2 pos) const { return std::size_t(pos.y) * std::size_t(m_size.x) + std::size_t(pos.x); }
+
+		glm::ivec2 m_size = glm::ivec2(0);
+		std::vector<screen_cell> m_cells;
+		std::vector<cell_type> m_types;
+	};
+
+	template<class GridT, class F>
+	void screen_layer::blit(GridT const& src, bump::iaabb2 const& src_area, glm::ivec2 dst_origin, F&& transform)
+	{
+		auto const [area, origin] = detail::clip_blit(glm::ivec2(src.extents()), src_area, m_size, dst_origin);
+
+		for (auto y : bump::range(0, area.m_size.y))
+		{
+			auto const row = to_index({ origin.x, origin.y + y });
+
+			for (auto x : bump::range(0, area.m_size.x))
+			{
+				auto const src_pos = area.m_origin + glm::ivec2{ x, y };
+				auto const cell = std::optional<screen_cell>(transform(src.at(src_pos), src_pos));
+
+				if (!cell.has_value())
+					continue;
+
+				m_cells[row + std::size_t(x)] = cell.value();
+				m_types[row + std::size_t(x)] = cell_type::CELL;
+			}
+		}
+	}
+
+	/* screen_buffer
+	 *
+	 * The cells to draw. Writes that change a cell mark it dirty (as a
+	 * span of columns per row), so only the cells that changed since the
+	 * last clear_dirty() need to be encoded and uploaded again.
+	 *
+	 */
+	class screen_buffer
+	{
+	public:
+
+		struct dirty_span
+		{
+			std::int32_t m_begin = 0;
+			std::int32_t m_end = 0;
+
+			bool empty() const { return m_begin >= m_end; }
+		};
+
 		void fill(screen_cell const& cell);
 		void fill_rect(glm::ivec2 origin, glm::ivec2 size, screen_cell const& cell);
 
+		// writes `count` cells to the row from `origin` (clipped to the buffer)
+		void set_span(glm::ivec2 origin, screen_cell const* cells, std::int32_t count);
+
+		/* blit()
+		 *
+		 * Writes `transform(src.at(pos), pos)` to the buffer for each `pos`
+		 * in `src_area` of the grid `src`, with the top-left of the area at
+		 * `dst_origin` in the buffer (clipped to both). The transform can
+		 * return a screen_cell, or an optional one (std::nullopt leaves the
+		 * buffer's cell as it is).
+		 *
+		 */
+		template<class GridT, class F>
+		void blit(GridT const& src, bump::iaabb2 const& src_area, glm::ivec2 dst_origin, F&& transform);
+
+		/* layer(), composite()
+		 *
+		 * Cells can also be drawn into a stack of layers (terrain, actors,
+		 * then overlays), so a cell can be drawn several times in one
+		 * frame. composite() then draws the layers over `area` of the
+		 * buffer, writing each cell once, and clears the layers. The layers
+		 * are drawn over `base`, so cells that no layer draws are reset to
+		 * it (rather than keeping the last frame's contents).
+		 *
+		 */
+		screen_layer& layer(screen_layer_id id) { return m_layers[std::size_t(id)]; }
+		void composite(bump::iaabb2 const& area, screen_cell const& base = screen_cell_blank);
+
+		screen_cell const& at(glm::ivec2 pos) const { return m_data.at(pos); }
+		screen_cell const& at(std::size_t index) const { return m_data.at(static_cast<grid_type::size_type>(index)); }
+		void set(glm::ivec2 pos, screen_cell const& cell);
+
 		glm::ivec2 size() const { return glm::ivec2(m_data.extents()); }
 		void resize(glm::ivec2 size, screen_cell const& cell);
 
 		bool in_bounds(glm::ivec2 pos) const { return bump::iaabb2{ { 0, 0 }, m_data.extents() }.contains(pos); }
 
-		bump::grid2<screen_cell, glm::ivec2> m_data;
+		bool is_dirty() const { return m_dirty_rows_begin < m_dirty_rows_end; }
+		std::int32_t dirty_rows_begin() const { return m_dirty_rows_begin; }
+		std::int32_t dirty_rows_end() const { return m_dirty_rows_end; }
+		dirty_span get_dirty_span(std::int32_t row) const { return m_dirty_spans[std::size_t(row)]; }
+
+		void mark_dirty(std::int32_t row, std::int32_t begin, std::int32_t end);
+		void mark_all_dirty();
+		void clear_dirty();
+
+	private:
+
+		// writes `get_cell(x, current)` to each cell in [x_begin, x_end) of row y that it changes (std::nullopt leaves the cell as it is)
+		template<class F>
+		void write_row(std::int32_t y, std::int32_t x_begin, std::int32_t x_end, F&& get_cell);
+
+		using grid_type = bump::grid2<screen_cell, glm::ivec2>;
+
+		grid_type m_data;
+
+		std::vector<dirty_span> m_dirty_spans; // (per row)
+		std::int32_t m_dirty_rows_begin = 0;
+		std::int32_t m_dirty_rows_end = 0;
+
+		std::array<screen_layer, 3> m_layers; // (indexed by screen_layer_id)
 	};
+
+	template<class F>
+	void screen_buffer::write_row(std::int32_t y, std::int32_t x_begin, std::int32_t x_end, F&& get_cell)
+	{
+		if (x_begin >= x_end)
+			return;
+
+		// (the row is found once, rather than working out the index of every cell)
+		auto* row = &m_data.at({ 0, y });
+
+		// (only the changed part of the row is marked dirty)
+		auto changed_begin = x_end;
+		auto changed_end = x_begin;
+
+		for (auto x : bump::range(x_begin, x_end))
+		{
+			auto const cell = std::optional<screen_cell>(get_cell(x, row[x]));
+
+			if (!cell.has_value() || row[x] == cell.value())
+				continue;
+
+			row[x] = cell.value();
+			changed_begin = std::min(changed_begin, x);
+			changed_end = x + 1;
+		}
+
+		if (changed_begin < changed_end)
+			mark_dirty(y, changed_begin, changed_end);
+	}
+
+	template<class GridT, class F>
+	void screen_buffer::blit(GridT const& src, bump::iaabb2 const& src_area, glm::ivec2 dst_origin, F&& transform)
+	{
+		auto const [area, origin] = detail::clip_blit(glm::ivec2(src.extents()), src_area, size(), dst_origin);
+		auto const offset = area.m_origin - origin;
+
+		for (auto y : bump::range(origin.y, origin.y + area.m_size.y))
+		{
+			write_row(y, origin.x, origin.x + area.m_size.x, [&] (std::int32_t x, screen_cell const&)
+			{
+				auto const src_pos = glm::ivec2{ x, y } + offset;
+				return transform(src.at(src_pos), src_pos);
+			});
+		}
+	}
 	
+	/* tile_instance
+	 *
+	 * One cell, as uploaded for drawing (12 bytes). The vertex shader
+	 * works out the tile position from the cell index (and the size and
+	 * origin of the buffer), so there are no positions to upload.
+	 *
+	 */
+	struct tile_instance
+	{
+		static constexpr auto MAX_CELL_INDEX = (std::uint32_t{ 1 } << 24) - 1;
+
+		std::uint32_t m_index_glyph; // (cell index in the low 24 bits, glyph in the high 8 bits)
+		std::uint32_t m_fg;
+		std::uint32_t m_bg;
+
+		static tile_instance encode(std::size_t index, screen_cell const& cell)
+		{
+			return { std::uint32_t(index) | (std::uint32_t(cell.m_value) << 24), cell.m_fg.m_rgba, cell.m_bg.m_rgba };
+		}
+	};
+
+	static_assert(sizeof(tile_instance) == 3 * sizeof(std::uint32_t));
+
 	struct tile_instance_data
 	{
-		std::vector<glm::vec2> positions;
-		std::vector<float> layers;
-		std::vector<glm::vec3> fg_colors;
-		std::vector<glm::vec3> bg_colors;
+		std::vector<tile_instance> instances;
 
-		void clear() { positions.clear(); layers.clear(); fg_colors.clear(); bg_colors.clear(); }
-		void reserve(std::size_t count) { positions.reserve(count); layers.reserve(count); fg_colors.reserve(count); bg_colors.reserve(count); }
+		std::size_t size() const { return instances.size(); }
+		bool empty() const { return instances.empty(); }
+
+		void clear() { instances.clear(); }
+		void reserve(std::size_t count) { instances.reserve(count); }
 	};
 
 	class tile_renderable
@@ -58,11 +309,17 @@ namespace rog
 
 		explicit tile_renderable(bump::gl::shader_program const& shader, bump::gl::texture_2d_array const& texture);
 
+		// uploads all the instances (reallocating the buffers)
+		void set_instances(tile_instance_data const& instances);
+		// uploads the instances in [first, first + count)
+		void update_instances(tile_instance_data const& instances, std::size_t first, std::size_t count);
+
 		void render(
 			bump::gl::renderer& renderer, 
 			bump::camera_matrices const& matrices,
-			tile_instance_data const& instances,
-			glm::vec2 tile_size_px);
+			glm::vec2 tile_size_px,
+			glm::vec2 sb_origin_px,
+			glm::ivec2 sb_size_sb);
 
 	private:
 
@@ -70,30 +327,44 @@ namespace rog
 		bump::gl::texture_2d_array const* m_texture;
 
 		GLint m_in_VertexPosition;
-		GLint m_in_TilePosition;
-		GLint m_in_TileLayer;
-		GLint m_in_TileFGColor;
-		GLint m_in_TileBGColor;
+		GLint m_in_TileInstance;
 		GLint m_u_TileSize;
+		GLint m_u_BufferOrigin;
+		GLint m_u_BufferSize;
 		GLint m_u_TileTexture;
 		GLint m_u_MVP;
 
 		bump::gl::buffer m_vertex_buffer;
-		bump::gl::buffer m_tile_positions_buffer;
-		bump::gl::buffer m_tile_layers_buffer;
-		bump::gl::buffer m_tile_fg_colors_buffer;
-		bump::gl::buffer m_tile_bg_colors_buffer;
+		bump::gl::buffer m_tile_instances_buffer;
 		bump::gl::vertex_array m_vertex_array;
+
+		std::size_t m_instance_count;
 	};
 
+	/* tile_border_instance_data
+	 *
+	 * Only the cells with borders have an instance. Instances are added,
+	 * changed and removed as cells are encoded (so the list never has to
+	 * be rebuilt from the whole buffer), and are in no particular order.
+	 *
+	 */
 	struct tile_border_instance_data
 	{
+		static constexpr auto NO_INSTANCE = std::numeric_limits<std::uint32_t>::max();
+
 		std::vector<glm::vec2> positions;
 		std::vector<float> widths;
 		std::vector<glm::vec3> colors;
 
-		void clear() { positions.clear(); widths.clear(); colors.clear(); }
-		void reserve(std::size_t count) { positions.reserve(count); widths.reserve(count); colors.reserve(count); }
+		std::vector<std::uint32_t> instance_cells; // (the cell of each instance)
+		std::vector<std::uint32_t> cell_instances; // (the instance of each cell, or NO_INSTANCE)
+
+		void clear() { positions.clear(); widths.clear(); colors.clear(); instance_cells.clear(); cell_instances.clear(); }
+		void reserve(std::size_t count) { positions.reserve(count); widths.reserve(count); colors.reserve(count); instance_cells.reserve(count); }
+
+		// (these return true if the instances changed)
+		bool set(std::size_t cell, glm::vec2 position, float width, glm::vec3 color);
+		bool remove(std::size_t cell);
 	};
 
 	class tile_border_renderable
@@ -102,10 +373,11 @@ namespace rog
 
 		explicit tile_border_renderable(bump::gl::shader_program const& shader);
 
+		void set_instances(tile_border_instance_data const& instances);
+
 		void render(
 			bump::gl::renderer& renderer,
 			bump::camera_matrices const& matrices,
-			tile_border_instance_data const& instances,
 			glm::vec2 tile_size_px);
 
 	private:
@@ -126,6 +398,8 @@ namespace rog
 		bump::gl::buffer m_border_widths_buffer;
 		bump::gl::buffer m_border_colors_buffer;
 		bump::gl::vertex_array m_vertex_array;
+
+		std::size_t m_instance_count;
 	};
 
 	/*
@@ -179,7 +453,7 @@ namespace rog
 			bump::gl::shader_program const& border_shader,
 			glm::ivec2 window_size_px, glm::ivec2 tile_size_px);
 
-		glm::ivec2 size() const { return m_buffer.m_data.extents(); }
+		glm::ivec2 size() const { return m_buffer.size(); }
 		glm::ivec2 tile_size() const { return m_tile_size_px; }
 
 		void resize(glm::ivec2 window_size_px, glm::ivec2 tile_size_px);
@@ -0,0 +1,211 @@
+#include "rog_screen.hpp"
+
+#include <bump_grid.hpp>
+
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <vector>
+
+namespace rog
+{
+
+	TEST(Test_rog_screen, screen_buffer_dirty_tracking)
+	{
+		auto sb = screen_buffer();
+		sb.resize({ 10, 5 }, screen_cell_blank);
+
+		// everything is dirty after a resize
+		EXPECT_TRUE(sb.is_dirty());
+		EXPECT_EQ(sb.dirty_rows_begin(), 0);
+		EXPECT_EQ(sb.dirty_rows_end(), 5);
+		EXPECT_EQ(sb.get_dirty_span(4).m_begin, 0);
+		EXPECT_EQ(sb.get_dirty_span(4).m_end, 10);
+
+		sb.clear_dirty();
+		EXPECT_FALSE(sb.is_dirty());
+
+		// writing the same cells again changes nothing
+		sb.fill(screen_cell_blank);
+		sb.set({ 3, 2 }, screen_cell_blank);
+		EXPECT_FALSE(sb.is_dirty());
+
+		auto cell = screen_cell_blank;
+		cell.m_value = '@';
+
+		sb.set({ 3, 2 }, cell);
+		sb.set({ 7, 2 }, cell);
+		sb.set({ 1, 4 }, cell);
+
+		EXPECT_TRUE(sb.is_dirty());
+		EXPECT_EQ(sb.dirty_rows_begin(), 2);
+		EXPECT_EQ(sb.dirty_rows_end(), 5);
+		EXPECT_EQ(sb.get_dirty_span(2).m_begin, 3);
+		EXPECT_EQ(sb.get_dirty_span(2).m_end, 8);
+		EXPECT_TRUE(sb.get_dirty_span(3).empty());
+		EXPECT_EQ(sb.get_dirty_span(4).m_begin, 1);
+		EXPECT_EQ(sb.get_dirty_span(4).m_end, 2);
+		EXPECT_EQ(sb.at({ 7, 2 }).m_value, '@');
+
+		sb.clear_dirty();
+
+		// only the cells that actually change are marked
+		sb.fill_rect({ 2, 1 }, { 20, 2 }, cell);
+
+		EXPECT_EQ(sb.dirty_rows_begin(), 1);
+		EXPECT_EQ(sb.dirty_rows_end(), 3);
+		EXPECT_EQ(sb.get_dirty_span(1).m_begin, 2);
+		EXPECT_EQ(sb.get_dirty_span(1).m_end, 10);
+		EXPECT_EQ(sb.get_dirty_span(2).m_begin, 2);
+		EXPECT_EQ(sb.get_dirty_span(2).m_end, 10);
+
+		sb.clear_dirty();
+		sb.fill_rect({ 3, 2 }, { 1, 1 }, cell);
+		EXPECT_FALSE(sb.is_dirty());
+	}
+
+	TEST(Test_rog_screen, spans_blits_and_layers)
+	{
+		auto sb = screen_buffer();
+		sb.resize({ 8, 4 }, screen_cell_blank);
+		sb.clear_dirty();
+
+		auto glyph = [] (std::uint8_t value) { auto cell = screen_cell_blank; cell.m_value = value; return cell; };
+
+		// spans are clipped to the buffer
+		auto const span = std::vector<screen_cell>{ glyph('a'), glyph('b'), glyph('c') };
+		sb.set_span({ -1, 1 }, span.data(), 3);
+		EXPECT_EQ(sb.at({ 0, 1 }).m_value, 'b');
+		EXPECT_EQ(sb.at({ 1, 1 }).m_value, 'c');
+		EXPECT_EQ(sb.get_dirty_span(1).m_begin, 0);
+		EXPECT_EQ(sb.get_dirty_span(1).m_end, 2);
+
+		// blits are clipped to the source and the buffer, and skip cells the transform returns nullopt for
+		auto src = bump::grid2<std::uint8_t, glm::ivec2>({ 4, 4 }, std::uint8_t{ 'x' });
+		src.at({ 1, 1 }) = 'o';
+
+		sb.blit(src, { { -2, 0 }, { 10, 10 } }, { 5, 0 }, [&] (std::uint8_t v, glm::ivec2 pos) -> std::optional<screen_cell>
+		{
+			return pos.x == 2 ? std::nullopt : std::optional<screen_cell>(glyph(v));
+		});
+
+		EXPECT_EQ(sb.at({ 7, 0 }).m_value, 'x'); // (src 0, 0)
+		EXPECT_EQ(sb.at({ 7, 2 }).m_value, 'x');
+		EXPECT_EQ(sb.at({ 6, 0 }).m_value, ' ');
+		EXPECT_EQ(sb.at({ 7, 1 }).m_value, 'x');
+
+		sb.blit(src, { { 0, 0 }, { 4, 4 } }, { 0, 0 }, [&] (std::uint8_t v, glm::ivec2) { return glyph(v); });
+		EXPECT_EQ(sb.at({ 1, 1 }).m_value, 'o');
+		EXPECT_EQ(sb.at({ 3, 3 }).m_value, 'x');
+
+		// layers are drawn bottom to top over the buffer, and cleared
+		sb.fill(screen_cell_blank);
+		sb.clear_dirty();
+
+		sb.layer(screen_layer_id::TERRAIN).set({ 1, 1 }, glyph('.'));
+		sb.layer(screen_layer_id::TERRAIN).set({ 2, 1 }, glyph('.'));
+		sb.layer(screen_layer_id::ACTORS).set({ 2, 1 }, glyph('@'));
+		sb.layer(screen_layer_id::OVERLAYS).set_bg({ 2, 1 }, colors::orange);
+		sb.layer(screen_layer_id::OVERLAYS).set_bg({ 3, 1 }, colors::dark_red);
+		sb.composite({ { 0, 0 }, { 8, 4 } });
+
+		EXPECT_EQ(sb.at({ 1, 1 }).m_value, '.');
+		EXPECT_EQ(sb.at({ 2, 1 }).m_value, '@');
+		EXPECT_EQ(sb.at({ 2, 1 }).m_bg, packed_color(colors::orange));
+		EXPECT_EQ(sb.at({ 3, 1 }).m_value, ' ');
+		EXPECT_EQ(sb.at({ 3, 1 }).m_bg, packed_color(colors::dark_red));
+		EXPECT_EQ(sb.dirty_rows_begin(), 1);
+		EXPECT_EQ(sb.dirty_rows_end(), 2);
+		EXPECT_EQ(sb.get_dirty_span(1).m_begin, 1);
+		EXPECT_EQ(sb.get_dirty_span(1).m_end, 4);
+
+		// cells no layer draws are reset to the base cell
+		sb.clear_dirty();
+		sb.layer(screen_layer_id::TERRAIN).set({ 1, 1 }, glyph('.'));
+		sb.layer(screen_layer_id::TERRAIN).set({ 2, 1 }, glyph('.'));
+		sb.composite({ { 0, 0 }, { 8, 4 } });
+
+		EXPECT_EQ(sb.at({ 2, 1 }).m_value, '.');
+		EXPECT_EQ(sb.at({ 2, 1 }).m_bg, packed_color(colors::black));
+		EXPECT_EQ(sb.at({ 3, 1 }), screen_cell_blank);
+		EXPECT_EQ(sb.get_dirty_span(1).m_begin, 2);
+		EXPECT_EQ(sb.get_dirty_span(1).m_end, 4);
+	}
+
+	TEST(Test_rog_screen, unchanged_frame_uploads_nothing)
+	{
+		auto sb = screen_buffer();
+		sb.resize({ 8, 4 }, screen_cell_blank);
+
+		auto glyph = [] (std::uint8_t value) { auto cell = screen_cell_blank; cell.m_value = value; return cell; };
+
+		auto const draw_frame = [&] (glm::ivec2 actor_pos)
+		{
+			for (auto y : bump::range(0, 3))
+				for (auto x : bump::range(0, 6))
+					sb.layer(screen_layer_id::TERRAIN).set({ x, y }, glyph('.'));
+
+			sb.layer(screen_layer_id::ACTORS).set(actor_pos, glyph('@'));
+			sb.composite({ { 0, 0 }, { 8, 4 } });
+		};
+
+		// (screen::render() only uploads instances for the dirty cells, then clears them)
+		draw_frame({ 2, 1 });
+		sb.clear_dirty();
+
+		draw_frame({ 2, 1 });
+		EXPECT_FALSE(sb.is_dirty());
+
+		draw_frame({ 3, 1 });
+		EXPECT_EQ(sb.dirty_rows_begin(), 1);
+		EXPECT_EQ(sb.dirty_rows_end(), 2);
+		EXPECT_EQ(sb.get_dirty_span(1).m_begin, 2);
+		EXPECT_EQ(sb.get_dirty_span(1).m_end, 4);
+	}
+
+	TEST(Test_rog_screen, tile_instance_encoding)
+	{
+		auto const c = packed_color(glm::vec3{ 1.f, 0.5f, 0.f });
+		EXPECT_EQ(c.m_rgba, 0xff0080ffu);
+		EXPECT_EQ(packed_color(glm::vec3(2.f)).m_rgba, 0xffffffffu); // (clamped)
+		EXPECT_NEAR(c.to_vec3().y, 0.5f, 1.f / 255.f);
+
+		auto cell = screen_cell_blank;
+		cell.m_value = '@';
+		cell.m_fg = colors::yellow;
+
+		auto const instance = tile_instance::encode(1234, cell);
+		EXPECT_EQ(instance.m_index_glyph & tile_instance::MAX_CELL_INDEX, 1234u);
+		EXPECT_EQ(instance.m_index_glyph >> 24, std::uint32_t{ '@' });
+		EXPECT_EQ(instance.m_fg, packed_color(colors::yellow).m_rgba);
+		EXPECT_EQ(instance.m_bg, packed_color(colors::black).m_rgba);
+	}
+
+	TEST(Test_rog_screen, sparse_border_instances)
+	{
+		auto borders = tile_border_instance_data();
+		borders.cell_instances.assign(10, tile_border_instance_data::NO_INSTANCE);
+
+		EXPECT_TRUE(borders.set(2, { 2.f, 0.f }, 1.f, colors::red));
+		EXPECT_TRUE(borders.set(5, { 5.f, 0.f }, 1.f, colors::red));
+		EXPECT_TRUE(borders.set(7, { 7.f, 0.f }, 1.f, colors::red));
+		EXPECT_FALSE(borders.set(5, { 5.f, 0.f }, 1.f, colors::red));
+		EXPECT_TRUE(borders.set(5, { 5.f, 0.f }, 2.f, colors::red));
+		EXPECT_FALSE(borders.remove(3));
+		ASSERT_EQ(borders.positions.size(), 3);
+
+		// removing moves the last instance into the gap
+		EXPECT_TRUE(borders.remove(2));
+		ASSERT_EQ(borders.positions.size(), 2);
+		EXPECT_EQ(borders.cell_instances[2], tile_border_instance_data::NO_INSTANCE);
+		EXPECT_EQ(borders.cell_instances[7], 0u);
+		EXPECT_EQ(borders.positions[0].x, 7.f);
+		EXPECT_EQ(borders.instance_cells[0], 7u);
+		EXPECT_EQ(borders.widths[borders.cell_instances[5]], 2.f);
+
+		EXPECT_TRUE(borders.remove(7));
+		EXPECT_TRUE(borders.remove(5));
+		EXPECT_TRUE(borders.positions.empty());
+	}
+
+} // rog
@@ -0,0 +1,210 @@
+#include "rog_screen_terminal.hpp"
+
+#include <bump_die.hpp>
+#include <bump_range.hpp>
+
+#include <algorithm>
+#include <charconv>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		void append_uint(std::string& out, std::uint32_t value)
+		{
+			char digits[10];
+			auto const end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+			out.append(digits, end);
+		}
+
+		void append_rgb(std::string& out, std::uint32_t rgba)
+		{
+			append_uint(out, rgba & 0xffu);
+			out += ';';
+			append_uint(out, (rgba >> 8) & 0xffu);
+			out += ';';
+			append_uint(out, (rgba >> 16) & 0xffu);
+		}
+
+		char to_ascii(std::uint8_t value)
+		{
+			return (value >= 0x20 && value < 0x7f) ? char(value) : '?';
+		}
+
+		std::size_t count_digits(std::int32_t value)
+		{
+			auto digits = std::size_t{ 1 };
+
+			while (value >= 10)
+			{
+				value /= 10;
+				++digits;
+			}
+
+			return digits;
+		}
+
+	} // unnamed
+
+	terminal_screen::terminal_screen(glm::ivec2 size, std::size_t frame_budget_bytes):
+		m_frame_budget_bytes(frame_budget_bytes),
+		m_first_row(0),
+		m_clear(true),
+		m_check_all_rows(true),
+		m_cursor(-1),
+		m_fg(0),
+		m_bg(0)
+	{
+		set_frame_budget(frame_budget_bytes);
+		resize(size);
+	}
+
+	void terminal_screen::resize(glm::ivec2 size)
+	{
+		m_buffer.resize(size, screen_cell_blank);
+		invalidate();
+	}
+
+	void terminal_screen::set_frame_budget(std::size_t bytes)
+	{
+		bump::die_if(bytes < MAX_CELL_BYTES);
+		m_frame_budget_bytes = bytes;
+	}
+
+	void terminal_screen::invalidate()
+	{
+		auto const size = m_buffer.size();
+		m_previous.assign(std::size_t(size.x) * std::size_t(size.y), terminal_cell());
+
+		m_first_row = 0;
+		m_clear = true;
+		m_check_all_rows = true;
+		m_cursor = glm::ivec2(-1);
+		m_fg = 0;
+		m_bg = 0;
+	}
+
+	void terminal_screen::move_cursor(std::string& out, glm::ivec2 pos, terminal_cell const* row)
+	{
+		if (m_cursor == pos)
+			return;
+
+		if (m_cursor.y == pos.y && m_cursor.x >= 0 && m_cursor.x < pos.x)
+		{
+			auto const gap = pos.x - m_cursor.x;
+
+			// short gaps of cells that are already the current colors are cheaper to write again than to skip
+			auto const reprint = std::size_t(gap) <= 3 + count_digits(gap) &&
+				std::all_of(row + m_cursor.x, row + pos.x, [&] (terminal_cell const& c) { return c.m_fg == m_fg && c.m_bg == m_bg; });
+
+			if (reprint)
+			{
+				for (auto x : bump::range(m_cursor.x, pos.x))
+					out += to_ascii(row[x].m_value);
+			}
+			else
+			{
+				out += "\x1b[";
+				append_uint(out, std::uint32_t(gap));
+				out += 'C';
+			}
+		}
+		else
+		{
+			// (the terminal's rows and columns start from 1)
+			out += "\x1b[";
+			append_uint(out, std::uint32_t(pos.y + 1));
+			out += ';';
+			append_uint(out, std::uint32_t(pos.x + 1));
+			out += 'H';
+		}
+
+		m_cursor = pos;
+	}
+
+	void terminal_screen::set_colors(std::string& out, std::uint32_t fg, std::uint32_t bg)
+	{
+		if (fg == m_fg && bg == m_bg)
+			return;
+
+		out += "\x1b[";
+
+		if (fg != m_fg)
+		{
+			out += "38;2;";
+			append_rgb(out, fg);
+		}
+
+		if (bg != m_bg)
+		{
+			if (fg != m_fg)
+				out += ';';
+
+			out += "48;2;";
+			append_rgb(out, bg);
+		}
+
+		out += 'm';
+
+		m_fg = fg;
+		m_bg = bg;
+	}
+
+	bool terminal_screen::render(std::string& out)
+	{
+		auto const frame_start = out.size();
+		auto const size = m_buffer.size();
+
+		if (!m_check_all_rows && !m_buffer.is_dirty())
+			return true;
+
+		if (m_clear)
+		{
+			out += "\x1b[0m\x1b[2J";
+			m_clear = false;
+		}
+
+		for (auto i : bump::range(0, size.y))
+		{
+			auto const y = (m_first_row + i) % size.y;
+			auto* const row = m_previous.data() + std::size_t(y) * std::size_t(size.x);
+
+			auto const span = m_check_all_rows ? screen_buffer::dirty_span{ 0, size.x } : m_buffer.get_dirty_span(y);
+
+			for (auto x : bump::range(span.m_begin, span.m_end))
+			{
+				auto const& cell = m_buffer.at({ x, y });
+				auto const next = terminal_cell{ cell.m_value, cell.m_fg.m_rgba, cell.m_bg.m_rgba };
+
+				if (row[x] == next)
+					continue;
+
+				if (out.size() - frame_start + MAX_CELL_BYTES > m_frame_budget_bytes)
+				{
+					m_first_row = y;
+					m_check_all_rows = true;
+					m_buffer.clear_dirty();
+					return false;
+				}
+
+				move_cursor(out, { x, y }, row);
+				set_colors(out, next.m_fg, next.m_bg);
+				out += to_ascii(next.m_value);
+
+				row[x] = next;
+
+				// (after writing the last column, where the cursor is depends on the terminal)
+				m_cursor = (x + 1 < size.x) ? glm::ivec2{ x + 1, y } : glm::ivec2(-1);
+			}
+		}
+
+		m_buffer.clear_dirty();
+		m_first_row = 0;
+		m_check_all_rows = false;
+
+		return true;
+	}
+
+} // rog
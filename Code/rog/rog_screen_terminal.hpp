@@ -0,0 +1,96 @@
+#pragma once
+
+#include "rog_screen.hpp"
+
+#include <bump_math.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rog
+{
+
+	/* terminal_screen
+	 *
+	 * Draws a screen_buffer to a VT100 style terminal with 24 bit color,
+	 * for running without OpenGL (e.g. over ssh, or in CI).
+	 *
+	 * It keeps the frame it last wrote, and only writes the cells that
+	 * differ from it (only looking at the buffer's dirty cells, so an
+	 * unchanged frame costs next to nothing). The cursor is only moved to
+	 * skip unchanged cells, and colors are only set when they change, so
+	 * a run of cells with the same colors is written as plain text.
+	 *
+	 * A frame is never larger than the frame budget. The changed cells
+	 * that don't fit are left for the next frames, which start from the
+	 * row where the last one stopped (so every row catches up).
+	 *
+	 * Glyphs outside printable ASCII are written as '?', and borders
+	 * aren't drawn.
+	 *
+	 */
+	class terminal_screen
+	{
+	public:
+
+		// (the most a single cell can take: moving the cursor, setting both colors, and the glyph)
+		static constexpr auto MAX_CELL_BYTES = std::size_t{ 64 };
+
+		explicit terminal_screen(glm::ivec2 size, std::size_t frame_budget_bytes = std::numeric_limits<std::size_t>::max());
+
+		glm::ivec2 size() const { return m_buffer.size(); }
+		void resize(glm::ivec2 size);
+
+		std::size_t frame_budget() const { return m_frame_budget_bytes; }
+		void set_frame_budget(std::size_t bytes);
+
+		// forgets what the terminal shows, so the next frame clears it and writes every cell
+		void invalidate();
+
+		/* render()
+		 *
+		 * Appends the next frame to `out`. Returns false if the frame budget
+		 * was reached before all the changed cells were written.
+		 *
+		 */
+		bool render(std::string& out);
+
+		screen_buffer& buffer() { return m_buffer; }
+		screen_buffer const& buffer() const { return m_buffer; }
+
+		// (to write before the first frame, and when done: hides / shows the cursor, and resets the colors)
+		static std::string_view enter_sequence() { return "\x1b[?25l"; }
+		static std::string_view leave_sequence() { return "\x1b[0m\x1b[?25h\r\n"; }
+
+	private:
+
+		struct terminal_cell
+		{
+			std::uint8_t m_value = 0;
+			std::uint32_t m_fg = 0;
+			std::uint32_t m_bg = 0; // (packed_color always has an alpha of 255, so 0 is never a color we've written)
+
+			bool operator==(terminal_cell const&) const = default;
+		};
+
+		void move_cursor(std::string& out, glm::ivec2 pos, terminal_cell const* row);
+		void set_colors(std::string& out, std::uint32_t fg, std::uint32_t bg);
+
+		screen_buffer m_buffer;
+		std::vector<terminal_cell> m_previous; // (what the terminal shows)
+		std::size_t m_frame_budget_bytes;
+		std::int32_t m_first_row;
+		bool m_clear;
+		bool m_check_all_rows; // (after an unfinished frame, the leftover changes aren't in the buffer's dirty spans)
+
+		// (the terminal's state, or -1 / 0 if unknown)
+		glm::ivec2 m_cursor;
+		std::uint32_t m_fg;
+		std::uint32_t m_bg;
+	};
+
+} // rog
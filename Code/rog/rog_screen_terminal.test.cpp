@@ -0,0 +1,78 @@
+#include "rog_screen_terminal.hpp"
+
+#include <bump_range.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace rog
+{
+
+	TEST(Test_rog_screen_terminal, diffed_output)
+	{
+		auto terminal = terminal_screen({ 8, 2 });
+		auto out = std::string();
+
+		// the first frame clears the terminal, and writes every cell
+		EXPECT_TRUE(terminal.render(out));
+		EXPECT_EQ(out, "\x1b[0m\x1b[2J\x1b[1;1H\x1b[38;2;255;255;255;48;2;0;0;0m        \x1b[2;1H        ");
+
+		// nothing changed
+		out.clear();
+		EXPECT_TRUE(terminal.render(out));
+		EXPECT_TRUE(out.empty());
+
+		// a run of cells with the same colors is plain text, and colors are only set when they change
+		// (a short gap in the current colors is written again rather than skipped)
+		auto cell = screen_cell_blank;
+		cell.m_value = 'a';
+		terminal.buffer().set({ 1, 0 }, cell);
+		cell.m_value = 'b';
+		terminal.buffer().set({ 2, 0 }, cell);
+		cell.m_fg = colors::red;
+		terminal.buffer().set({ 6, 0 }, cell);
+
+		out.clear();
+		EXPECT_TRUE(terminal.render(out));
+		EXPECT_EQ(out, "\x1b[1;2Hab   \x1b[38;2;191;0;0mb");
+
+		// a gap in other colors is skipped
+		cell.m_fg = colors::red;
+		cell.m_value = 'c';
+		terminal.buffer().set({ 0, 1 }, cell);
+		terminal.buffer().set({ 2, 1 }, cell);
+
+		out.clear();
+		EXPECT_TRUE(terminal.render(out));
+		EXPECT_EQ(out, "\x1b[2;1Hc\x1b[1Cc");
+	}
+
+	TEST(Test_rog_screen_terminal, frame_budget)
+	{
+		auto terminal = terminal_screen({ 40, 20 }, 256);
+		auto out = std::string();
+
+		// the first frame takes several frames to write
+		auto frames = 0;
+		auto total = std::size_t{ 0 };
+
+		for (auto done = false; !done; ++frames)
+		{
+			out.clear();
+			done = terminal.render(out);
+
+			EXPECT_LE(out.size(), terminal.frame_budget());
+			total += out.size();
+		}
+
+		EXPECT_GT(frames, 1);
+		EXPECT_GE(total, std::size_t{ 40 * 20 });
+
+		// and then there's nothing left to write
+		out.clear();
+		EXPECT_TRUE(terminal.render(out));
+		EXPECT_TRUE(out.empty());
+	}
+
+} // rog
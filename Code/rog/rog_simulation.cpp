@@ -0,0 +1,258 @@
+#include "rog_simulation.hpp"
+
+#include "rog_ecs.hpp"
+#include "rog_level_io.hpp"
+
+#include <bump_log.hpp>
+#include <bump_trace.hpp>
+
+#include <algorithm>
+#include <execution>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <variant>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		// fewer monsters than this choose their moves on this thread (it's not worth waking the others)
+		auto constexpr PARALLEL_MONSTER_TURNS = std::size_t{ 64 };
+
+	} // unnamed
+
+	simulation::simulation(std::uint64_t seed, std::int32_t depth, glm::ivec2 level_size, std::size_t memory_budget, std::filesystem::path swap_dir):
+		m_rng(seed),
+		m_dungeon(m_rng(), level_size, memory_budget, std::move(swap_dir)),
+		m_turn_seed(m_rng()),
+		m_depth(depth),
+		m_level(m_dungeon.enter(depth)),
+		m_turns(),
+		m_queued_action(),
+		m_actor_turn_count(0),
+		m_journal(),
+		m_monster_turns()
+	{
+		m_journal.m_seed = seed;
+		m_journal.m_depth = depth;
+		m_journal.m_level_size = level_size;
+
+		// only the actors whose turn it is are touched each cycle
+		m_turns.reset(m_level.m_registry);
+	}
+
+	simulation::cycle_result simulation::cycle()
+	{
+		auto const zone = bump::trace::zone("simulation::cycle");
+
+		auto result = cycle_result();
+
+		auto const& due_actors = m_turns.next_cycle(m_level.m_registry);
+
+		if (m_turns.is_due(m_level.m_player))
+		{
+			player_turn(result);
+
+			if (result.m_level_changed)
+				return result; // (the new level starts on the next cycle)
+		}
+
+		monster_turns(due_actors, result);
+
+		return result;
+	}
+
+	void simulation::queue_action(player_action action)
+	{
+		m_journal.m_entries.push_back({ cycle_count(), action });
+
+		m_queued_action.reset();
+		m_level.clear_queued_path();
+
+		if (std::holds_alternative<player_actions::travel>(action))
+		{
+			auto const& player_pos = m_level.m_registry.get<c_position>(m_level.m_player).m_pos;
+			auto const& dst = std::get<player_actions::travel>(action).m_dst;
+
+			if (m_level.in_bounds(dst))
+				(void)m_level.queue_path(player_pos, dst);
+
+			return;
+		}
+
+		m_queued_action = std::move(action);
+	}
+
+	std::uint64_t simulation::checksum()
+	{
+		// (energy is only kept up to date for the actors due this cycle)
+		m_turns.sync_energy(m_level.m_registry);
+
+		auto os = std::ostringstream();
+		bump::io::set_endian(os, std::endian::little);
+
+		bump::io::write(os, m_depth);
+		bump::io::write(os, cycle_count());
+		bump::io::write(os, random::rng_t(m_rng)());
+		write_level(os, m_level);
+
+		// FNV-1a (the same on every platform, unlike std::hash)
+		auto hash = std::uint64_t{ 0xcbf29ce484222325 };
+
+		for (auto c : std::move(os).str())
+			hash = (hash ^ std::uint8_t(c)) * std::uint64_t{ 0x100000001b3 };
+
+		return hash;
+	}
+
+	journal simulation::get_journal()
+	{
+		auto result = m_journal;
+		result.m_cycle_count = cycle_count();
+		result.m_checksum = checksum();
+		return result;
+	}
+
+	void simulation::player_turn(cycle_result& result)
+	{
+		result.m_player_turn = true;
+		++result.m_actor_turns;
+		++m_actor_turn_count;
+
+		if (m_queued_action.has_value())
+		{
+			auto action = std::move(m_queued_action.value());
+			m_queued_action.reset();
+
+			namespace pa = player_actions;
+
+			if (std::holds_alternative<pa::move>(action))
+			{
+				auto const& move = std::get<pa::move>(action);
+
+				auto& pos = m_level.m_registry.get<c_position>(m_level.m_player);
+				if (!m_level.move_actor(m_level.m_player, pos, move.m_dir))
+				{
+					bump::log_info("There is something in the way.");
+				}
+			}
+			else if (std::holds_alternative<pa::use_stairs>(action))
+			{
+				auto const& use_stairs = std::get<pa::use_stairs>(action);
+
+				if (player_can_use_stairs(m_level, use_stairs.m_dir))
+				{
+					change_depth(use_stairs.m_dir == stairs_direction::UP ? +1 : -1);
+					result.m_level_changed = true;
+					return;
+				}
+			}
+		}
+		else if (m_level.has_queued_path())
+		{
+			auto& pos = m_level.m_registry.get<c_position>(m_level.m_player);
+			auto const step = m_level.next_queued_step(pos.m_pos);
+			auto moved = false;
+
+			if (step.has_value())
+			{
+				moved = m_level.move_actor(m_level.m_player, pos, step.value());
+
+				// find a way around whatever is in the way, and take the first step of that instead
+				if (!moved && m_level.repair_queued_path(pos.m_pos, step.value()))
+					if (auto const detour = m_level.next_queued_step(pos.m_pos); detour.has_value())
+						moved = m_level.move_actor(m_level.m_player, pos, detour.value());
+			}
+
+			if (!moved && (step.has_value() || m_level.has_queued_path()))
+			{
+				bump::log_info("There is something in the way.");
+				m_level.clear_queued_path();
+			}
+		}
+
+		auto& player_actor = m_level.m_registry.get<c_actor>(m_level.m_player);
+		player_actor.take_turn_energy();
+		m_turns.end_turn(m_level.m_player, player_actor);
+	}
+
+	void simulation::monster_turns(std::vector<entt::entity> const& due_actors, cycle_result& result)
+	{
+		// recomputed only if the player moved or the terrain changed
+		m_level.m_distance_fields.update(m_level);
+
+		auto const player_pos = m_level.m_registry.get<c_position>(m_level.m_player).m_pos;
+
+		// the monsters taking a turn, in turn order
+		m_monster_turns.clear();
+
+		for (auto m : due_actors)
+		{
+			if (m == m_level.m_player || !m_level.m_registry.has<c_monster_tag, c_position>(m))
+				continue;
+
+			m_monster_turns.push_back({ m, m_level.m_registry.get<c_position>(m).m_pos, false, { } });
+
+			m_level.m_fov.add_viewer(m);
+		}
+
+		// every monster chooses its move from the level as it was at the start of the turn (nothing is changed, so this can be done in parallel)
+		auto const choose = [&] (monster_turn& t)
+		{
+			// monsters that can't see the player wait (their view is only recomputed when they move)
+			t.m_sees_player = m_level.update_fov(t.m_monster, t.m_pos, MONSTER_SIGHT_RADIUS).is_visible(player_pos);
+
+			if (!t.m_sees_player)
+				return;
+
+			// (each monster has its own random numbers for each cycle, so they don't depend on the order the moves are chosen in)
+			auto rng = random::entity_rng(m_turn_seed, t.m_monster, cycle_count());
+			auto const random_dir = direction(random::rand_range(rng, 0, 8));
+
+			t.m_intent = monster_choose_move(std::as_const(m_level), t.m_pos, random_dir);
+		};
+
+		if (m_monster_turns.size() >= PARALLEL_MONSTER_TURNS)
+			std::for_each(std::execution::par, m_monster_turns.begin(), m_monster_turns.end(), choose);
+		else
+			std::for_each(m_monster_turns.begin(), m_monster_turns.end(), choose);
+
+		// then the moves are made in turn order, so the first monster to move to a tile gets it
+		for (auto const& t : m_monster_turns)
+			if (t.m_sees_player)
+				monster_apply_move(m_level, t.m_monster, m_level.m_registry.get<c_position>(t.m_monster), t.m_intent);
+
+		for (auto m : due_actors)
+		{
+			if (m == m_level.m_player)
+				continue; // (already had its turn)
+
+			auto& a = m_level.m_registry.get<c_actor>(m);
+
+			if (m_level.m_registry.has<c_monster_tag, c_position>(m))
+			{
+				a.take_turn_energy();
+
+				++result.m_actor_turns;
+				++m_actor_turn_count;
+			}
+
+			m_turns.end_turn(m, a);
+		}
+	}
+
+	void simulation::change_depth(std::int32_t delta_depth)
+	{
+		m_turns.sync_energy(m_level.m_registry);
+		m_dungeon.leave(std::move(m_level));
+
+		m_depth += delta_depth;
+		m_level = m_dungeon.enter(m_depth);
+
+		m_turns.reset(m_level.m_registry);
+	}
+
+} // rog
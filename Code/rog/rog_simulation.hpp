@@ -0,0 +1,133 @@
+#pragma once
+
+#include "rog_direction.hpp"
+#include "rog_dungeon.hpp"
+#include "rog_ecs.hpp"
+#include "rog_journal.hpp"
+#include "rog_level.hpp"
+#include "rog_player_action.hpp"
+#include "rog_random.hpp"
+#include "rog_turn_scheduler.hpp"
+
+#include <bump_math.hpp>
+
+#include <entt.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace rog
+{
+
+	auto constexpr PLAYER_SIGHT_RADIUS = std::int32_t{ 12 };
+	auto constexpr MONSTER_SIGHT_RADIUS = std::int32_t{ 8 };
+
+	/* simulation
+	 *
+	 * The game rules, without any input, timing or drawing: the dungeon, the
+	 * current level, and whose turn it is. Each call to cycle() advances the
+	 * game by one cycle, as fast as it can, so it can be driven by the
+	 * game loop (one cycle per TIME_PER_CYCLE) or run headless (rog_sim).
+	 *
+	 * The player's turn uses the queued action (or the level's queued path).
+	 * A player with nothing to do waits.
+	 *
+	 * Monsters take their turns in two phases: first every monster due in
+	 * the cycle chooses a move, from the level as it was at the start of
+	 * the phase (in parallel, when there are enough of them). Then the
+	 * moves are made one at a time, in turn order; a monster whose way has
+	 * been blocked by an earlier move looks for another way, or waits.
+	 *
+	 * A simulation with the same seed, and the same actions queued on the
+	 * same cycles, plays out the same way. The queued actions are recorded
+	 * in a journal (see get_journal()), so a session can be replayed.
+	 *
+	 */
+	class simulation
+	{
+	public:
+
+		simulation(std::uint64_t seed, std::int32_t depth, glm::ivec2 level_size, std::size_t memory_budget, std::filesystem::path swap_dir);
+
+		simulation(simulation const&) = delete;
+		simulation& operator=(simulation const&) = delete;
+		simulation(simulation&&) = delete;
+		simulation& operator=(simulation&&) = delete;
+
+		struct cycle_result
+		{
+			std::size_t m_actor_turns = 0; // (including the player's)
+			bool m_player_turn = false;
+			bool m_level_changed = false;
+		};
+
+		/* cycle()
+		 *
+		 * Gives every actor that has enough energy a turn. If the player
+		 * uses the stairs, the cycle stops there, and the new level starts
+		 * on the next cycle (m_level_changed is set).
+		 *
+		 */
+		cycle_result cycle();
+
+		/* queue_action()
+		 *
+		 * Replaces any queued action, and clears the queued path. Travel
+		 * actions queue a path to the destination straight away instead,
+		 * which the player follows one step per turn.
+		 *
+		 */
+		void queue_action(player_action action);
+		bool has_queued_action() const { return m_queued_action.has_value(); }
+
+		rog::level& level() { return m_level; }
+		rog::level const& level() const { return m_level; }
+		rog::dungeon const& dungeon() const { return m_dungeon; }
+
+		std::int32_t depth() const { return m_depth; }
+		std::uint64_t cycle_count() const { return m_turns.cycle(); }
+		std::uint64_t actor_turn_count() const { return m_actor_turn_count; }
+
+		/* checksum()
+		 *
+		 * A hash of the current level, the depth, the cycle and the random
+		 * number generator's state, for checking that two simulations are
+		 * in the same state.
+		 *
+		 */
+		std::uint64_t checksum();
+
+		// the session so far (ending with the current cycle and checksum)
+		journal get_journal();
+
+	private:
+
+		void player_turn(cycle_result& result);
+		void monster_turns(std::vector<entt::entity> const& due_actors, cycle_result& result);
+
+		void change_depth(std::int32_t delta_depth);
+
+		struct monster_turn
+		{
+			entt::entity m_monster;
+			glm::ivec2 m_pos;
+			bool m_sees_player;
+			monster_move_intent m_intent;
+		};
+
+		random::rng_t m_rng;
+		rog::dungeon m_dungeon;
+		std::uint64_t m_turn_seed; // for each actor's random numbers (see random::entity_rng())
+		std::int32_t m_depth;
+		rog::level m_level;
+		turn_scheduler m_turns;
+		std::optional<player_action> m_queued_action;
+		std::uint64_t m_actor_turn_count;
+		journal m_journal;
+		std::vector<monster_turn> m_monster_turns; // (kept to reuse the memory)
+	};
+
+} // rog
@@ -0,0 +1,80 @@
+#include "rog_simulation.hpp"
+
+#include "rog_ecs.hpp"
+#include "rog_level_gen.hpp"
+
+#include <bump_range.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		struct run_state
+		{
+			std::vector<glm::ivec2> m_player_positions;
+			std::uint64_t m_actor_turns;
+			std::uint64_t m_checksum;
+		};
+
+		run_state run(std::uint64_t seed, std::uint64_t cycles, glm::ivec2 level_size = level_gen::DEFAULT_LEVEL_SIZE)
+		{
+			auto sim = simulation(seed, 1, level_size, 1024 * 1024, std::filesystem::temp_directory_path() / "rog_test_simulation");
+			auto state = run_state();
+
+			for (auto i : bump::range(std::uint64_t{ 0 }, cycles))
+			{
+				// walk in circles
+				auto constexpr dirs = std::array{ direction::UP, direction::RIGHT, direction::DOWN, direction::LEFT };
+
+				if (i % 10 == 0)
+					sim.queue_action(player_actions::move{ dirs[i / 10 % dirs.size()] });
+
+				auto const result = sim.cycle();
+
+				if (result.m_player_turn)
+					state.m_player_positions.push_back(sim.level().m_registry.get<c_position>(sim.level().m_player).m_pos);
+			}
+
+			state.m_actor_turns = sim.actor_turn_count();
+			state.m_checksum = sim.checksum();
+
+			EXPECT_EQ(sim.cycle_count(), cycles);
+
+			return state;
+		}
+
+	} // unnamed
+
+	TEST(Test_rog_simulation, same_seed_same_game)
+	{
+		auto const a = run(12345, 2'000);
+		auto const b = run(12345, 2'000);
+
+		EXPECT_GE(a.m_player_positions.size(), 2'000 / 10); // (a turn every 10 cycles, and maybe one at the start)
+		EXPECT_EQ(a.m_player_positions, b.m_player_positions);
+		EXPECT_EQ(a.m_actor_turns, b.m_actor_turns);
+		EXPECT_EQ(a.m_checksum, b.m_checksum);
+	}
+
+	TEST(Test_rog_simulation, crowded_level_same_seed_same_game)
+	{
+		// enough monsters that they choose their moves in parallel
+		auto const a = run(54321, 200, { 512, 512 });
+		auto const b = run(54321, 200, { 512, 512 });
+
+		EXPECT_GT(a.m_actor_turns, 200 * 64);
+		EXPECT_EQ(a.m_player_positions, b.m_player_positions);
+		EXPECT_EQ(a.m_actor_turns, b.m_actor_turns);
+		EXPECT_EQ(a.m_checksum, b.m_checksum);
+	}
+
+} // rog
@@ -0,0 +1,61 @@
+#include "rog_terrain_grid.hpp"
+
+#include <bump_die.hpp>
+
+#include <algorithm>
+
+namespace rog
+{
+
+	terrain_grid::terrain_grid():
+		m_palette(&get_default_palette()) { }
+
+	terrain_grid::terrain_grid(glm::ivec2 extents, feature_id fill, feature_palette const& palette):
+		m_palette(&palette),
+		m_ids(extents, fill)
+	{
+		bump::die_if(fill >= palette.size());
+	}
+
+	feature const& terrain_grid::at(glm::ivec2 pos) const
+	{
+		auto const id = m_ids.at(pos);
+
+		if (id != OVERRIDDEN)
+			return m_palette->get(id);
+
+		return m_overrides.at(to_index(pos));
+	}
+
+	void terrain_grid::set(glm::ivec2 pos, feature_id id)
+	{
+		bump::die_if(id >= m_palette->size());
+
+		if (m_ids.at(pos) == OVERRIDDEN)
+			m_overrides.erase(to_index(pos));
+
+		m_ids.set(pos, id);
+	}
+
+	void terrain_grid::assign(feature_id const* ids)
+	{
+		auto const count = std::size_t(extents().x) * std::size_t(extents().y);
+		bump::die_if(std::any_of(ids, ids + count, [&] (feature_id id) { return id >= m_palette->size(); }));
+
+		m_ids.assign(ids);
+		m_overrides.clear();
+	}
+
+	void terrain_grid::set(glm::ivec2 pos, feature const& f)
+	{
+		if (auto const id = m_palette->find(f); id.has_value())
+		{
+			set(pos, id.value());
+			return;
+		}
+
+		m_ids.set(pos, OVERRIDDEN);
+		m_overrides.insert_or_assign(to_index(pos), f);
+	}
+
+} // rog
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "rog_feature.hpp"
+#include "rog_feature_palette.hpp"
+
+#include <bump_chunked_grid.hpp>
+#include <bump_math.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace rog
+{
+
+	/* terrain_grid
+	 *
+	 * The terrain of a level, stored as one feature_id per tile, indexing
+	 * into a shared feature_palette.
+	 *
+	 * Features that aren't in the palette (e.g. a one-off variation of a
+	 * wall) are kept in a sparse table of per-tile overrides instead, and
+	 * their tiles are marked with the OVERRIDDEN id.
+	 *
+	 * The ids are kept in a chunked_grid2, so large areas of the same feature
+	 * (e.g. solid rock) only take up one id per chunk.
+	 *
+	 */
+	class terrain_grid
+	{
+	public:
+
+		static constexpr feature_id OVERRIDDEN = feature_id(feature_palette::MAX_SIZE);
+
+		terrain_grid();
+		explicit terrain_grid(glm::ivec2 extents, feature_id fill = feature_ids::empty, feature_palette const& palette = get_default_palette());
+
+		glm::ivec2 extents() const { return m_ids.extents(); }
+
+		feature const& at(glm::ivec2 pos) const;
+		feature_id id_at(glm::ivec2 pos) const { return m_ids.at(pos); }
+
+		void set(glm::ivec2 pos, feature_id id);
+		void set(glm::ivec2 pos, feature const& f);
+
+		// sets every tile from an array of extents.x * extents.y ids in row order (removing all overrides)
+		void assign(feature_id const* ids);
+
+		feature_palette const& palette() const { return *m_palette; }
+		std::size_t override_count() const { return m_overrides.size(); }
+		std::size_t memory_usage() const { return m_ids.memory_usage(); }
+
+		void compact() { m_ids.compact(); } // frees chunks that have become uniform
+
+		// calls f(pos, feature) for every tile, a chunk at a time
+		template<class F>
+		void for_each(F&& f) const
+		{
+			m_ids.for_each([&] (glm::ivec2 pos, feature_id id)
+			{
+				f(pos, (id != OVERRIDDEN ? m_palette->get(id) : m_overrides.at(to_index(pos))));
+			});
+		}
+
+	private:
+
+		using index_t = std::int32_t;
+
+		index_t to_index(glm::ivec2 pos) const { return pos.y * extents().x + pos.x; }
+
+		feature_palette const* m_palette;
+		bump::chunked_grid2<feature_id> m_ids;
+		std::unordered_map<index_t, feature> m_overrides;
+	};
+
+} // rog
@@ -0,0 +1,185 @@
+#include "rog_terrain_grid.hpp"
+
+#include "rog_random.hpp"
+
+#include <bump_range.hpp>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		// a wall that isn't in the default palette
+		auto const violet_wall = feature{ { '#', colors::violet, colors::black }, feature::flags::NO_WALK };
+
+		std::vector<feature_id> make_random_ids(random::rng_t& rng, glm::ivec2 size)
+		{
+			auto ids = std::vector<feature_id>(std::size_t(size.x) * std::size_t(size.y));
+
+			for (auto& id : ids)
+				id = feature_id(random::rand_range(rng, std::int32_t{ feature_ids::empty }, std::int32_t{ feature_ids::stairs_up }));
+
+			return ids;
+		}
+
+	} // unnamed
+
+	TEST(Test_rog_terrain_grid, set_round_trip)
+	{
+		auto rng = random::rng_t(11223);
+		auto const size = glm::ivec2{ 70, 40 }; // (several chunks, with partial chunks at the edges)
+
+		auto terrain = terrain_grid(size, feature_ids::wall);
+		auto expected = std::vector<feature_id>(std::size_t(size.x) * std::size_t(size.y), feature_ids::wall);
+
+		for (auto i : bump::range(0, 500))
+		{
+			auto const pos = random::rand_range(rng, glm::ivec2(0), size - 1);
+			auto const id = feature_id(random::rand_range(rng, std::int32_t{ feature_ids::empty }, std::int32_t{ feature_ids::stairs_up }));
+
+			// setting a feature that's in the palette is the same as setting its id
+			if (i % 2 == 0)
+				terrain.set(pos, id);
+			else
+				terrain.set(pos, terrain.palette().get(id));
+
+			expected[std::size_t(pos.y) * std::size_t(size.x) + std::size_t(pos.x)] = id;
+		}
+
+		EXPECT_EQ(terrain.override_count(), 0);
+
+		for (auto y : bump::range(0, size.y))
+		{
+			for (auto x : bump::range(0, size.x))
+			{
+				auto const id = expected[std::size_t(y) * std::size_t(size.x) + std::size_t(x)];
+
+				EXPECT_EQ(terrain.id_at({ x, y }), id) << "tile " << x << ", " << y;
+				EXPECT_EQ(terrain.at({ x, y }), get_default_palette().get(id)) << "tile " << x << ", " << y;
+			}
+		}
+	}
+
+	TEST(Test_rog_terrain_grid, override_then_revert)
+	{
+		auto const size = glm::ivec2{ 40, 40 };
+		auto terrain = terrain_grid(size, feature_ids::floor);
+		auto const empty_usage = terrain.memory_usage();
+
+		terrain.set({ 3, 4 }, violet_wall);
+		terrain.set({ 35, 36 }, violet_wall);
+
+		EXPECT_EQ(terrain.id_at({ 3, 4 }), terrain_grid::OVERRIDDEN);
+		EXPECT_EQ(terrain.at({ 3, 4 }), violet_wall);
+		EXPECT_EQ(terrain.at({ 35, 36 }), violet_wall);
+		EXPECT_EQ(terrain.at({ 4, 4 }), features::floor);
+		EXPECT_EQ(terrain.override_count(), 2);
+
+		// overriding an overridden tile replaces the override
+		auto const violet_floor = feature{ { '.', colors::violet, colors::black }, {} };
+		terrain.set({ 3, 4 }, violet_floor);
+
+		EXPECT_EQ(terrain.at({ 3, 4 }), violet_floor);
+		EXPECT_EQ(terrain.override_count(), 2);
+
+		// setting a palette feature removes the override
+		terrain.set({ 3, 4 }, feature_ids::floor);
+		terrain.set({ 35, 36 }, features::floor);
+
+		EXPECT_EQ(terrain.id_at({ 3, 4 }), feature_ids::floor);
+		EXPECT_EQ(terrain.id_at({ 35, 36 }), feature_ids::floor);
+		EXPECT_EQ(terrain.at({ 3, 4 }), features::floor);
+		EXPECT_EQ(terrain.override_count(), 0);
+
+		// and once compacted, the uniform chunks are freed again
+		terrain.compact();
+		EXPECT_EQ(terrain.memory_usage(), empty_usage);
+	}
+
+	TEST(Test_rog_terrain_grid, assign)
+	{
+		auto rng = random::rng_t(22334);
+		auto const size = glm::ivec2{ 45, 33 };
+		auto const ids = make_random_ids(rng, size);
+
+		auto terrain = terrain_grid(size);
+		terrain.set({ 1, 1 }, violet_wall);
+
+		terrain.assign(ids.data());
+
+		// (assigning removes any overrides)
+		EXPECT_EQ(terrain.override_count(), 0);
+
+		for (auto y : bump::range(0, size.y))
+			for (auto x : bump::range(0, size.x))
+				EXPECT_EQ(terrain.id_at({ x, y }), ids[std::size_t(y) * std::size_t(size.x) + std::size_t(x)]) << "tile " << x << ", " << y;
+	}
+
+	TEST(Test_rog_terrain_grid, for_each)
+	{
+		auto rng = random::rng_t(33445);
+		auto const size = glm::ivec2{ 70, 40 };
+		auto const ids = make_random_ids(rng, size);
+
+		auto terrain = terrain_grid(size);
+		terrain.assign(ids.data());
+		terrain.set({ 0, 0 }, violet_wall);
+		terrain.set({ 69, 39 }, violet_wall);
+
+		// every tile is visited exactly once, with the same feature as at()
+		auto visits = std::vector<std::int32_t>(ids.size(), 0);
+
+		terrain.for_each([&] (glm::ivec2 pos, feature const& f)
+		{
+			ASSERT_TRUE(pos.x >= 0 && pos.y >= 0 && pos.x < size.x && pos.y < size.y);
+
+			++visits[std::size_t(pos.y) * std::size_t(size.x) + std::size_t(pos.x)];
+			EXPECT_EQ(f, terrain.at(pos)) << "tile " << pos.x << ", " << pos.y;
+		});
+
+		for (auto i : bump::range(std::size_t{ 0 }, visits.size()))
+			EXPECT_EQ(visits[i], 1) << "index " << i;
+	}
+
+	TEST(Test_rog_terrain_grid, palette_interns_duplicates)
+	{
+		auto palette = feature_palette();
+
+		auto const wall = palette.add(features::wall);
+		auto const floor = palette.add(features::floor);
+		auto const violet = palette.add(violet_wall);
+
+		EXPECT_NE(wall, floor);
+		EXPECT_NE(wall, violet);
+		EXPECT_EQ(palette.size(), 3);
+
+		// adding an equal feature returns the existing id
+		EXPECT_EQ(palette.add(features::wall), wall);
+		EXPECT_EQ(palette.add(feature{ { '#', colors::violet, colors::black }, feature::flags::NO_WALK }), violet);
+		EXPECT_EQ(palette.size(), 3);
+
+		EXPECT_EQ(palette.find(features::floor), floor);
+		EXPECT_FALSE(palette.find(features::stairs_down).has_value());
+		EXPECT_EQ(palette.get(violet), violet_wall);
+
+		// a terrain grid using this palette doesn't need an override for the violet wall
+		auto terrain = terrain_grid({ 8, 8 }, floor, palette);
+		terrain.set({ 2, 2 }, violet_wall);
+
+		EXPECT_EQ(terrain.id_at({ 2, 2 }), violet);
+		EXPECT_EQ(terrain.override_count(), 0);
+
+		// and the default palette has the ids in feature_ids
+		EXPECT_EQ(get_default_palette().find(features::empty), feature_ids::empty);
+		EXPECT_EQ(get_default_palette().find(features::wall), feature_ids::wall);
+		EXPECT_EQ(get_default_palette().find(features::floor), feature_ids::floor);
+		EXPECT_EQ(get_default_palette().find(features::stairs_down), feature_ids::stairs_down);
+		EXPECT_EQ(get_default_palette().find(features::stairs_up), feature_ids::stairs_up);
+	}
+
+} // rog
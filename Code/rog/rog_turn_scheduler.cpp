@@ -0,0 +1,108 @@
+#include "rog_turn_scheduler.hpp"
+
+#include <bump_die.hpp>
+
+#include <algorithm>
+
+namespace rog
+{
+
+	void turn_scheduler::reset(entt::registry const& registry)
+	{
+		for (auto& slot : m_wheel)
+			slot.clear();
+
+		m_scheduled_count = 0;
+		m_due.clear();
+		m_due_marks.clear();
+
+		auto view = registry.view<c_actor const>();
+
+		for (auto const a : view)
+			schedule(a, view.get<c_actor const>(a).m_energy, m_cycle);
+	}
+
+	std::vector<entt::entity> const& turn_scheduler::next_cycle(entt::registry& registry)
+	{
+		++m_cycle;
+		m_due.clear();
+
+		auto& slot = m_wheel[m_cycle % WHEEL_SIZE];
+
+		// (actors due in a later turn of the wheel stay where they are)
+		auto const due_end = std::partition(slot.begin(), slot.end(), [&] (entry const& e) { return e.m_due_cycle != m_cycle; });
+
+		for (auto i = due_end; i != slot.end(); ++i)
+		{
+			--m_scheduled_count;
+
+			if (!registry.valid(i->m_actor) || !registry.has<c_actor>(i->m_actor))
+				continue;
+
+			registry.get<c_actor>(i->m_actor).m_energy += ACTOR_ENERGY_PER_CYCLE * std::int32_t(m_cycle - i->m_energy_cycle);
+			m_due.push_back(i->m_actor);
+
+			auto const index = entity_index(i->m_actor);
+
+			if (index >= m_due_marks.size())
+				m_due_marks.resize(index + 1);
+
+			m_due_marks[index] = { i->m_actor, m_cycle };
+		}
+
+		slot.erase(due_end, slot.end());
+
+		// the same order as the energy sweep: the player, then the monsters in view order
+		auto const monsters = registry.view<c_monster_tag>();
+
+		auto const turn_order = [&] (entt::entity actor)
+		{
+			return monsters.contains(actor) ? std::int64_t{ 1 } + (monsters.find(actor) - monsters.begin()) : std::int64_t{ 0 };
+		};
+
+		std::sort(m_due.begin(), m_due.end(), [&] (entt::entity a, entt::entity b) { return turn_order(a) < turn_order(b); });
+
+		return m_due;
+	}
+
+	bool turn_scheduler::is_due(entt::entity actor) const
+	{
+		auto const index = entity_index(actor);
+		return index < m_due_marks.size() && m_due_marks[index].m_actor == actor && m_due_marks[index].m_cycle == m_cycle;
+	}
+
+	void turn_scheduler::end_turn(entt::entity actor, c_actor const& energy)
+	{
+		bump::die_if(!is_due(actor));
+
+		schedule(actor, energy.m_energy, m_cycle);
+	}
+
+	void turn_scheduler::sync_energy(entt::registry& registry)
+	{
+		for (auto& slot : m_wheel)
+		{
+			for (auto& e : slot)
+			{
+				if (!registry.valid(e.m_actor) || !registry.has<c_actor>(e.m_actor))
+					continue;
+
+				registry.get<c_actor>(e.m_actor).m_energy += ACTOR_ENERGY_PER_CYCLE * std::int32_t(m_cycle - e.m_energy_cycle);
+				e.m_energy_cycle = m_cycle;
+			}
+		}
+	}
+
+	void turn_scheduler::schedule(entt::entity actor, std::int32_t energy, std::uint64_t energy_cycle)
+	{
+		// the first later cycle with enough energy (an actor takes at most one turn per cycle)
+		auto const needed = ACTOR_ENERGY_PER_TURN - energy;
+		auto const cycles = std::max(std::int32_t{ 1 }, (needed + ACTOR_ENERGY_PER_CYCLE - 1) / ACTOR_ENERGY_PER_CYCLE);
+
+		auto const due_cycle = energy_cycle + std::uint64_t(cycles);
+
+		m_wheel[due_cycle % WHEEL_SIZE].push_back({ actor, due_cycle, energy_cycle });
+		++m_scheduled_count;
+	}
+
+} // rog
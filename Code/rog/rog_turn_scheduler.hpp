@@ -0,0 +1,96 @@
+#pragma once
+
+#include "rog_ecs.hpp"
+
+#include <entt.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace rog
+{
+
+	/* turn_scheduler
+	 *
+	 * Decides which actors take a turn in each cycle, without giving every
+	 * actor energy every cycle.
+	 *
+	 * Actors gain a fixed amount of energy per cycle, so the cycle in which
+	 * an actor next has enough energy for a turn is known as soon as its
+	 * turn ends. Actors are kept in a timing wheel slot for that cycle, and
+	 * each cycle only the actors in the current slot are touched.
+	 *
+	 * The turns taken are exactly the same as if every actor's c_actor was
+	 * given ACTOR_ENERGY_PER_CYCLE each cycle, and then every actor with
+	 * enough energy took a turn. Within a cycle, actors without the monster
+	 * tag (i.e. the player) go first, then monsters in the order that a view
+	 * of the registry's monsters iterates them.
+	 *
+	 * c_actor::m_energy is only up to date for the actors that are due in
+	 * the current cycle (call sync_energy() to bring every actor up to date,
+	 * e.g. before the level is saved).
+	 *
+	 */
+	class turn_scheduler
+	{
+	public:
+
+		/* reset()
+		 *
+		 * Schedules every actor in `registry` from its current energy (i.e.
+		 * after the level is entered or loaded).
+		 *
+		 */
+		void reset(entt::registry const& registry);
+
+		/* next_cycle()
+		 *
+		 * Moves to the next cycle, and returns the actors that take a turn
+		 * in it, in turn order (with their energy updated). Each of them
+		 * should take its turn energy, then be scheduled again with
+		 * end_turn(). Actors that have been destroyed are skipped.
+		 *
+		 */
+		std::vector<entt::entity> const& next_cycle(entt::registry& registry);
+
+		bool is_due(entt::entity actor) const;
+
+		// schedules the next turn of an actor that was due in this cycle
+		void end_turn(entt::entity actor, c_actor const& energy);
+
+		void sync_energy(entt::registry& registry);
+
+		std::uint64_t cycle() const { return m_cycle; }
+		std::size_t scheduled_count() const { return m_scheduled_count; }
+
+	private:
+
+		// more than enough for an actor with no energy to get a turn, so an actor is normally only seen when it's due
+		static constexpr std::uint64_t WHEEL_SIZE = 16;
+
+		struct entry
+		{
+			entt::entity m_actor;
+			std::uint64_t m_due_cycle;
+			std::uint64_t m_energy_cycle; // the cycle that the actor's c_actor::m_energy is up to date for
+		};
+
+		struct due_mark
+		{
+			entt::entity m_actor = entt::null;
+			std::uint64_t m_cycle = 0;
+		};
+
+		void schedule(entt::entity actor, std::int32_t energy, std::uint64_t energy_cycle);
+
+		static std::size_t entity_index(entt::entity actor) { return std::size_t(entt::to_integral(actor) & entt::entt_traits<entt::entity>::entity_mask); }
+
+		std::uint64_t m_cycle = 0;
+		std::array<std::vector<entry>, WHEEL_SIZE> m_wheel;
+		std::size_t m_scheduled_count = 0;
+		std::vector<entt::entity> m_due;
+		std::vector<due_mark> m_due_marks; // the last cycle each actor was due in, by entity index (so is_due() doesn't search m_due)
+	};
+
+} // rog
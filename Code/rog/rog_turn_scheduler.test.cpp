@@ -0,0 +1,162 @@
+#include "rog_turn_scheduler.hpp"
+
+#include "rog_ecs.hpp"
+#include "rog_random.hpp"
+
+#include <bump_range.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace rog
+{
+
+	namespace
+	{
+
+		using turn = std::pair<std::uint64_t, entt::entity>; // (cycle, actor)
+
+		void make_actors(entt::registry& registry, std::uint32_t seed)
+		{
+			auto rng = random::rng_t(seed);
+
+			auto const player = player_create_entity(registry);
+			registry.get<c_actor>(player).m_energy = random::rand_range(rng, 0, 150);
+
+			for (auto i : bump::range(0, 200))
+			{
+				auto const monster = monster_create_entity(registry);
+				registry.get<c_actor>(monster).m_energy = random::rand_range(rng, -100, 250); // some with several turns saved up
+
+				// some monsters that are later removed, so the order of the monster pool changes
+				if (i % 17 == 0)
+					registry.destroy(monster_create_entity(registry));
+			}
+		}
+
+		// the energy rules: every actor gains energy every cycle, then every actor with enough energy takes a turn
+		std::vector<turn> energy_sweep(entt::registry& registry, std::uint64_t cycles)
+		{
+			auto turns = std::vector<turn>();
+
+			for (auto cycle : bump::range(std::uint64_t{ 1 }, cycles + 1))
+			{
+				for (auto a : registry.view<c_actor>())
+					registry.get<c_actor>(a).add_energy();
+
+				for (auto a : registry.view<c_actor, c_player_tag>())
+				{
+					auto& actor = registry.get<c_actor>(a);
+
+					if (!actor.has_turn_energy())
+						continue;
+
+					turns.push_back({ cycle, a });
+					actor.take_turn_energy();
+				}
+
+				auto view = registry.view<c_actor, c_monster_tag, c_position>();
+
+				for (auto m : view)
+				{
+					auto& actor = view.get<c_actor>(m);
+
+					if (!actor.has_turn_energy())
+						continue;
+
+					turns.push_back({ cycle, m });
+					actor.take_turn_energy();
+				}
+
+				if (cycle == cycles / 2)
+					registry.destroy(*registry.view<c_monster_tag>().begin());
+			}
+
+			return turns;
+		}
+
+		std::vector<turn> scheduled(entt::registry& registry, std::uint64_t cycles)
+		{
+			auto turns = std::vector<turn>();
+			auto scheduler = turn_scheduler();
+
+			scheduler.reset(registry);
+
+			for (auto cycle : bump::range(std::uint64_t{ 1 }, cycles + 1))
+			{
+				for (auto a : scheduler.next_cycle(registry))
+				{
+					auto& actor = registry.get<c_actor>(a);
+					EXPECT_TRUE(actor.has_turn_energy());
+
+					turns.push_back({ cycle, a });
+					actor.take_turn_energy();
+
+					scheduler.end_turn(a, actor);
+				}
+
+				if (cycle == cycles / 2)
+					registry.destroy(*registry.view<c_monster_tag>().begin());
+			}
+
+			scheduler.sync_energy(registry);
+
+			return turns;
+		}
+
+	} // unnamed
+
+	TEST(Test_rog_turn_scheduler, same_turns_as_energy_sweep)
+	{
+		auto constexpr CYCLES = std::uint64_t{ 500 };
+
+		for (auto seed : bump::range(0u, 5u))
+		{
+			auto sweep_registry = entt::registry();
+			auto scheduler_registry = entt::registry();
+
+			make_actors(sweep_registry, seed);
+			make_actors(scheduler_registry, seed);
+
+			auto const expected = energy_sweep(sweep_registry, CYCLES);
+			auto const actual = scheduled(scheduler_registry, CYCLES);
+
+			ASSERT_EQ(actual.size(), expected.size());
+			EXPECT_EQ(actual, expected);
+
+			// and everyone has the same energy left over afterwards
+			for (auto a : sweep_registry.view<c_actor>())
+				EXPECT_EQ(scheduler_registry.get<c_actor>(a).m_energy, sweep_registry.get<c_actor>(a).m_energy);
+		}
+	}
+
+	TEST(Test_rog_turn_scheduler, only_due_actors_are_touched)
+	{
+		auto registry = entt::registry();
+
+		for (auto i : bump::range(0, 10))
+			registry.get<c_actor>(monster_create_entity(registry)).m_energy = i * ACTOR_ENERGY_PER_CYCLE;
+
+		auto scheduler = turn_scheduler();
+		scheduler.reset(registry);
+
+		EXPECT_EQ(scheduler.scheduled_count(), 10);
+
+		// one actor per cycle, starting with the one with the most energy
+		for ([[maybe_unused]] auto _ : bump::range(0, 10))
+		{
+			auto const& due = scheduler.next_cycle(registry);
+
+			ASSERT_EQ(due.size(), 1);
+			EXPECT_EQ(registry.get<c_actor>(due.front()).m_energy, ACTOR_ENERGY_PER_TURN);
+			EXPECT_EQ(scheduler.scheduled_count(), 9);
+
+			registry.get<c_actor>(due.front()).take_turn_energy();
+			scheduler.end_turn(due.front(), registry.get<c_actor>(due.front()));
+		}
+	}
+
+} // rog
@@ -0,0 +1,30 @@
+#include "rog_bench.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv)
+{
+	// run everything, or just the benchmarks named on the command line
+	auto const should_run = [&] (std::string const& name)
+	{
+		if (argc == 1)
+			return true;
+
+		for (auto i = 1; i != argc; ++i)
+			if (argv[i] == name)
+				return true;
+
+		return false;
+	};
+
+	if (should_run("level_gen")) rog_bench::bench_level_gen();
+	if (should_run("level_io")) rog_bench::bench_level_io();
+	if (should_run("random")) rog_bench::bench_random();
+	if (should_run("terminal")) rog_bench::bench_terminal();
+
+	std::clog << "done!" << std::endl;
+
+	return EXIT_SUCCESS;
+}
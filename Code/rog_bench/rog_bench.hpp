@@ -0,0 +1,52 @@
+#pragma once
+
+#include <bump_time.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace rog_bench
+{
+
+	struct timing
+	{
+		double m_mean_ms;
+		double m_min_ms;
+	};
+
+	/* measure()
+	 *
+	 * Runs `f` (after one warm up run) `runs` times, and returns the mean
+	 * and the fastest time taken, in milliseconds.
+	 *
+	 */
+	template<class F>
+	timing measure(std::int32_t runs, F&& f)
+	{
+		f();
+
+		auto total = bump::duration_t{ 0 };
+		auto fastest = bump::duration_t::max();
+
+		for (auto i = 0; i != runs; ++i)
+		{
+			auto const start = bump::clock_t::now();
+			f();
+			auto const elapsed = bump::clock_t::now() - start;
+
+			total += elapsed;
+			fastest = std::min(fastest, elapsed);
+		}
+
+		auto const to_ms = [] (bump::duration_t d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+		return { to_ms(total) / double(runs), to_ms(fastest) };
+	}
+
+	void bench_level_gen();
+	void bench_level_io();
+	void bench_random();
+	void bench_terminal();
+
+} // rog_bench
@@ -0,0 +1,61 @@
+#include "rog_bench.hpp"
+
+#include <rog_level_gen.hpp>
+
+#include <bump_math.hpp>
+
+#include <array>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+
+namespace rog_bench
+{
+
+	void bench_level_gen()
+	{
+		auto constexpr SEED = std::uint64_t{ 0x5eed };
+		auto constexpr DEPTH = std::int32_t{ 2 };
+
+		auto const sizes = std::array<glm::ivec2, 5>
+		{
+			glm::ivec2{ 40, 24 },
+			glm::ivec2{ 80, 40 },
+			glm::ivec2{ 160, 80 },
+			glm::ivec2{ 256, 256 },
+			glm::ivec2{ 512, 512 },
+		};
+
+		std::cout << "level_gen (mean / min ms, " << "depth " << DEPTH << ")\n";
+		std::cout << std::fixed << std::setprecision(3);
+
+		for (auto const& size : sizes)
+		{
+			// fewer runs for the larger maps
+			auto const runs = std::max(4, 2'000'000 / (size.x * size.y));
+
+			// each run uses a different seed, so both the room and cave generators are included
+			auto seed = SEED;
+
+			auto const terrain = measure(runs, [&] ()
+			{
+				auto rng = rog::level_gen::make_level_rng(seed++, DEPTH);
+				(void)rog::level_gen::generate_terrain(size, DEPTH, rng);
+			});
+
+			seed = SEED;
+
+			auto const level = measure(runs, [&] ()
+			{
+				(void)rog::level_gen::generate_level(seed++, DEPTH, size);
+			});
+
+			std::cout
+				<< "  " << std::setw(4) << size.x << " x " << std::setw(4) << size.y
+				<< "  terrain: " << std::setw(9) << terrain.m_mean_ms << " / " << std::setw(9) << terrain.m_min_ms
+				<< "  level: " << std::setw(9) << level.m_mean_ms << " / " << std::setw(9) << level.m_min_ms
+				<< "  (" << runs << " runs)\n";
+		}
+	}
+
+} // rog_bench
@@ -0,0 +1,97 @@
+#include "rog_bench.hpp"
+
+#include <rog_ecs.hpp>
+#include <rog_level_gen.hpp>
+#include <rog_level_io.hpp>
+#include <rog_random.hpp>
+
+#include <bump_math.hpp>
+
+#include <array>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace rog_bench
+{
+
+	namespace
+	{
+
+		// a generated level, with extra monsters added to reach `monster_count`
+		rog::level make_level(glm::ivec2 size, std::int32_t monster_count)
+		{
+			auto level = rog::level_gen::generate_level(0x5eed, 2, size);
+			auto rng = rog::random::rng_t(1);
+
+			auto count = std::int32_t(level.m_registry.size<rog::c_monster_tag>());
+
+			for (auto tries = 0; count < monster_count && tries != size.x * size.y * 4; ++tries)
+			{
+				auto const pos = rog::random::rand_range(rng, glm::ivec2(0), size - 1);
+
+				if (!level.is_walkable(pos) || level.is_occupied(pos))
+					continue;
+
+				auto const monster = rog::monster_create_entity(level.m_registry);
+				level.m_registry.get<rog::c_position>(monster).m_pos = pos;
+				level.m_actors.set(pos, monster);
+
+				++count;
+			}
+
+			return level;
+		}
+
+	} // unnamed
+
+	void bench_level_io()
+	{
+		struct test_case
+		{
+			glm::ivec2 m_size;
+			std::int32_t m_monsters;
+		};
+
+		auto const cases = std::array<test_case, 3>
+		{
+			test_case{ { 80, 40 }, 0 },
+			test_case{ { 256, 256 }, 2'000 },
+			test_case{ { 512, 512 }, 10'000 },
+		};
+
+		std::cout << "level_io (mean / min ms)\n";
+		std::cout << std::fixed << std::setprecision(3);
+
+		for (auto const& c : cases)
+		{
+			auto const level = make_level(c.m_size, c.m_monsters);
+			auto const runs = std::max(8, 4'000'000 / (c.m_size.x * c.m_size.y));
+
+			auto bytes = std::string();
+
+			auto const save = measure(runs, [&] ()
+			{
+				auto os = std::ostringstream();
+				rog::write_level(os, level);
+				bytes = std::move(os).str();
+			});
+
+			auto const load = measure(runs, [&] ()
+			{
+				auto is = std::istringstream(bytes);
+				(void)rog::read_level(is);
+			});
+
+			std::cout
+				<< "  " << std::setw(4) << c.m_size.x << " x " << std::setw(4) << c.m_size.y
+				<< "  " << std::setw(6) << level.m_registry.alive() << " entities"
+				<< "  save: " << std::setw(8) << save.m_mean_ms << " / " << std::setw(8) << save.m_min_ms
+				<< "  load: " << std::setw(8) << load.m_mean_ms << " / " << std::setw(8) << load.m_min_ms
+				<< "  (" << bytes.size() / 1024 << " KiB, " << runs << " runs)\n";
+		}
+	}
+
+} // rog_bench
@@ -0,0 +1,98 @@
+#include "rog_bench.hpp"
+
+#include <rog_random.hpp>
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace rog_bench
+{
+
+	namespace
+	{
+
+		auto constexpr COUNT = std::size_t{ 1'000'000 };
+
+		// what rog::random used to do: construct a distribution for every number
+		template<class T>
+		T std_rand_range(std::mt19937_64& rng, T min, T max)
+		{
+			if constexpr (std::is_integral_v<T>)
+				return std::uniform_int_distribution<T>(min, max)(rng);
+			else
+				return std::uniform_real_distribution<T>(min, max)(rng);
+		}
+
+		void print(std::string const& name, timing const& t)
+		{
+			auto const ns_per_number = [] (double ms) { return ms * 1'000'000.0 / double(COUNT); };
+
+			std::cout
+				<< "  " << std::left << std::setw(36) << name << std::right
+				<< std::setw(8) << t.m_mean_ms << " / " << std::setw(8) << t.m_min_ms << " ms"
+				<< "  (" << std::setw(5) << ns_per_number(t.m_min_ms) << " ns per number)\n";
+		}
+
+	} // unnamed
+
+	void bench_random()
+	{
+		auto constexpr RUNS = 20;
+
+		auto ints = std::vector<std::int32_t>(COUNT);
+		auto floats = std::vector<float>(COUNT);
+		auto bits = std::vector<std::uint64_t>(COUNT);
+
+		std::cout << "random (" << COUNT << " numbers, mean / min ms)\n";
+		std::cout << std::fixed << std::setprecision(3);
+
+		{
+			auto rng = std::mt19937_64(1);
+
+			print("mt19937_64, raw", measure(RUNS, [&] () { for (auto& x : bits) x = rng(); }));
+			print("mt19937_64, std int [0, 8]", measure(RUNS, [&] () { for (auto& x : ints) x = std_rand_range(rng, 0, 8); }));
+			print("mt19937_64, std float [0, 1)", measure(RUNS, [&] () { for (auto& x : floats) x = std_rand_range(rng, 0.f, 1.f); }));
+		}
+
+		{
+			auto rng = rog::random::xoshiro256_rng(1);
+
+			print("xoshiro256**, raw", measure(RUNS, [&] () { for (auto& x : bits) x = rng(); }));
+			print("xoshiro256**, int [0, 8]", measure(RUNS, [&] () { for (auto& x : ints) x = rog::random::rand_range(rng, 0, 8); }));
+			print("xoshiro256**, float [0, 1)", measure(RUNS, [&] () { for (auto& x : floats) x = rog::random::rand_01<float>(rng); }));
+			print("xoshiro256**, fill_range int [0, 8]", measure(RUNS, [&] () { rog::random::fill_range(rng, std::span(ints), 0, 8); }));
+		}
+
+		{
+			auto rng = rog::random::philox_rng(1, 0, 0);
+
+			print("philox4x32-10, raw", measure(RUNS, [&] () { for (auto& x : bits) x = rng(); }));
+			print("philox4x32-10, fill", measure(RUNS, [&] () { rog::random::fill(rng, bits); }));
+			print("philox4x32-10, int [0, 8]", measure(RUNS, [&] () { for (auto& x : ints) x = rog::random::rand_range(rng, 0, 8); }));
+
+			// a new stream for every roll (e.g. one roll per monster per turn)
+			print("philox4x32-10, entity streams", measure(RUNS, [&] ()
+			{
+				for (auto i = std::size_t{ 0 }; i != COUNT; ++i)
+				{
+					auto stream = rog::random::entity_rng(1, entt::entity(std::uint32_t(i)), 42);
+					ints[i] = rog::random::rand_range(stream, 0, 8);
+				}
+			}));
+		}
+
+		// (so the results are used)
+		auto sum = std::uint64_t{ 0 };
+		for (auto i = std::size_t{ 0 }; i < COUNT; i += 4096)
+			sum += bits[i] + std::uint64_t(ints[i]) + std::uint64_t(floats[i] * 100.f);
+
+		std::cout << "  (checksum " << sum << ")\n";
+	}
+
+} // rog_bench
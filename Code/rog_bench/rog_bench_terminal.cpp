@@ -0,0 +1,139 @@
+#include "rog_bench.hpp"
+
+#include <rog_ecs.hpp>
+#include <rog_level_gen.hpp>
+#include <rog_random.hpp>
+#include <rog_screen_terminal.hpp>
+
+#include <bump_math.hpp>
+#include <bump_range.hpp>
+#include <bump_time.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace rog_bench
+{
+
+	namespace
+	{
+
+		auto constexpr FRAMES = 500;
+		auto constexpr NO_BUDGET = std::numeric_limits<std::size_t>::max();
+		auto const SCREEN_SIZE = glm::ivec2{ 160, 48 };
+		auto const LEVEL_SIZE = glm::ivec2{ 480, 48 };
+
+		void draw_terrain(rog::screen_buffer& sb, rog::level const& level, glm::ivec2 origin_lv)
+		{
+			sb.blit(level.m_grid, { origin_lv, sb.size() }, glm::ivec2(0), [] (rog::feature const& f, glm::ivec2) { return f.m_cell; });
+		}
+
+		// renders FRAMES frames, calling `draw` before each one, and prints the output bytes and encode time per frame
+		void run(std::string const& name, rog::terminal_screen& terminal, std::function<void(std::int32_t)> const& draw)
+		{
+			auto out = std::string();
+			auto bytes = std::size_t{ 0 };
+			auto unfinished = 0;
+			auto encode_time = bump::duration_t{ 0 };
+
+			for (auto frame : bump::range(0, FRAMES))
+			{
+				draw(frame);
+
+				out.clear();
+
+				auto const start = bump::clock_t::now();
+				unfinished += terminal.render(out) ? 0 : 1;
+				encode_time += bump::clock_t::now() - start;
+
+				bytes += out.size();
+			}
+
+			auto const us_per_frame = std::chrono::duration<double, std::micro>(encode_time).count() / double(FRAMES);
+
+			std::cout
+				<< "  " << std::left << std::setw(36) << name << std::right
+				<< std::setw(10) << double(bytes) / double(FRAMES) << " bytes"
+				<< std::setw(10) << us_per_frame << " us"
+				<< "  (" << unfinished << " frames over budget)\n";
+		}
+
+	} // unnamed
+
+	void bench_terminal()
+	{
+		auto const level = rog::level_gen::generate_level(0x5eed, 2, LEVEL_SIZE);
+		auto const max_scroll = LEVEL_SIZE.x - SCREEN_SIZE.x;
+
+		std::cout << "terminal (" << SCREEN_SIZE.x << "x" << SCREEN_SIZE.y << ", mean per frame over " << FRAMES << " frames)\n";
+		std::cout << std::fixed << std::setprecision(1);
+
+		// (the first frame writes every cell, so it isn't counted)
+		auto const make_terminal = [&] (std::size_t budget)
+		{
+			auto terminal = rog::terminal_screen(SCREEN_SIZE, budget);
+			draw_terrain(terminal.buffer(), level, glm::ivec2(0));
+
+			auto out = std::string();
+			while (!terminal.render(out)) { }
+
+			return terminal;
+		};
+
+		{
+			auto terminal = make_terminal(NO_BUDGET);
+			run("idle", terminal, [] (std::int32_t) { });
+		}
+
+		{
+			auto terminal = make_terminal(NO_BUDGET);
+			run("full redraw (no diffing)", terminal, [&] (std::int32_t) { terminal.invalidate(); });
+		}
+
+		// a player and some monsters walking around
+		{
+			auto terminal = make_terminal(NO_BUDGET);
+			auto rng = rog::random::rng_t(1);
+
+			auto actors = std::vector<glm::ivec2>();
+
+			for (auto i = 0; i != 32; ++i)
+				actors.push_back(rog::random::rand_range(rng, glm::ivec2(0), SCREEN_SIZE - 1));
+
+			auto const player = rog::screen_cell{ '@', rog::colors::yellow, rog::colors::black };
+			auto const monster = rog::screen_cell{ 'T', rog::colors::green, rog::colors::black };
+
+			run("move (32 actors)", terminal, [&] (std::int32_t)
+			{
+				auto& sb = terminal.buffer();
+
+				for (auto i : bump::range(std::size_t{ 0 }, actors.size()))
+				{
+					auto& pos = actors[i];
+					sb.set(pos, level.m_grid.at(pos).m_cell);
+
+					pos = glm::clamp(pos + rog::random::rand_range(rng, glm::ivec2(-1), glm::ivec2(1)), glm::ivec2(0), SCREEN_SIZE - 1);
+					sb.set(pos, i == 0 ? player : monster);
+				}
+			});
+		}
+
+		// the map scrolling sideways one column per frame (every cell that isn't in a run of the same feature changes)
+		for (auto const budget : { NO_BUDGET, std::size_t{ 4 * 1024 }, std::size_t{ 1024 } })
+		{
+			auto terminal = make_terminal(budget);
+			auto const name = budget == NO_BUDGET ? std::string("scroll") : "scroll (" + std::to_string(budget / 1024) + " KiB budget)";
+
+			run(name, terminal, [&] (std::int32_t frame)
+			{
+				draw_terrain(terminal.buffer(), level, { frame % max_scroll, 0 });
+			});
+		}
+	}
+
+} // rog_bench
@@ -0,0 +1,297 @@
+#include <rog_ecs.hpp>
+#include <rog_journal.hpp>
+#include <rog_level.hpp>
+#include <rog_level_gen.hpp>
+#include <rog_player_action.hpp>
+#include <rog_random.hpp>
+#include <rog_simulation.hpp>
+
+#include <bump_math.hpp>
+#include <bump_time.hpp>
+
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+
+	auto constexpr DUNGEON_MEMORY_BUDGET = std::size_t{ 16 * 1024 * 1024 };
+
+	std::filesystem::path get_swap_dir()
+	{
+		return std::filesystem::temp_directory_path() / "rog_sim";
+	}
+
+	// the chance of taking the stairs when standing on them, and of heading for some when picking somewhere to go
+	auto constexpr STAIRS_CHANCE = 0.25f;
+
+	std::size_t get_peak_memory_bytes()
+	{
+#ifdef _WIN32
+		auto counters = PROCESS_MEMORY_COUNTERS();
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return 0;
+
+		return counters.PeakWorkingSetSize;
+#else
+		auto usage = rusage();
+		if (getrusage(RUSAGE_SELF, &usage) != 0)
+			return 0;
+
+		return std::size_t(usage.ru_maxrss) * 1024; // (in KiB)
+#endif
+	}
+
+	std::vector<glm::ivec2> find_stairs(rog::level const& level)
+	{
+		auto stairs = std::vector<glm::ivec2>();
+
+		for (auto y = 0; y != level.size().y; ++y)
+			for (auto x = 0; x != level.size().x; ++x)
+				if (level.m_layers.m_stairs_up.test({ x, y }) || level.m_layers.m_stairs_down.test({ x, y }))
+					stairs.push_back({ x, y });
+
+		return stairs;
+	}
+
+	/* wander()
+	 *
+	 * Gives the player something to do, in place of the keyboard: walk to
+	 * somewhere random (sometimes to the stairs), and sometimes take the
+	 * stairs when standing on them.
+	 *
+	 */
+	void wander(rog::simulation& sim, rog::random::rng_t& rng)
+	{
+		auto& level = sim.level();
+
+		if (sim.has_queued_action() || level.has_queued_path())
+			return;
+
+		auto const& player_pos = level.m_registry.get<rog::c_position>(level.m_player).m_pos;
+
+		if (rog::random::rand_01<float>(rng) < STAIRS_CHANCE)
+		{
+			if (level.m_layers.m_stairs_up.test(player_pos) || level.m_layers.m_stairs_down.test(player_pos))
+			{
+				auto const dir = level.m_layers.m_stairs_up.test(player_pos) ? rog::stairs_direction::UP : rog::stairs_direction::DOWN;
+				sim.queue_action(rog::player_actions::use_stairs{ dir });
+				return;
+			}
+
+			auto const stairs = find_stairs(level);
+
+			if (!stairs.empty())
+			{
+				sim.queue_action(rog::player_actions::travel{ stairs[rog::random::rand_range(rng, std::size_t{ 0 }, stairs.size() - 1)] });
+				return;
+			}
+		}
+
+		for (auto tries = 0; tries != 32; ++tries)
+		{
+			auto const dst = rog::random::rand_range(rng, glm::ivec2(0), level.size() - 1);
+
+			if (dst == player_pos || !level.is_walkable(dst))
+				continue;
+
+			sim.queue_action(rog::player_actions::travel{ dst });
+
+			if (level.has_queued_path())
+				return;
+		}
+	}
+
+	// the whole of `str` as an unsigned number (std::stoull throws on failure, and ignores anything after the number)
+	bool parse_uint(std::string_view str, std::uint64_t& value)
+	{
+		auto const [end, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+		return (ec == std::errc() && end == str.data() + str.size());
+	}
+
+	double to_seconds(bump::duration_t d)
+	{
+		return std::chrono::duration<double>(d).count();
+	}
+
+	void report(rog::simulation& sim, bump::duration_t setup_time, bump::duration_t run_time)
+	{
+		auto const seconds = to_seconds(run_time);
+
+		std::cout << std::fixed << std::setprecision(1);
+		std::cout
+			<< "setup:         " << to_seconds(setup_time) * 1000.0 << " ms\n"
+			<< "run:           " << seconds * 1000.0 << " ms\n"
+			<< "cycles:        " << sim.cycle_count() << " (" << double(sim.cycle_count()) / seconds << " / s)\n"
+			<< "actor turns:   " << sim.actor_turn_count() << " (" << double(sim.actor_turn_count()) / seconds << " / s)\n"
+			<< "depth:         " << sim.depth() << "\n"
+			<< "stored levels: " << sim.dungeon().stored_memory() / 1024 << " KiB in memory\n"
+			<< "peak memory:   " << double(get_peak_memory_bytes()) / (1024.0 * 1024.0) << " MiB\n"
+			<< "checksum:      " << std::hex << sim.checksum() << std::dec << "\n";
+	}
+
+	// runs the simulation with the player wandering around, and saves the journal
+	int run(std::uint64_t cycles, std::uint64_t seed, std::int32_t depth, glm::ivec2 level_size)
+	{
+		std::clog << "rog_sim: " << cycles << " cycles, seed " << seed << ", depth " << depth << ", " << level_size.x << " x " << level_size.y << " levels" << std::endl;
+
+		auto const start = bump::clock_t::now();
+
+		auto sim = rog::simulation(seed, depth, level_size, DUNGEON_MEMORY_BUDGET, get_swap_dir());
+		auto rng = rog::random::rng_t(seed + 1);
+
+		auto const setup_time = bump::clock_t::now() - start;
+
+		auto depths = std::set<std::int32_t>{ depth };
+
+		for (auto i = std::uint64_t{ 0 }; i != cycles; ++i)
+		{
+			wander(sim, rng);
+
+			if (sim.cycle().m_level_changed)
+				depths.insert(sim.depth());
+		}
+
+		auto const run_time = bump::clock_t::now() - start - setup_time;
+
+		report(sim, setup_time, run_time);
+		std::cout << "depths:        " << depths.size() << " visited\n";
+
+		auto const journal_path = get_swap_dir() / "last_run.rogj";
+
+		if (!rog::save_journal(journal_path, sim.get_journal()))
+			return EXIT_FAILURE;
+
+		std::cout << "journal:       " << journal_path.string() << "\n";
+
+		return EXIT_SUCCESS;
+	}
+
+	// replays a journal (from the game, or from run()) as fast as possible, and checks that the session ended the same way
+	int replay(std::filesystem::path const& path, std::optional<std::uint64_t> to_cycle)
+	{
+		auto const journal = rog::load_journal(path);
+
+		if (!journal.has_value())
+			return EXIT_FAILURE;
+
+		auto const& j = journal.value();
+
+		std::clog << "rog_sim: replaying " << path.string() << " (" << j.m_entries.size() << " actions, " << j.m_cycle_count << " cycles)" << std::endl;
+
+		auto const start = bump::clock_t::now();
+
+		auto sim = rog::simulation(j.m_seed, j.m_depth, j.m_level_size, DUNGEON_MEMORY_BUDGET, get_swap_dir());
+
+		auto const setup_time = bump::clock_t::now() - start;
+
+		rog::replay_journal(sim, j, to_cycle.value_or(j.m_cycle_count));
+
+		auto const run_time = bump::clock_t::now() - start - setup_time;
+
+		report(sim, setup_time, run_time);
+
+		if (sim.cycle_count() != j.m_cycle_count)
+			return EXIT_SUCCESS; // (stopped early, so there's nothing to check)
+
+		auto const matches = (sim.checksum() == j.m_checksum);
+		std::cout << "replay:        " << (matches ? "matches the journal" : "DOES NOT MATCH the journal") << "\n";
+
+		return matches ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+} // unnamed
+
+int main(int argc, char** argv)
+{
+	auto const usage =
+		"usage: rog_sim [cycles] [seed] [depth] [level width] [level height]\n"
+		"       rog_sim replay <journal> [cycle]\n";
+
+	auto valid_args = true;
+
+	auto const arg = [&] (int i, std::uint64_t default_value, std::uint64_t max_value = std::numeric_limits<std::uint64_t>::max())
+	{
+		auto value = default_value;
+
+		if (i < argc && (!parse_uint(argv[i], value) || value > max_value))
+		{
+			std::cerr << "rog_sim: invalid argument: " << argv[i] << "\n";
+			valid_args = false;
+		}
+
+		return value;
+	};
+
+	auto result = EXIT_SUCCESS;
+
+	if (argc > 2 && argv[1] == std::string("replay"))
+	{
+		auto const to_cycle = (argc > 3) ? std::optional<std::uint64_t>(arg(3, 0)) : std::nullopt;
+
+		if (!valid_args)
+		{
+			std::cerr << usage;
+			return EXIT_FAILURE;
+		}
+
+		result = replay(argv[2], to_cycle);
+	}
+	else
+	{
+		auto const cycles = arg(1, 100'000);
+		auto const seed = arg(2, 0x5eed);
+		auto const int_max = std::uint64_t(std::numeric_limits<std::int32_t>::max());
+		auto const depth = std::int32_t(arg(3, 1, int_max));
+		auto const level_size = glm::ivec2(std::int32_t(arg(4, rog::level_gen::DEFAULT_LEVEL_SIZE.x, int_max)), std::int32_t(arg(5, rog::level_gen::DEFAULT_LEVEL_SIZE.y, int_max)));
+
+		if (valid_args && !rog::level_gen::is_valid_depth(depth))
+		{
+			std::cerr << "rog_sim: invalid depth: " << depth << "\n";
+			valid_args = false;
+		}
+
+		if (valid_args && !rog::level_gen::is_valid_level_size(level_size))
+		{
+			auto const min = rog::level_gen::MIN_LEVEL_SIZE;
+			auto const max = rog::level_gen::MAX_LEVEL_SIZE;
+			std::cerr << "rog_sim: invalid level size: " << level_size.x << " x " << level_size.y << " (must be from " << min.x << " x " << min.y << " to " << max.x << " x " << max.y << ")\n";
+			valid_args = false;
+		}
+
+		if (!valid_args)
+		{
+			std::cerr << usage;
+			return EXIT_FAILURE;
+		}
+
+		result = run(cycles, seed, depth, level_size);
+	}
+
+	std::clog << "done!" << std::endl;
+
+	return result;
+}
+
@@ -1,12 +1,11 @@
 #version 400
 
 in vec2 in_VertexPosition;
-in vec2 in_TilePosition;
-in float in_TileLayer;
-in vec3 in_TileFGColor;
-in vec3 in_TileBGColor;
+in uvec3 in_TileInstance; // (cell index | glyph << 24, fg RGBA8, bg RGBA8)
 
 uniform vec2 u_TileSize;
+uniform vec2 u_BufferOrigin;
+uniform ivec2 u_BufferSize;
 uniform mat4 u_MVP;
 
 out vec2 vert_UV;
@@ -16,10 +15,13 @@ out vec3 vert_TileBGColor;
 
 void main()
 {
+	int index = int(in_TileInstance.x & 0xFFFFFFu);
+	vec2 cell = vec2(index % u_BufferSize.x, (u_BufferSize.y - 1) - index / u_BufferSize.x);
+
 	vert_UV = in_VertexPosition;
-	vert_TileLayer = in_TileLayer;
-	vert_TileFGColor = in_TileFGColor;
-	vert_TileBGColor = in_TileBGColor;
-	vec2 pos = in_TilePosition + in_VertexPosition * u_TileSize;
+	vert_TileLayer = float(in_TileInstance.x >> 24u);
+	vert_TileFGColor = unpackUnorm4x8(in_TileInstance.y).rgb;
+	vert_TileBGColor = unpackUnorm4x8(in_TileInstance.z).rgb;
+	vec2 pos = u_BufferOrigin + (cell + in_VertexPosition) * u_TileSize;
 	gl_Position = u_MVP * vec4(pos.x, 0.0, -pos.y, 1.0);
 }
@@ -38,6 +38,9 @@ def get_c_files(dir):
 def get_test_files(dir):
 	return [os.path.relpath(f, dir) for f in glob.glob(os.path.join(dir, '**/*.test.cpp'), recursive = True)]
 
+def is_test_file(filename):
+	return filename.endswith('.test.cpp')
+
 def get_file_stem(filename):
 	return os.path.splitext(os.path.basename(filename))[0]
 
@@ -535,6 +538,8 @@ class PlatformMSVC:
 
 		rog = ProjectExe.from_name('rog', self, build_type)
 		rog.defines = bump.defines
+		rog_test_files = [f for f in rog.src_files if is_test_file(f)]
+		rog.src_files = [f for f in rog.src_files if not is_test_file(f)]
 		rog.inc_dirs = [
 			entt.code_dir,
 			json.code_dir,
@@ -603,6 +608,24 @@ class PlatformMSVC:
 		smirc.standard_libs = [ 'User32.lib', 'Shell32.lib', 'Ole32.lib', 'OpenGL32.lib', 'gdi32.lib', 'Winmm.lib', 'Advapi32.lib', 'Version.lib', 'Imm32.lib', 'Setupapi.lib', 'OleAut32.lib', 'Ws2_32.lib' ]
 		self.write_exe(n, build_type, smirc)
 
+		rog_bench = ProjectExe.from_name('rog_bench', self, build_type)
+		rog_bench.defines = bump.defines
+		# like the tests, the benchmarks build the rog sources (minus main) directly
+		rog_bench.src_files = rog_bench.src_files + [f for f in rog.src_files if get_file_stem(f) != 'main']
+		rog_bench.inc_dirs = rog.inc_dirs + [ rog.code_dir ]
+		rog_bench.libs = rog.libs
+		rog_bench.standard_libs = rog.standard_libs
+		self.write_exe(n, build_type, rog_bench)
+
+		rog_sim = ProjectExe.from_name('rog_sim', self, build_type)
+		rog_sim.defines = bump.defines
+		# the game without a window (see rog_simulation.hpp), so it builds the rog sources like the benchmarks do
+		rog_sim.src_files = rog_sim.src_files + [f for f in rog.src_files if get_file_stem(f) != 'main']
+		rog_sim.inc_dirs = rog.inc_dirs + [ rog.code_dir ]
+		rog_sim.libs = rog.libs
+		rog_sim.standard_libs = rog.standard_libs
+		self.write_exe(n, build_type, rog_sim)
+
 		# include all the test files (.test.cpp extension) in a source file so the linker doesn't
 		# think they are unreferenced and remove them
 		test_files = get_test_files(bump.code_dir)
@@ -613,6 +636,8 @@ class PlatformMSVC:
 
 		test = ProjectExe.from_name('test', self, build_type)
 		test.defines = bump.defines
+		# rog isn't a library, so build its sources (minus main) and tests into the test executable directly
+		test.src_files = test.src_files + [f for f in rog.src_files if get_file_stem(f) != 'main'] + rog_test_files
 		test.inc_dirs = [
 			entt.code_dir,
 			json.code_dir,